@@ -6,21 +6,22 @@
 
 AssetController::AssetController()
 {
+    concurrentDefaultAction = true;
 
 }
 
-void AssetController::defaultAction()
+void AssetController::defaultAction(RequestContext *context)
 {
-    if (query->getQuery(0) == "") {
-        pageNotFound();
+    if (context->getQuery()->getQuery(0) == "") {
+        pageNotFound(context);
         return;
     }
 
     QString fileName = QDir::currentPath() + "/";
-    fileName += query->getAllQuery().join("/");
+    fileName += context->getQuery()->getAllQuery().join("/");
 
     QFile file(fileName);
-    loadFile(file);
+    loadFile(context, file);
 }
 
 void AssetController::stop()
@@ -28,11 +29,11 @@ void AssetController::stop()
 
 }
 
-void AssetController::pageNotFound()
+void AssetController::pageNotFound(RequestContext *context)
 {
-    *output << "HTTP/1.0 404 Not Found\r\n";
-    *output << "Content-Type: text/html; charset=\"utf-8\"\r\n\r\n";
-    *output << "<h1>Page Not Found</h1>";
-    *output << "<p>Oops, we are sorry but the page you are looking for was not found...</p>";
+    context->sendResponse("404 Not Found",
+                          "Content-Type: text/html; charset=\"utf-8\"\r\n",
+                          "<h1>Page Not Found</h1>"
+                          "<p>Oops, we are sorry but the page you are looking for was not found...</p>");
 }
 
@@ -10,11 +10,11 @@ class AssetController : public AbstractController
 
 public:
     AssetController();
-    void defaultAction();
+    void defaultAction(RequestContext *context);
     void stop();
 
 protected:
-    void pageNotFound();
+    void pageNotFound(RequestContext *context);
 };
 
 #endif // ASSETCONTROLLER_H
@@ -5,17 +5,17 @@
 
 AuthController::AuthController(QObject *parent) : AbstractController(parent)
 {
-    router.insert("user", "user");
-    router.insert("js_login", "jsonLogin");
-    router.insert("js_logout", "jsonLogout");
-    router.insert("js_change_password", "jsonChangePassword");
-    router.insert("js_user_info", "jsonUserInfo");
+    addRoute("user", &AuthController::user);
+    addRoute("js_login", &AuthController::jsonLogin);
+    addRoute("js_logout", &AuthController::jsonLogout);
+    addRoute("js_change_password", &AuthController::jsonChangePassword);
+    addRoute("js_user_info", &AuthController::jsonUserInfo);
 }
 
-void AuthController::defaultAction()
+void AuthController::defaultAction(RequestContext *context)
 {
-    if (query->getQuery(1) == "") {
-        loadHtmlView("views/auth/login.html");
+    if (context->getQuery()->getQuery(1) == "") {
+        loadHtmlView(context, "views/auth/login.html");
     }
 }
 
@@ -24,55 +24,55 @@ void AuthController::stop()
 
 }
 
-void AuthController::user()
+void AuthController::user(RequestContext *context)
 {
-    if (!Authentification::auth().isConnected(header, cookie)) {
-        redirect("/auth");
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        redirect(context, "/auth");
         return;
     }
 
     QHash<QString, QByteArray> view;
-    view["content"] = loadHtmlView("views/auth/user.body.html", NULL, false);
-    view["bottom"] = loadHtmlView("views/auth/user.js", NULL, false);
-    loadHtmlView("views/template.html", &view);
+    view["content"] = loadView("views/auth/user.body.html");
+    view["bottom"] = loadView("views/auth/user.js");
+    loadHtmlView(context, "views/template.html", &view);
 }
 
-void AuthController::jsonLogin()
+void AuthController::jsonLogin(RequestContext *context)
 {
     QJsonObject json;
-    QString username = query->getItem("username");
-    QString password = query->getItem("password");
+    QString username = context->getQuery()->getItem("username");
+    QString password = context->getQuery()->getItem("password");
     QString error;
 
-    if (Authentification::auth().connection(username, password, cookie, error)){
+    if (Authentification::auth().connection(username, password, context->getCookie(), error)){
         json.insert("success", true);
     } else {
         json.insert("success", false);
         json.insert("msg", error);
     }
 
-    loadJsonView(json);
+    loadJsonView(context, json);
 }
 
-void AuthController::jsonLogout()
+void AuthController::jsonLogout(RequestContext *context)
 {
-    Authentification::auth().disconnection(header, cookie);
+    Authentification::auth().disconnection(context->getHeader(), context->getCookie());
 
     QJsonObject json;
     json.insert("success", true);
-    loadJsonView(json);
+    loadJsonView(context, json);
 }
 
-void AuthController::jsonChangePassword()
+void AuthController::jsonChangePassword(RequestContext *context)
 {
     QJsonObject json;
-    QString oldPassword = query->getItem("old_password");
-    QString newPassword = query->getItem("new_password");
+    QString oldPassword = context->getQuery()->getItem("old_password");
+    QString newPassword = context->getQuery()->getItem("new_password");
     User *user;
     QString error = "";
 
     try {
-        user = &Authentification::auth().getConnectedUser(header, cookie);
+        user = &Authentification::auth().getConnectedUser(context->getHeader(), context->getCookie());
     } catch (QString const &e) {
         error = "You are not logged!";
     }
@@ -106,15 +106,15 @@ void AuthController::jsonChangePassword()
         json.insert("msg", error);
     }
 
-    loadJsonView(json);
+    loadJsonView(context, json);
 }
 
-void AuthController::jsonUserInfo()
+void AuthController::jsonUserInfo(RequestContext *context)
 {
     QJsonObject json;
 
     try {
-        User user = Authentification::auth().getConnectedUser(header, cookie);
+        User user = Authentification::auth().getConnectedUser(context->getHeader(), context->getCookie());
         json.insert("username", user.getUsername());
         json.insert("success", true);
     } catch (QString const &e) {
@@ -122,6 +122,6 @@ void AuthController::jsonUserInfo()
         json.insert("success", false);
     }
 
-    loadJsonView(json);
+    loadJsonView(context, json);
 }
 
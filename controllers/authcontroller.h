@@ -11,15 +11,15 @@ class AuthController : public AbstractController
 
 public:
     AuthController(QObject *parent = 0);
-    void defaultAction();
+    void defaultAction(RequestContext *context);
     void stop();
 
 public slots:
-    void user();
-    void jsonLogin();
-    void jsonLogout();
-    void jsonChangePassword();
-    void jsonUserInfo();
+    void user(RequestContext *context);
+    void jsonLogin(RequestContext *context);
+    void jsonLogout(RequestContext *context);
+    void jsonChangePassword(RequestContext *context);
+    void jsonUserInfo(RequestContext *context);
 
 };
 
@@ -14,13 +14,17 @@
 CameraController::CameraController(QObject *parent) : AbstractCrudController(parent)
 {
     name = "camera";
+    watchEvent(Camera::getEvent());
+    addToDashboard("cameras");
     Camera::update();
     
     this->networkManager = new QNetworkAccessManager(this);
     connect(networkManager, SIGNAL(finished(QNetworkReply *)), this, SLOT(networkReply(QNetworkReply*)));
     
-    router.insert("image", "image");
-    router.insert("show", "show");
+    // /camera/image/3; /camera/image/?id=3 is kept for the pages loaded before
+    addRoute("GET", "image/:id", &CameraController::image);
+    addRoute("GET", "image", &CameraController::image);
+    addRoute("show", &CameraController::show);
 
     QFile file(QDir::currentPath() + "/views/camera/no_video.jpg");
     file.open(QIODevice::ReadOnly);
@@ -42,17 +46,18 @@ CameraController::~CameraController()
 
 }
 
-void CameraController::image()
+void CameraController::image(RequestContext *context)
 {
-    int id = query->getItem("id").toInt();
+    QString parameter = context->getParameter("id");
+    int id = parameter.isEmpty() ? context->getQuery()->getItem("id").toInt() : parameter.toInt();
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
-        forbidden("You are not logged.");
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        forbidden(context, "You are not logged.");
         return;
     }
 
     if (!Camera::isIdValid(id)) {
-        forbidden("Camera Id invalid");
+        forbidden(context, "Camera Id invalid");
         return;
     }
 
@@ -66,32 +71,48 @@ void CameraController::image()
                 networkManager->get(QNetworkRequest(QUrl(s.url)));
 
                 if (s.date > QDateTime::currentDateTime().addSecs(-10)) {
-                    loadByteArray(s.image, "image/jpeg");
+                    loadByteArray(context, s.image, "image/jpeg");
                 } else {
-                    loadByteArray(imageNoVideo, "image/jpeg");
+                    // Answer with the screenshot requested above once it is received
+                    PendingImage pending;
+                    pending.id = id;
+                    pending.context = context;
+                    pendingImages.append(pending);
+                    context->setAsync();
+
+                    QTimer::singleShot(5000, this, [this, context]() {
+                        // Still pending: not answered, so not released either
+                        for (int i = 0; i < pendingImages.size(); i++) {
+                            if (pendingImages.at(i).context == context) {
+                                pendingImages.removeAt(i);
+                                answerImage(context, imageNoVideo);
+                                break;
+                            }
+                        }
+                    });
                 }
 
                 break;
             }
         }
     } else {
-        stream(camera);
+        stream(context, camera);
     }
 }
 
-void CameraController::show()
+void CameraController::show(RequestContext *context)
 {
-    if (!Authentification::auth().isConnected(header, cookie)) {
-        redirect("/auth");
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        redirect(context, "/auth");
         return;
     }
 
     QHash<QString, QByteArray> view;
     view["bottom"] = loadScript("views/camera/show.js");
-    loadHtmlView("views/camera/show.body.html", &view);
+    loadHtmlView(context, "views/camera/show.body.html", &view);
 }
 
-void CameraController::stream(Camera *camera)
+void CameraController::stream(RequestContext *context, Camera *camera)
 {
     QDir directory(camera->getUrl());
     QFileInfoList images = directory.entryInfoList(QStringList() << "*.jpg"
@@ -102,21 +123,24 @@ void CameraController::stream(Camera *camera)
     if (images.size() > 0) {
         if (images.first().lastModified().addSecs(10) > QDateTime::currentDateTime()) {
             QFile file(images.first().filePath());
-            loadFile(file);
+            loadFile(context, file);
             return;
         }
     }
 
-    loadByteArray(imageNoVideo, "image/jpeg");
+    loadByteArray(context, imageNoVideo, "image/jpeg");
 }
 
 void CameraController::networkReply(QNetworkReply *reply)
 {
-    if (reply->error() == QNetworkReply::NoError) {
-        for (int i=0; i<screenList.size(); i++) {
-            if (reply->url().url().contains(screenList.at(i).url)) {
+    for (int i=0; i<screenList.size(); i++) {
+        if (reply->url().url().contains(screenList.at(i).url)) {
+            if (reply->error() == QNetworkReply::NoError) {
                 screenList[i].image = reply->readAll();
                 screenList[i].date = QDateTime::currentDateTime();
+                answerPendingImages(screenList.at(i).id, screenList.at(i).image);
+            } else {
+                answerPendingImages(screenList.at(i).id, imageNoVideo);
             }
         }
     }
@@ -124,6 +148,27 @@ void CameraController::networkReply(QNetworkReply *reply)
     reply->deleteLater();
 }
 
+void CameraController::answerPendingImages(int id, const QByteArray &image)
+{
+    QMutableListIterator<PendingImage> i(pendingImages);
+    while (i.hasNext()) {
+        PendingImage &pending = i.next();
+
+        if (pending.id == id) {
+            answerImage(pending.context, image);
+            i.remove();
+        }
+    }
+}
+
+void CameraController::answerImage(RequestContext *context, const QByteArray &image)
+{
+    // Answered in the thread of the context, the one which deletes it once the response is written
+    QMetaObject::invokeMethod(context, [this, context, image]() {
+        loadByteArray(context, image, "image/jpeg");
+    }, Qt::QueuedConnection);
+}
+
 QJsonArray CameraController::getList()
 {
     QJsonArray result;
@@ -136,10 +181,10 @@ QJsonArray CameraController::getList()
     return result;
 }
 
-QJsonObject CameraController::updateElement(bool createNewObject)
+QJsonObject CameraController::updateElement(RequestContext *context, bool createNewObject)
 {
     Q_UNUSED(createNewObject);
-    int id = query->getItem("id").toInt();
+    int id = context->getQuery()->getItem("id").toInt();
     Camera *camera;
 
     if (Camera::isIdValid(id)) {
@@ -148,10 +193,10 @@ QJsonObject CameraController::updateElement(bool createNewObject)
         camera = new Camera(id);
     }
 
-    camera->setName(query->getItem("name"));
-    camera->setUrl(query->getItem("url"));
-    camera->setOrder(query->getItem("order").toInt());
-    camera->setVisibility(query->getItem("visibility"));
+    camera->setName(context->getQuery()->getItem("name"));
+    camera->setUrl(context->getQuery()->getItem("url"));
+    camera->setOrder(context->getQuery()->getItem("order").toInt());
+    camera->setVisibility(context->getQuery()->getItem("visibility"));
     camera->flush();
 
     return camera->toJson();
@@ -21,12 +21,18 @@ public:
       QByteArray image;
     };
 
+    // A pending context is only released by its worker once it is answered
+    struct PendingImage {
+      int id;
+      RequestContext *context;
+    };
+
     CameraController(QObject *parent = 0);
     ~CameraController();
 
 public slots:
-    void image();
-    void show();
+    void image(RequestContext *context);
+    void show(RequestContext *context);
     void networkReply(QNetworkReply*);
 
 signals:
@@ -34,13 +40,16 @@ signals:
 
 protected:
     QJsonArray getList();
-    QJsonObject updateElement(bool createNewObject);
+    QJsonObject updateElement(RequestContext *context, bool createNewObject);
     bool deleteElement(QString id);
-    void stream(Camera *camera);
+    void stream(RequestContext *context, Camera *camera);
+    void answerPendingImages(int id, const QByteArray &image);
+    void answerImage(RequestContext *context, const QByteArray &image);
 
     QNetworkAccessManager *networkManager;
     QByteArray imageNoVideo;
     QList<Screenshoot> screenList;
+    QList<PendingImage> pendingImages;
 };
 
 
@@ -1,15 +1,24 @@
 #include "defaultcontroller.h"
+#include "core/database.h"
+#include "core/migration.h"
+#include "core/tools.h"
+#include "core/writebehind.h"
 #include "libraries/authentification.h"
+#include "libraries/dashboard.h"
 #include "libraries/device.h"
+#include "libraries/eventstream.h"
 #include "libraries/messagelogger.h"
 #include "libraries/settings.h"
+#include "libraries/timeseriesstore.h"
 #include "models/sensor.h"
+#include "models/setting.h"
 #include "models/switch.h"
 
 #include <QCoreApplication>
 #include <QDir>
 #include <QHostAddress>
 #include <QJsonArray>
+#include <QSet>
 #include <QTime>
 #include <QTimer>
 
@@ -29,43 +38,76 @@ DefaultController::DefaultController(MySensors *mySensors,
             SLOT(newMessageFromMessageLogger(QString, QString)),
             Qt::QueuedConnection);
 
-    router.insert("stop", "stopApplication");
-    router.insert("logs", "logs");
-    router.insert("logs.js", "jsonLogs");
-    router.insert("clear_logs.js", "jsonClearLogs");
-    router.insert("system.js", "jsonSystem");
-    router.insert("alarm.js", "jsonAlarm");
-    router.insert("sms.js", "jsonSms");
-    router.insert("mysensors.js", "jsonMySensors");
-    router.insert(".well-known", "wellKnown"); // used for Let’s Encrypt
+    addRoute("stop", &DefaultController::stopApplication);
+    addRoute("logs", &DefaultController::logs);
+    addRoute("logs.js", &DefaultController::jsonLogs, true);
+    addRoute("clear_logs.js", &DefaultController::jsonClearLogs);
+    addRoute("system.js", &DefaultController::jsonSystem);
+    addRoute("dashboard.js", &DefaultController::jsonDashboard);
+    addRoute("metrics.js", &DefaultController::jsonMetrics);
+    addRoute("events", &DefaultController::events, true);
+    addRoute("alarm.js", &DefaultController::jsonAlarm);
+    addRoute("sms.js", &DefaultController::jsonSms);
+    addRoute("mysensors.js", &DefaultController::jsonMySensors);
+    addRoute(".well-known", &DefaultController::wellKnown); // used for Let’s Encrypt
+
+    Dashboard::dashboard().addSection("system", []() {
+        return QTime::currentTime().toString("HH:mm").toLatin1() + "."
+               + QByteArray::number(Device::Instance()->isConnected()) + "."
+               + QByteArray::number(Setting::getEvent()->getVersion());
+    }, [this]() {
+        return QJsonValue(getSystem());
+    });
+    Dashboard::dashboard().addSection("warnings", []() {
+        return QByteArray::number(MessageLogger::logger().getAlertVersion());
+    }, []() {
+        QJsonArray messages;
+        foreach (const MessageLogger::Log &log, MessageLogger::logger().getMessages()) {
+            if (log.type == "warning" || log.type == "critical") {
+                messages.push_back(logToJson(log));
+            }
+        }
+        return QJsonValue(messages);
+    });
 }
 
-void DefaultController::defaultAction()
+QJsonObject DefaultController::logToJson(const MessageLogger::Log &log)
 {
-    if (!Authentification::auth().isConnected(header, cookie))
+    QJsonObject object;
+    object.insert("id", log.id);
+    object.insert("date", log.date.toString("dd/MM/yyyy hh:mm:ss zzz"));
+    object.insert("message", log.message);
+    object.insert("type", log.type);
+
+    return object;
+}
+
+void DefaultController::defaultAction(RequestContext *context)
+{
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()))
     {
-        redirect("/auth");
+        redirect(context, "/auth");
         return;
     }
 
     QHash<QString, QByteArray> view;
-    view["head"] = loadHtmlView("views/default/default.head.html", NULL, false);
-    view["content"] = loadHtmlView("views/default/default.body.html", NULL, false);
-    view["bottom"] = loadHtmlView("views/default/default.footer.html", NULL, false) +
+    view["head"] = loadView("views/default/default.head.html");
+    view["content"] = loadView("views/default/default.body.html");
+    view["bottom"] = loadView("views/default/default.footer.html") +
                      loadScript("views/default/default.js");
-    loadHtmlView("views/template.html", &view);
+    loadHtmlView(context, "views/template.html", &view);
 }
 
 void DefaultController::stop()
 {
 }
 
-void DefaultController::stopApplication()
+void DefaultController::stopApplication(RequestContext *context)
 {
     QJsonObject result;
 
-    if (Authentification::auth().isConnected(header, cookie) ||
-        socket->peerAddress().toString().contains("127.0.0.1"))
+    if (Authentification::auth().isConnected(context->getHeader(), context->getCookie()) ||
+        context->getPeerAddress().toString().contains("127.0.0.1"))
     {
         QTimer::singleShot(100, QCoreApplication::instance(), SLOT(quit()));
         result.insert("success", true);
@@ -76,47 +118,47 @@ void DefaultController::stopApplication()
         result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void DefaultController::logs()
+void DefaultController::logs(RequestContext *context)
 {
-    if (!Authentification::auth().isConnected(header, cookie))
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()))
     {
-        redirect("/auth");
+        redirect(context, "/auth");
         return;
     }
 
     QHash<QString, QByteArray> view;
-    view["content"] = loadHtmlView("views/default/logs.body.html", NULL, false);
-    view["bottom"] = loadHtmlView("views/default/logs.footer.html", NULL, false) +
+    view["content"] = loadView("views/default/logs.body.html");
+    view["bottom"] = loadView("views/default/logs.footer.html") +
                      loadScript("views/default/logs.js");
-    loadHtmlView("views/template.html", &view);
+    loadHtmlView(context, "views/template.html", &view);
 }
 
-void DefaultController::jsonLogs()
+void DefaultController::jsonLogs(RequestContext *context)
 {
     QJsonObject result;
     bool ok = false;
 
-    QDate day = QDate::fromString(query->getItem("day"), "yyyy-MM-dd");
-    QString request = query->getItem("type");
-    int startId = query->getItem("startid").toInt(&ok, 10);
+    QDate day = QDate::fromString(context->getQuery()->getItem("day"), "yyyy-MM-dd");
+    QString request = context->getQuery()->getItem("type");
+    int startId = context->getQuery()->getItem("startid").toInt(&ok, 10);
 
     if (!ok)
     {
         startId = 0;
     }
 
-    if (!Authentification::auth().isConnected(header, cookie))
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()))
     {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
 
-    QList<MessageLogger::Log> &logs = MessageLogger::logger().getMessages();
+    QList<MessageLogger::Log> logs = MessageLogger::logger().getMessages();
     QJsonArray jsonArray;
 
     foreach (const MessageLogger::Log &log, logs)
@@ -141,101 +183,184 @@ void DefaultController::jsonLogs()
             continue;
         }
 
-        QJsonObject object;
-        object.insert("id", log.id);
-        object.insert("date", log.date.toString("dd/MM/yyyy hh:mm:ss zzz"));
-        object.insert("message", log.message);
-        object.insert("type", log.type);
-        jsonArray.push_back(object);
+        jsonArray.push_back(logToJson(log));
     }
 
     result.insert("messages", jsonArray);
     result.insert("success", true);
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void DefaultController::jsonClearLogs()
+void DefaultController::jsonClearLogs(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie))
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()))
     {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
 
     bool ok = false;
-    int id = query->getItem("id").toInt(&ok, 10);
+    int id = context->getQuery()->getItem("id").toInt(&ok, 10);
 
     if (!ok || id < 0)
     {
         result.insert("success", false);
         result.insert("msg", "ID param is not a number!");
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
 
-    if (query->getItem("type") == "")
+    if (context->getQuery()->getItem("type") == "")
     {
         result.insert("success", false);
         result.insert("msg", "TYPE param is missing!");
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
 
-    if (query->getItem("type") == "warningandcritical")
+    if (context->getQuery()->getItem("type") == "warningandcritical")
     {
         MessageLogger::logger().removeBeforeId(id, "warning");
         MessageLogger::logger().removeBeforeId(id, "critical");
     }
     else
     {
-        MessageLogger::logger().removeBeforeId(id, query->getItem("type"));
+        MessageLogger::logger().removeBeforeId(id, context->getQuery()->getItem("type"));
     }
     result.insert("success", true);
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void DefaultController::jsonSystem()
+void DefaultController::jsonSystem(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("Result", "ERROR");
         result.insert("Message", "You are not logged.");
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
 
+    result = getSystem();
     result.insert("success", true);
+
+    loadJsonView(context, result);
+}
+
+void DefaultController::jsonDashboard(RequestContext *context)
+{
+    QJsonObject result;
+
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        result.insert("Result", "ERROR");
+        result.insert("Message", "You are not logged.");
+        loadJsonView(context, result);
+        return;
+    }
+
+    // ?since=<version> only returns the sections changed after that version
+    bool ok = false;
+    qint64 since = context->getQuery()->getItem("since").toLongLong(&ok);
+
+    if (ok && since > 0) {
+        loadJsonView(context, Dashboard::dashboard().getSnapshot(since));
+        return;
+    }
+
+    qint64 version = Dashboard::dashboard().refresh();
+    loadVersionedJson(context, "dashboard", QByteArray::number(version), []() {
+        return Dashboard::dashboard().getSnapshot();
+    });
+}
+
+QJsonObject DefaultController::getSystem()
+{
+    QJsonObject result;
+
     result.insert("time", QTime::currentTime().toString("HH:mm"));
     result.insert("device_connected", Device::Instance()->isConnected());
 
-    Settings *alarm = new Settings("alarm", this);
-    result.insert("alarm", alarm->value("status", "UNKNOWN"));
+    Settings alarm("alarm");
+    result.insert("alarm", alarm.value("status", "UNKNOWN"));
+
+    return result;
+}
+
+void DefaultController::events(RequestContext *context)
+{
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        forbidden(context, "You are not logged.");
+        return;
+    }
+
+    // ?topics=sensor.*,switch.status ; all topics by default
+    QSet<QString> topics;
+    foreach (const QString &topic, context->getQuery()->getItem("topics").split(',', SKIP_EMPTY_PARTS)) {
+        topics.insert(topic.trimmed());
+    }
+
+    // EventSource resends the last id it saw; the query is for clients that cannot set headers
+    QByteArray lastEventId = context->getHeader()->getHeader("Last-Event-ID");
+    if (lastEventId.isEmpty()) {
+        lastEventId = context->getQuery()->getItem("lastEventId").toLatin1();
+    }
+
+    if (!EventStream::stream().subscribe(context, topics, lastEventId.toLongLong())) {
+        notFound(context, "Event stream not available.");
+    }
+}
+
+void DefaultController::jsonMetrics(RequestContext *context)
+{
+    QJsonObject result;
+
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        result.insert("Result", "ERROR");
+        result.insert("Message", "You are not logged.");
+        loadJsonView(context, result);
+        return;
+    }
+
+    result.insert("success", true);
+
+    if (webSocketEvent != nullptr) {
+        result.insert("websocket", webSocketEvent->getMetrics());
+    }
+
+    QJsonObject database = Database::getStatistics();
+    database.insert("schema_version", Migration::getVersion());
+    result.insert("database", database);
+    result.insert("write_behind", WriteBehind::getStatistics());
+
+    if (TimeSeriesStore::store().isOpen()) {
+        result.insert("timeseries", TimeSeriesStore::store().getStatistics());
+    }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void DefaultController::jsonAlarm()
+void DefaultController::jsonAlarm(RequestContext *context)
 {
     QJsonObject result;
 
     Settings *alarm = new Settings("alarm", this);
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
-    } else if (query->getItem("status") == "DISARMED") {
+    } else if (context->getQuery()->getItem("status") == "DISARMED") {
         alarm->setValue("status", "DISARMED");
         result.insert("success", true);
-    } else if (query->getItem("status") == "ARM_STAY") {
+    } else if (context->getQuery()->getItem("status") == "ARM_STAY") {
         alarm->setValue("status", "ARM_STAY");
         result.insert("success", true);
-    } else if (query->getItem("status") == "ARM_AWAY") {
+    } else if (context->getQuery()->getItem("status") == "ARM_AWAY") {
         alarm->setValue("status", "ARM_AWAY");
         result.insert("success", true);
     } else {
@@ -243,17 +368,17 @@ void DefaultController::jsonAlarm()
         result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void DefaultController::jsonSms()
+void DefaultController::jsonSms(RequestContext *context)
 {
     QJsonObject result;
 
-    if (Authentification::auth().isConnected(header, cookie) ||
-        socket->peerAddress().toString().contains("127.0.0.1"))
+    if (Authentification::auth().isConnected(context->getHeader(), context->getCookie()) ||
+        context->getPeerAddress().toString().contains("127.0.0.1"))
     {
-        gsm->sendSMS(query->getItem("number"), query->getItem("message"));
+        gsm->sendSMS(context->getQuery()->getItem("number"), context->getQuery()->getItem("message"));
         result.insert("success", true);
     }
     else
@@ -262,17 +387,17 @@ void DefaultController::jsonSms()
         result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void DefaultController::jsonMySensors()
+void DefaultController::jsonMySensors(RequestContext *context)
 {
     QJsonObject result;
 
-    if (Authentification::auth().isConnected(header, cookie) ||
-        socket->peerAddress().toString().contains("127.0.0.1"))
+    if (Authentification::auth().isConnected(context->getHeader(), context->getCookie()) ||
+        context->getPeerAddress().toString().contains("127.0.0.1"))
     {
-        QString msg = query->getItem("msg").trimmed();
+        QString msg = context->getQuery()->getItem("msg").trimmed();
 
         if (!msg.isEmpty())
         {
@@ -291,21 +416,21 @@ void DefaultController::jsonMySensors()
         result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void DefaultController::wellKnown()
+void DefaultController::wellKnown(RequestContext *context)
 {
-    if (query->getQuery(0) == "") {
-        notFound("Oops, we are sorry but the page you are looking for was not found...");
+    if (context->getQuery()->getQuery(0) == "") {
+        notFound(context, "Oops, we are sorry but the page you are looking for was not found...");
         return;
     }
 
     QString fileName = QDir::currentPath() + "/";
-    fileName += query->getAllQuery().join("/");
+    fileName += context->getQuery()->getAllQuery().join("/");
 
     QFile file(fileName);
-    loadFile(file);
+    loadFile(context, file);
 }
 
 void DefaultController::newMessageFromMessageLogger(QString type, QString message)
@@ -3,6 +3,7 @@
 
 #include "core/abstractcontroller.h"
 #include "libraries/gsm.h"
+#include "libraries/messagelogger.h"
 #include "libraries/mysensors.h"
 #include "libraries/websocketevent.h"
 
@@ -16,24 +17,30 @@ public:
                       WebSocketEvent *webSocketEvent,
                       QObject *parent = 0);
 
-    void defaultAction();
+    void defaultAction(RequestContext *context);
     void stop();
 
 public slots:
-    void stopApplication();
-    void logs();
-    void jsonLogs();
-    void jsonClearLogs();
-    void jsonSystem();
-    void jsonAlarm();
-    void jsonSms();
-    void jsonMySensors();
-    void wellKnown();
+    void stopApplication(RequestContext *context);
+    void logs(RequestContext *context);
+    void jsonLogs(RequestContext *context);
+    void jsonClearLogs(RequestContext *context);
+    void jsonSystem(RequestContext *context);
+    void jsonDashboard(RequestContext *context);
+    void jsonMetrics(RequestContext *context);
+    void events(RequestContext *context);
+    void jsonAlarm(RequestContext *context);
+    void jsonSms(RequestContext *context);
+    void jsonMySensors(RequestContext *context);
+    void wellKnown(RequestContext *context);
 
 protected slots:
     void newMessageFromMessageLogger(QString type, QString message);
     
 protected:
+    QJsonObject getSystem();
+    static QJsonObject logToJson(const MessageLogger::Log &log);
+
     Gsm *gsm = nullptr;
     MySensors *mySensors = nullptr;
     WebSocketEvent *webSocketEvent = nullptr;
@@ -1,9 +1,12 @@
 #include "heatercontroller.h"
 #include "models/heater.h"
+#include "models/sensor.h"
 
 HeaterController::HeaterController(QObject *parent) : AbstractCrudController(parent)
 {
     name = "heater";
+    watchEvent(Heater::getEvent());
+    watchEvent(Sensor::getEvent());
 }
 
 QJsonArray HeaterController::getList()
@@ -17,10 +20,10 @@ QJsonArray HeaterController::getList()
     return result;
 }
 
-QJsonObject HeaterController::updateElement(bool createNewObject)
+QJsonObject HeaterController::updateElement(RequestContext *context, bool createNewObject)
 {
     Q_UNUSED(createNewObject);
-    int id = query->getItem("id").toInt();
+    int id = context->getQuery()->getItem("id").toInt();
     Heater *heater;
 
     if (Heater::get(id) != NULL) {
@@ -29,13 +32,13 @@ QJsonObject HeaterController::updateElement(bool createNewObject)
         heater = new Heater();
     }
 
-    heater->setName(query->getItem("name"));
-    heater->setPowerOnCmd(query->getItem("power_on_cmd"));
-    heater->setPowerOffCmd(query->getItem("power_off_cmd"));
-    heater->setMode(query->getItem("mode"));
-    heater->setCoolSetpoint(query->getItem("cool_setpoint").toFloat());
-    heater->setHeatSetpoint(query->getItem("heat_setpoint").toFloat());
-    heater->setSensor(query->getItem("sensor"));
+    heater->setName(context->getQuery()->getItem("name"));
+    heater->setPowerOnCmd(context->getQuery()->getItem("power_on_cmd"));
+    heater->setPowerOffCmd(context->getQuery()->getItem("power_off_cmd"));
+    heater->setMode(context->getQuery()->getItem("mode"));
+    heater->setCoolSetpoint(context->getQuery()->getItem("cool_setpoint").toFloat());
+    heater->setHeatSetpoint(context->getQuery()->getItem("heat_setpoint").toFloat());
+    heater->setSensor(context->getQuery()->getItem("sensor"));
     heater->flush();
     
     return heater->toJson();
@@ -14,7 +14,7 @@ public:
 
 protected:
     QJsonArray getList();
-    QJsonObject updateElement(bool createNewObject);
+    QJsonObject updateElement(RequestContext *context, bool createNewObject);
     bool deleteElement(QString id);
 };
 
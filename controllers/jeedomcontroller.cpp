@@ -21,18 +21,18 @@ JeedomController::JeedomController(Jeedom *jeedom, MySensors *mySensors, QObject
             SLOT(heaterValueUpdated(QString,QString, QString)), Qt::QueuedConnection);
 }
 
-void JeedomController::defaultAction()
+void JeedomController::defaultAction(RequestContext *context)
 {
-    if (!Authentification::auth().isConnected(header, cookie)) {
-        redirect("/auth");
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        redirect(context, "/auth");
         return;
     }
 
     //QHash<QString, QByteArray> view;
-    //view["head"] = loadHtmlView("views/default/default.head.html", NULL, false);
-    //view["content"] = loadHtmlView("views/default/default.body.html", NULL, false);
-    //view["bottom"] = loadHtmlView("views/default/default.js", NULL, false);
-    //loadHtmlView("views/template.html", &view);
+    //view["head"] = loadView("views/default/default.head.html");
+    //view["content"] = loadView("views/default/default.body.html");
+    //view["bottom"] = loadView("views/default/default.js");
+    //loadHtmlView(context, "views/template.html", &view);
 }
 
 void JeedomController::stop()
@@ -11,7 +11,7 @@ class JeedomController : public AbstractController
 
 public:
     JeedomController(Jeedom *jeedom, MySensors *mySensors, QObject *parent = 0);
-    void defaultAction();
+    void defaultAction(RequestContext *context);
     void stop();
 
 protected slots:
@@ -19,50 +19,53 @@ MySensorsController::MySensorsController(MySensors *mySensors, QObject *parent)
             SLOT(mySensorsDataReceived(QString, int, int, int, QString)),
             Qt::QueuedConnection);
 
-    router.insert("msg_activities.js", "jsonMsgActivities");
-    router.insert("routing.js", "jsonRouting");
-    router.insert("activities", "activities");
-    router.insert("routing", "routing");
+    addRoute("msg_activities.js", &MySensorsController::jsonMsgActivities);
+    addRoute("routing.js", &MySensorsController::jsonRouting);
+    addRoute("activities", &MySensorsController::activities);
+    addRoute("routing", &MySensorsController::routing);
 }
 
-void MySensorsController::defaultAction() {}
+void MySensorsController::defaultAction(RequestContext *context)
+{
+    notFound(context, "Oops, we are sorry but the page you are looking for was not found...");
+}
 
 void MySensorsController::stop() {}
 
-void MySensorsController::activities()
+void MySensorsController::activities(RequestContext *context)
 {
-    if (!Authentification::auth().isConnected(header, cookie)) {
-        redirect("/auth");
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        redirect(context, "/auth");
         return;
     }
 
     QHash<QString, QByteArray> view;
-    view["content"] = loadHtmlView("views/mysensors/activities.body.html", NULL, false);
-    view["bottom"] = loadHtmlView("views/mysensors/activities.footer.html", NULL, false)
+    view["content"] = loadView("views/mysensors/activities.body.html");
+    view["bottom"] = loadView("views/mysensors/activities.footer.html")
                      + loadScript("views/mysensors/activities.js");
-    loadHtmlView("views/template.html", &view);
+    loadHtmlView(context, "views/template.html", &view);
 }
 
-void MySensorsController::routing()
+void MySensorsController::routing(RequestContext *context)
 {
-    if (!Authentification::auth().isConnected(header, cookie)) {
-        redirect("/auth");
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        redirect(context, "/auth");
         return;
     }
 
     QHash<QString, QByteArray> view;
-    view["content"] = loadHtmlView("views/mysensors/routing.body.html", NULL, false);
-    view["bottom"] = loadHtmlView("views/mysensors/routing.footer.html", NULL, false)
+    view["content"] = loadView("views/mysensors/routing.body.html");
+    view["bottom"] = loadView("views/mysensors/routing.footer.html")
                      + loadScript("views/mysensors/routing.js");
-    loadHtmlView("views/template.html", &view);
+    loadHtmlView(context, "views/template.html", &view);
 }
 
-void MySensorsController::jsonMsgActivities()
+void MySensorsController::jsonMsgActivities(RequestContext *context)
 {
     QJsonObject result;
     QJsonArray array;
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
     } else {
@@ -77,17 +80,17 @@ void MySensorsController::jsonMsgActivities()
         result.insert("success", true);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void MySensorsController::jsonRouting()
+void MySensorsController::jsonRouting(RequestContext *context)
 {
     QJsonObject result;
     QJsonArray array;
     QMapIterator<int, int> i(mySensors->getRouting());
     QMap<QString, QString> map = mySensors->getSensorIdMap();
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
     } else {
@@ -108,7 +111,7 @@ void MySensorsController::jsonRouting()
         result.insert("success", true);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
 void MySensorsController::mySensorsDataReceived(
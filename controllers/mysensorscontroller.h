@@ -11,14 +11,14 @@ class MySensorsController : public AbstractController
 
 public:
     MySensorsController(MySensors *mySensors, QObject *parent);
-    void defaultAction();
+    void defaultAction(RequestContext *context);
     void stop();
 
 public slots:
-    void activities();
-    void routing();
-    void jsonMsgActivities();
-    void jsonRouting();
+    void activities(RequestContext *context);
+    void routing(RequestContext *context);
+    void jsonMsgActivities(RequestContext *context);
+    void jsonRouting(RequestContext *context);
 
 protected slots:
     void mySensorsDataReceived(QString messagetype, int sender, int sensor, int type, QString payload);
@@ -9,10 +9,11 @@
 ScenarioController::ScenarioController(ScriptEngine *scriptEngine, QObject *parent) : AbstractCrudController(parent)
 {
     name = "scenario";
+    watchEvent(Scenario::getEvent());
+    addToDashboard("scenarios");
     
-    router.insert("editor", "editor");
-    router.insert("get_scenario.js", "jsonGetScenario");
-    router.insert("change_scenario_status.js", "jsonChangeStatus");
+    addRoute("get_scenario.js", &ScenarioController::jsonGetScenario);
+    addRoute("change_scenario_status.js", &ScenarioController::jsonChangeStatus);
 
     this->scriptEngine = scriptEngine;
     Scenario::update();
@@ -30,10 +31,10 @@ QJsonArray ScenarioController::getList()
     return result;
 }
 
-QJsonObject ScenarioController::updateElement(bool createNewObject)
+QJsonObject ScenarioController::updateElement(RequestContext *context, bool createNewObject)
 {
     Q_UNUSED(createNewObject);
-    QString id = query->getItem("id");
+    QString id = context->getQuery()->getItem("id");
     Scenario *s;
 
     if (Scenario::isIdValid(id)) {
@@ -42,12 +43,12 @@ QJsonObject ScenarioController::updateElement(bool createNewObject)
         s = new Scenario(id);
     }
 
-    s->setName(query->getItem("name"));
-    s->setDescription(query->getItem("description"));
-    s->setContent(query->getItem("content"));
-    s->setStatus(query->getItem("status"));
-    s->setOrder(query->getItem("order").toInt());
-    s->setHide(query->getItem("hide") == "true" ? true : false);
+    s->setName(context->getQuery()->getItem("name"));
+    s->setDescription(context->getQuery()->getItem("description"));
+    s->setContent(context->getQuery()->getItem("content"));
+    s->setStatus(context->getQuery()->getItem("status"));
+    s->setOrder(context->getQuery()->getItem("order").toInt());
+    s->setHide(context->getQuery()->getItem("hide") == "true" ? true : false);
     s->flush();
     
     return s->toJson();
@@ -64,16 +65,16 @@ bool ScenarioController::deleteElement(QString id)
     }
 }
 
-void ScenarioController::jsonGetScenario()
+void ScenarioController::jsonGetScenario(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
     }
-    else if (Scenario::isIdValid(query->getItem("id"))) {
-        Scenario *s = Scenario::get(query->getItem("id"));
+    else if (Scenario::isIdValid(context->getQuery()->getItem("id"))) {
+        Scenario *s = Scenario::get(context->getQuery()->getItem("id"));
         result.insert("scenario", s->toJson());
         result.insert("success", true);
     } else {
@@ -81,42 +82,42 @@ void ScenarioController::jsonGetScenario()
        result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void ScenarioController::jsonChangeStatus()
+void ScenarioController::jsonChangeStatus(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("Result", "ERROR");
         result.insert("Message", "You are not logged.");
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
 
-    if (!Scenario::isIdValid(query->getItem("id"))) {
+    if (!Scenario::isIdValid(context->getQuery()->getItem("id"))) {
         result.insert("Result", "ERROR");
         result.insert("Message", "Id not valid.");
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
 
-    if (query->getItem("status") == "start" || query->getItem("status") == "stop") {
+    if (context->getQuery()->getItem("status") == "start" || context->getQuery()->getItem("status") == "stop") {
         result.insert("Result", "ERROR");
         result.insert("Message", "Status not valid.");
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
 
-    Scenario scenario(query->getItem("id"));
+    Scenario scenario(context->getQuery()->getItem("id"));
 
-    if (query->getItem("status") == "start") {
+    if (context->getQuery()->getItem("status") == "start") {
         scriptEngine->run("scenario_" + scenario.getId() + "_start");
     } else {
         scriptEngine->run("scenario_" + scenario.getId() + "_stop");
     }
 
     result.insert("Result", "OK");
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
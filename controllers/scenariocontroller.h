@@ -17,12 +17,12 @@ public:
     ScenarioController(ScriptEngine *scriptEngine, QObject *parent = 0);
 
 public slots:
-    void jsonGetScenario();
-    void jsonChangeStatus();
+    void jsonGetScenario(RequestContext *context);
+    void jsonChangeStatus(RequestContext *context);
 
 protected:
     QJsonArray getList();
-    QJsonObject updateElement(bool createNewObject);
+    QJsonObject updateElement(RequestContext *context, bool createNewObject);
     bool deleteElement(QString id);
 
     ScriptEngine *scriptEngine;
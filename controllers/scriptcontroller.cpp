@@ -14,14 +14,16 @@ ScriptController::ScriptController(ScriptEngine *scriptEngine,
     : AbstractCrudController(parent)
 {
     name = "script";
+    watchEvent(Script::getEvent());
+    addToDashboard("scripts");
 
-    router.insert("editor", "editor");
-    router.insert("export", "exportScripts");
-    router.insert("set_status", "jsonChangeScriptStatus");
-    router.insert("set_body", "jsonSetScriptBody");
-    router.insert("get_script.js", "jsonGetScript");
-    router.insert("cmd_list.js", "jsonCmdList");
-    router.insert("delete_cmd.js", "jsonDeleteCmd");
+    addRoute("editor", &ScriptController::editor);
+    addRoute("export", &ScriptController::exportScripts);
+    addRoute("set_status", &ScriptController::jsonChangeScriptStatus);
+    addRoute("set_body", &ScriptController::jsonSetScriptBody);
+    addRoute("get_script.js", &ScriptController::jsonGetScript);
+    addRoute("cmd_list.js", &ScriptController::jsonCmdList);
+    addRoute("delete_cmd.js", &ScriptController::jsonDeleteCmd);
 
     this->scriptEngine = scriptEngine;
     this->webSocketEvent = webSocketEvent;
@@ -36,23 +38,23 @@ ScriptController::ScriptController(ScriptEngine *scriptEngine,
     Command::update();
 }
 
-void ScriptController::editor()
+void ScriptController::editor(RequestContext *context)
 {
-    if (!Authentification::auth().isConnected(header, cookie))
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()))
     {
-        redirect("/auth");
+        redirect(context, "/auth");
         return;
     }
 
     QHash<QString, QByteArray> data;
-    loadHtmlView("views/script/editor.html", &data);
+    loadHtmlView(context, "views/script/editor.html", &data);
 }
 
-void ScriptController::exportScripts()
+void ScriptController::exportScripts(RequestContext *context)
 {
-    if (!Authentification::auth().isConnected(header, cookie))
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()))
     {
-        redirect("/auth");
+        redirect(context, "/auth");
         return;
     }
 
@@ -71,14 +73,10 @@ void ScriptController::exportScripts()
 
     QString filename = "doxeo_scripts_" + QDate::currentDate().toString("yyMMdd") + ".js";
 
-    *output << "HTTP/1.0 200 Ok\r\n";
-    *output << "Content-Type: application/octet-stream\r\n";
-    *output << "Content-Disposition: attachment; filename=\"" + filename + "\"\r\n\r\n";
-    output->flush();
-
-    // Streaming the file
-    QByteArray block = result.toUtf8();
-    socket->write(block);
+    context->sendResponse("200 OK",
+                          "Content-Type: application/octet-stream\r\n"
+                          "Content-Disposition: attachment; filename=\"" + filename.toUtf8() + "\"\r\n",
+                          result.toUtf8());
 }
 
 QJsonArray ScriptController::getList()
@@ -94,10 +92,10 @@ QJsonArray ScriptController::getList()
     return result;
 }
 
-QJsonObject ScriptController::updateElement(bool createNewObject)
+QJsonObject ScriptController::updateElement(RequestContext *context, bool createNewObject)
 {
     Q_UNUSED(createNewObject);
-    int id = query->getItem("id").toInt();
+    int id = context->getQuery()->getItem("id").toInt();
     Script *script;
 
     if (Script::isIdValid(id))
@@ -109,11 +107,11 @@ QJsonObject ScriptController::updateElement(bool createNewObject)
         script = new Script(id);
     }
 
-    script->setName(query->getItem("name"));
-    script->setStatus(query->getItem("status"));
-    script->setDescription(query->getItem("description"));
-    script->setVisibility(query->getItem("visibility"));
-    script->setContent(query->getItem("content"));
+    script->setName(context->getQuery()->getItem("name"));
+    script->setStatus(context->getQuery()->getItem("status"));
+    script->setDescription(context->getQuery()->getItem("description"));
+    script->setVisibility(context->getQuery()->getItem("visibility"));
+    script->setContent(context->getQuery()->getItem("content"));
     script->flush();
 
     return script->toJson();
@@ -133,27 +131,27 @@ bool ScriptController::deleteElement(QString id)
     }
 }
 
-void ScriptController::jsonChangeScriptStatus()
+void ScriptController::jsonChangeScriptStatus(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie))
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()))
     {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
     }
-    else if (Script::isIdValid(query->getItem("id").toInt()))
+    else if (Script::isIdValid(context->getQuery()->getItem("id").toInt()))
     {
-        Script *s = Script::get(query->getItem("id").toInt());
+        Script *s = Script::get(context->getQuery()->getItem("id").toInt());
 
-        if (query->getItem("status").toLower() == "on")
+        if (context->getQuery()->getItem("status").toLower() == "on")
         {
             s->setStatus("on");
             s->flush();
             result.insert("status", "on");
             result.insert("success", true);
         }
-        else if (query->getItem("status").toLower() == "off")
+        else if (context->getQuery()->getItem("status").toLower() == "off")
         {
             s->setStatus("off");
             s->flush();
@@ -172,22 +170,22 @@ void ScriptController::jsonChangeScriptStatus()
         result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void ScriptController::jsonSetScriptBody()
+void ScriptController::jsonSetScriptBody(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie))
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()))
     {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
     }
-    else if (Script::isIdValid(query->getItem("id").toInt()))
+    else if (Script::isIdValid(context->getQuery()->getItem("id").toInt()))
     {
-        Script *s = Script::get(query->getItem("id").toInt());
-        s->setContent(query->getItem("content"));
+        Script *s = Script::get(context->getQuery()->getItem("id").toInt());
+        s->setContent(context->getQuery()->getItem("content"));
         s->flush();
         result.insert("success", true);
     }
@@ -197,21 +195,21 @@ void ScriptController::jsonSetScriptBody()
         result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void ScriptController::jsonGetScript()
+void ScriptController::jsonGetScript(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie))
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()))
     {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
     }
-    else if (Script::isIdValid(query->getItem("id").toInt()))
+    else if (Script::isIdValid(context->getQuery()->getItem("id").toInt()))
     {
-        Script *s = Script::get(query->getItem("id").toInt());
+        Script *s = Script::get(context->getQuery()->getItem("id").toInt());
         result.insert("script", s->toJson());
         result.insert("success", true);
     }
@@ -221,18 +219,18 @@ void ScriptController::jsonGetScript()
         result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void ScriptController::jsonCmdList()
+void ScriptController::jsonCmdList(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie))
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()))
     {
         result.insert("Result", "ERROR");
         result.insert("Message", "You are not logged.");
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
 
@@ -246,22 +244,22 @@ void ScriptController::jsonCmdList()
     result.insert("result", "OK");
     result.insert("records", array);
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void ScriptController::jsonDeleteCmd()
+void ScriptController::jsonDeleteCmd(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie))
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()))
     {
         result.insert("Result", "ERROR");
         result.insert("Message", "You are not logged.");
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
 
-    if (Command::removeCommand(query->getItem("cmd")))
+    if (Command::removeCommand(context->getQuery()->getItem("cmd")))
     {
         Command::update();
         result.insert("Result", "OK");
@@ -271,7 +269,7 @@ void ScriptController::jsonDeleteCmd()
         result.insert("Result", "ERROR");
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
 void ScriptController::newMessageFromWebSocket(QString sender, QString message)
@@ -19,20 +19,20 @@ public:
                      QObject *parent = 0);
 
 public slots:
-    void editor();
-    void exportScripts();
-    void jsonChangeScriptStatus();
-    void jsonSetScriptBody();
-    void jsonGetScript();
-    void jsonCmdList();
-    void jsonDeleteCmd();
+    void editor(RequestContext *context);
+    void exportScripts(RequestContext *context);
+    void jsonChangeScriptStatus(RequestContext *context);
+    void jsonSetScriptBody(RequestContext *context);
+    void jsonGetScript(RequestContext *context);
+    void jsonCmdList(RequestContext *context);
+    void jsonDeleteCmd(RequestContext *context);
 
 protected slots:
     void newMessageFromWebSocket(QString sender, QString message);
 
 protected:
     QJsonArray getList();
-    QJsonObject updateElement(bool createNewObject);
+    QJsonObject updateElement(RequestContext *context, bool createNewObject);
     bool deleteElement(QString id);
 
     ScriptEngine *scriptEngine = nullptr;
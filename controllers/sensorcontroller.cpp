@@ -9,6 +9,8 @@
 SensorController::SensorController(MySensors *mySensors, QObject *parent) : AbstractCrudController(parent)
 {
     this->name = "sensor";
+    watchEvent(Sensor::getEvent());
+    addToDashboard("sensors");
     this->mySensors = mySensors;
     
     connect(Sensor::getEvent(), SIGNAL(dataChanged()), this, SLOT(sensorsDataHasChanged()), Qt::QueuedConnection);
@@ -18,7 +20,7 @@ SensorController::SensorController(MySensors *mySensors, QObject *parent) : Abst
             SLOT(sendCmdEvent(QObject *, QString, QString)),
             Qt::QueuedConnection);
  
-    router.insert("set_value.js", "jsonSetValue");
+    addRoute("set_value.js", &SensorController::jsonSetValue);
     Sensor::update();
 }
 
@@ -33,10 +35,10 @@ QJsonArray SensorController::getList()
     return result;
 }
 
-QJsonObject SensorController::updateElement(bool createNewObject)
+QJsonObject SensorController::updateElement(RequestContext *context, bool createNewObject)
 {
     Q_UNUSED(createNewObject);
-    QString id = query->getItem("id");
+    QString id = context->getQuery()->getItem("id");
     Sensor *sensor;
 
     if (Sensor::isIdValid(id)) {
@@ -45,14 +47,14 @@ QJsonObject SensorController::updateElement(bool createNewObject)
         sensor = new Sensor(id);
     }
 
-    sensor->setCmd(query->getItem("cmd"));
-    sensor->setName(query->getItem("name"));
-    sensor->setFullName(query->getItem("full_name"));
-    sensor->setCategory(query->getItem("category"));
-    sensor->setOrder(query->getItem("order").toInt());
-    sensor->setVisibility(query->getItem("visibility"));
-    sensor->setInvertBinary(query->getItem("invert_binary") == "true" ? true : false);
-    sensor->setValue(query->getItem("value"));
+    sensor->setCmd(context->getQuery()->getItem("cmd"));
+    sensor->setName(context->getQuery()->getItem("name"));
+    sensor->setFullName(context->getQuery()->getItem("full_name"));
+    sensor->setCategory(context->getQuery()->getItem("category"));
+    sensor->setOrder(context->getQuery()->getItem("order").toInt());
+    sensor->setVisibility(context->getQuery()->getItem("visibility"));
+    sensor->setInvertBinary(context->getQuery()->getItem("invert_binary") == "true" ? true : false);
+    sensor->setValue(context->getQuery()->getItem("value"));
     sensor->flush();
     
     return sensor->toJson();
@@ -69,18 +71,18 @@ bool SensorController::deleteElement(QString id)
     }
 }
 
-void SensorController::jsonSetValue()
+void SensorController::jsonSetValue(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie) &&
-            !socket->peerAddress().toString().contains("127.0.0.1")) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()) &&
+            !context->getPeerAddress().toString().contains("127.0.0.1")) {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
     }
-    else if (Sensor::isIdValid(query->getItem("id"))) {
-        Sensor* s = Sensor::get(query->getItem("id"));
-        s->updateValue(query->getItem("value"));
+    else if (Sensor::isIdValid(context->getQuery()->getItem("id"))) {
+        Sensor* s = Sensor::get(context->getQuery()->getItem("id"));
+        s->updateValue(context->getQuery()->getItem("value"));
 
         result.insert("value", s->getValue());
         result.insert("success", true);
@@ -89,7 +91,7 @@ void SensorController::jsonSetValue()
        result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
 void SensorController::sensorsDataHasChanged()
@@ -14,7 +14,7 @@ public:
     SensorController(MySensors *mySensors, QObject *parent);
 
 public slots:
-    void jsonSetValue();
+    void jsonSetValue(RequestContext *context);
 
 protected slots:
     void sensorsDataHasChanged();
@@ -22,7 +22,7 @@ protected slots:
 
 protected:
     QJsonArray getList();
-    QJsonObject updateElement(bool createNewObject);
+    QJsonObject updateElement(RequestContext *context, bool createNewObject);
     bool deleteElement(QString id);
 
     MySensors *mySensors;
@@ -6,29 +6,30 @@
 SettingController::SettingController(QObject *parent) : AbstractCrudController(parent)
 {
     name = "setting";
+    watchEvent(Setting::getEvent());
 
-    router.insert("setting.js", "jsonSetting");
+    addRoute("setting.js", &SettingController::jsonSetting);
 }
 
-void SettingController::jsonSetting()
+void SettingController::jsonSetting(RequestContext *context)
 {
     QJsonObject result;
 
     Settings *settings = new Settings("", this);
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
-    } else if (query->getItem("id") != "") {
-        result.insert("id", query->getItem("id"));
-        result.insert("value", settings->value(query->getItem("id"), ""));
+    } else if (context->getQuery()->getItem("id") != "") {
+        result.insert("id", context->getQuery()->getItem("id"));
+        result.insert("value", settings->value(context->getQuery()->getItem("id"), ""));
         result.insert("success", true);
     } else {
         result.insert("msg", "Unknown status");
         result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
 QJsonArray SettingController::getList()
@@ -42,18 +43,18 @@ QJsonArray SettingController::getList()
     return result;
 }
 
-QJsonObject SettingController::updateElement(bool createNewObject)
+QJsonObject SettingController::updateElement(RequestContext *context, bool createNewObject)
 {
     Q_UNUSED(createNewObject);
-    QString id = query->getItem("id");
+    QString id = context->getQuery()->getItem("id");
     Setting *s = Setting::get(id);
 
     if (s == NULL) {
         s = new Setting(id);
     }
 
-    s->setGroup(query->getItem("group"));
-    s->setValue(query->getItem("value"));
+    s->setGroup(context->getQuery()->getItem("group"));
+    s->setValue(context->getQuery()->getItem("value"));
     s->flush();
     
     return s->toJson();
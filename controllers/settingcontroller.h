@@ -13,11 +13,11 @@ public:
     SettingController(QObject *parent = 0);
 
 public slots:
-    void jsonSetting();
+    void jsonSetting(RequestContext *context);
 
 protected:
     QJsonArray getList();
-    QJsonObject updateElement(bool createNewObject);
+    QJsonObject updateElement(RequestContext *context, bool createNewObject);
     bool deleteElement(QString id);
 
 };
@@ -11,9 +11,11 @@
 SwitchController::SwitchController(MySensors *mySensors, QObject *parent) : AbstractCrudController(parent)
 {
     name = "switch";
+    watchEvent(Switch::getEvent());
+    addToDashboard("switches");
 
-    router.insert("change_switch_status", "jsonChangeSwitchStatus");
-    router.insert("update_switch_status.js", "jsonUpdateSwitchStatus");
+    addRoute("change_switch_status", &SwitchController::jsonChangeSwitchStatus);
+    addRoute("update_switch_status.js", &SwitchController::jsonUpdateSwitchStatus);
     Switch::update();
 
     connect(mySensors, SIGNAL(dataReceived(QString, int, int, int, QString)),
@@ -32,11 +34,11 @@ QJsonArray SwitchController::getList()
     return result;
 }
 
-QJsonObject SwitchController::updateElement(bool createNewObject)
+QJsonObject SwitchController::updateElement(RequestContext *context, bool createNewObject)
 {
     Q_UNUSED (createNewObject);
 
-    QString id = query->getItem("id");
+    QString id = context->getQuery()->getItem("id");
     Switch *sw;
     if (Switch::isIdValid(id)) {
         sw = Switch::get(id);
@@ -44,14 +46,14 @@ QJsonObject SwitchController::updateElement(bool createNewObject)
         sw = new Switch(id);
     }
 
-    sw->setName(query->getItem("name"));
-    sw->setCategory(query->getItem("category"));
-    sw->setOrder(query->getItem("order").toInt());
-    sw->setPowerOnCmd(query->getItem("power_on_cmd"));
-    sw->setPowerOffCmd(query->getItem("power_off_cmd"));
-    sw->setStatus(query->getItem("status"));
-    sw->setSensor(query->getItem("sensor"));
-    sw->setIsVisible(query->getItem("is_visible") == "true" ? true : false);
+    sw->setName(context->getQuery()->getItem("name"));
+    sw->setCategory(context->getQuery()->getItem("category"));
+    sw->setOrder(context->getQuery()->getItem("order").toInt());
+    sw->setPowerOnCmd(context->getQuery()->getItem("power_on_cmd"));
+    sw->setPowerOffCmd(context->getQuery()->getItem("power_off_cmd"));
+    sw->setStatus(context->getQuery()->getItem("status"));
+    sw->setSensor(context->getQuery()->getItem("sensor"));
+    sw->setIsVisible(context->getQuery()->getItem("is_visible") == "true" ? true : false);
     sw->flush();
     
     return sw->toJson();
@@ -68,23 +70,23 @@ bool SwitchController::deleteElement(QString id)
     }
 }
 
-void SwitchController::jsonChangeSwitchStatus()
+void SwitchController::jsonChangeSwitchStatus(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie) &&
-            !socket->peerAddress().toString().contains("127.0.0.1")) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()) &&
+            !context->getPeerAddress().toString().contains("127.0.0.1")) {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
     }
-    else if (Switch::isIdValid(query->getItem("id"))) {
-        Switch* sw = Switch::get(query->getItem("id"));
+    else if (Switch::isIdValid(context->getQuery()->getItem("id"))) {
+        Switch* sw = Switch::get(context->getQuery()->getItem("id"));
 
-        if (query->getItem("status").toLower() == "on") {
+        if (context->getQuery()->getItem("status").toLower() == "on") {
             sw->powerOn();
             result.insert("status", "on");
             result.insert("success", true);
-        } else if (query->getItem("status").toLower() == "off") {
+        } else if (context->getQuery()->getItem("status").toLower() == "off") {
             sw->powerOff();
             result.insert("status", "off");
             result.insert("success", true);
@@ -97,26 +99,26 @@ void SwitchController::jsonChangeSwitchStatus()
        result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void SwitchController::jsonUpdateSwitchStatus()
+void SwitchController::jsonUpdateSwitchStatus(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie) &&
-            !socket->peerAddress().toString().contains("127.0.0.1")) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie()) &&
+            !context->getPeerAddress().toString().contains("127.0.0.1")) {
         result.insert("msg", "You are not logged.");
         result.insert("success", false);
     }
-    else if (Switch::isIdValid(query->getItem("id"))) {
-        Switch* sw = Switch::get(query->getItem("id"));
+    else if (Switch::isIdValid(context->getQuery()->getItem("id"))) {
+        Switch* sw = Switch::get(context->getQuery()->getItem("id"));
 
-        if (query->getItem("status").toLower() == "on") {
+        if (context->getQuery()->getItem("status").toLower() == "on") {
             sw->updateStatus("on");
             result.insert("status", "on");
             result.insert("success", true);
-        } else if (query->getItem("status").toLower() == "off") {
+        } else if (context->getQuery()->getItem("status").toLower() == "off") {
             sw->updateStatus("off");
             result.insert("status", "off");
             result.insert("success", true);
@@ -129,7 +131,7 @@ void SwitchController::jsonUpdateSwitchStatus()
        result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
 void SwitchController::mySensorsDataReceived(QString messagetype, int sender, int sensor, int type, QString payload)
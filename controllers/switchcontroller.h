@@ -14,15 +14,15 @@ public:
     SwitchController(MySensors *mySensors, QObject *parent = 0);
 
 public slots:
-    void jsonChangeSwitchStatus();
-    void jsonUpdateSwitchStatus();
+    void jsonChangeSwitchStatus(RequestContext *context);
+    void jsonUpdateSwitchStatus(RequestContext *context);
 
 protected slots:
     void mySensorsDataReceived(QString messagetype, int sender, int sensor, int type, QString payload);
     
 protected:
     QJsonArray getList();
-    QJsonObject updateElement(bool createNewObject);
+    QJsonObject updateElement(RequestContext *context, bool createNewObject);
     bool deleteElement(QString id);
 };
 
@@ -1,6 +1,9 @@
 #include "thermostatcontroller.h"
+#include "core/jsonstreamwriter.h"
 #include "libraries/authentification.h"
+#include "libraries/dashboard.h"
 #include "models/heaterevent.h"
+#include "models/temperaturerollup.h"
 #include "libraries/settings.h"
 
 #include <QJsonArray>
@@ -20,19 +23,28 @@ ThermostatController::ThermostatController(Thermostat *thermostat, QObject *pare
         temperatureLogger->start();
     }
 
-    router.insert("events", "events");
-    router.insert("heaters", "heatersLogs");
-    router.insert("events.js", "jsonGetEvents");
-    router.insert("heaters.js", "jsonGetHeaters");
-    router.insert("temperature_logs.js", "jsonGetLogsTemperature");
-    router.insert("heaters_logs.js", "jsonGetLogsHeaters");
-    router.insert("status.js", "jsonGetStatus");
-    router.insert("set_setpoint", "jsonSetSetpoint");
-    router.insert("set_mode", "jsonSetHeaterMode");
-    router.insert("set_event_time", "jsonSetEventTime");
-    router.insert("set_status", "jsonSetStatus");
-    router.insert("add_event", "jsonAddEvent");
-    router.insert("delete_event", "jsonDeleteEvent");
+    Dashboard::dashboard().addSection("heaters", [this]() { return getHeatersVersion(); }, [this]() {
+        return QJsonValue(getHeaters());
+    });
+    Dashboard::dashboard().addSection("thermostat", [this]() {
+        return QByteArray::number(thermostat->getStatus()) + "." + QByteArray::number(temperatureLogger->isActive());
+    }, [this]() {
+        return QJsonValue(getStatus());
+    });
+
+    addRoute("events", &ThermostatController::events);
+    addRoute("heaters", &ThermostatController::heatersLogs);
+    addRoute("events.js", &ThermostatController::jsonGetEvents, true);
+    addRoute("heaters.js", &ThermostatController::jsonGetHeaters);
+    addRoute("temperature_logs.js", &ThermostatController::jsonGetLogsTemperature, true);
+    addRoute("heaters_logs.js", &ThermostatController::jsonGetLogsHeaters, true);
+    addRoute("status.js", &ThermostatController::jsonGetStatus);
+    addRoute("set_setpoint", &ThermostatController::jsonSetSetpoint);
+    addRoute("set_mode", &ThermostatController::jsonSetHeaterMode);
+    addRoute("set_event_time", &ThermostatController::jsonSetEventTime);
+    addRoute("set_status", &ThermostatController::jsonSetStatus);
+    addRoute("add_event", &ThermostatController::jsonAddEvent);
+    addRoute("delete_event", &ThermostatController::jsonDeleteEvent);
 }
 
 ThermostatController::~ThermostatController()
@@ -40,17 +52,17 @@ ThermostatController::~ThermostatController()
 
 }
 
-void ThermostatController::defaultAction()
+void ThermostatController::defaultAction(RequestContext *context)
 {   
-    if (!Authentification::auth().isConnected(header, cookie)) {
-        redirect("/auth");
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        redirect(context, "/auth");
         return;
     }
 
     QHash<QString, QByteArray> view;
-    view["content"] = loadHtmlView("views/thermostat/temperature.body.html", NULL, false);
-    view["bottom"] = loadHtmlView("views/thermostat/temperature.js", NULL, false);
-    loadHtmlView("views/template.html", &view);
+    view["content"] = loadView("views/thermostat/temperature.body.html");
+    view["bottom"] = loadView("views/thermostat/temperature.js");
+    loadHtmlView(context, "views/template.html", &view);
 }
 
 void ThermostatController::stop()
@@ -59,66 +71,98 @@ void ThermostatController::stop()
     temperatureLogger->stop();
 }
 
-void ThermostatController::events()
+void ThermostatController::events(RequestContext *context)
 {
-    if (!Authentification::auth().isConnected(header, cookie)) {
-        redirect("/auth");
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        redirect(context, "/auth");
         return;
     }
 
     QHash<QString, QByteArray> view;
-    view["head"] = loadHtmlView("views/thermostat/events.head.html", NULL, false);
-    view["content"] = loadHtmlView("views/thermostat/events.body.html", NULL, false);
-    view["bottom"] = loadHtmlView("views/thermostat/events.js", NULL, false);
-    loadHtmlView("views/template.html", &view);
+    view["head"] = loadView("views/thermostat/events.head.html");
+    view["content"] = loadView("views/thermostat/events.body.html");
+    view["bottom"] = loadView("views/thermostat/events.js");
+    loadHtmlView(context, "views/template.html", &view);
 
 }
 
-void ThermostatController::heatersLogs()
+void ThermostatController::heatersLogs(RequestContext *context)
 {
-    if (!Authentification::auth().isConnected(header, cookie)) {
-        redirect("/auth");
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        redirect(context, "/auth");
         return;
     }
 
     QHash<QString, QByteArray> view;
-    view["content"] = loadHtmlView("views/thermostat/heaters_logs.body.html", NULL, false);
-    view["bottom"] = loadHtmlView("views/thermostat/heaters_logs.js", NULL, false);
-    loadHtmlView("views/template.html", &view);
+    view["content"] = loadView("views/thermostat/heaters_logs.body.html");
+    view["bottom"] = loadView("views/thermostat/heaters_logs.js");
+    loadHtmlView(context, "views/template.html", &view);
 }
 
-void ThermostatController::jsonGetHeaters()
+void ThermostatController::jsonGetHeaters(RequestContext *context)
 {   
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("Result", "ERROR");
         result.insert("Message", "You are not logged.");
-    } else {
-        QList<Heater*> list = Heater::heaters()->values();
-        QJsonArray array;
-
-        foreach (Heater *heater, list) {
-            array.push_back(heater->toJson());
-        }
+        loadJsonView(context, result);
+        return;
+    }
 
+    loadVersionedJson(context, "heaters", getHeatersVersion(), [this]() {
+        QJsonObject result;
         result.insert("Result", "OK");
-        result.insert("Records", array);
+        result.insert("Records", getHeaters());
         result.insert("thermostat_status", thermostat->getStatus());
+        return result;
+    });
+}
+
+QByteArray ThermostatController::getHeatersVersion()
+{
+    // The current setpoints follow the schedule, without any model event
+    QByteArray version = QByteArray::number(Heater::getEvent()->getVersion()) + "."
+                         + QByteArray::number(Sensor::getEvent()->getVersion()) + "."
+                         + QByteArray::number(thermostat->getStatus());
+
+    foreach (Heater *heater, Heater::heaters()->values()) {
+        version += "." + QByteArray::number(heater->getCurrentSetpoint());
     }
 
-    loadJsonView(result);
+    return version;
 }
 
-void ThermostatController::jsonGetEvents()
+QJsonArray ThermostatController::getHeaters()
 {
-    QDate start = QDate::fromString(query->getItem("start"), "yyyy-MM-dd");
-    QDate end = QDate::fromString(query->getItem("end"), "yyyy-MM-dd");
+    QJsonArray array;
+
+    foreach (Heater *heater, Heater::heaters()->values()) {
+        array.push_back(heater->toJson());
+    }
+
+    return array;
+}
+
+QJsonObject ThermostatController::getStatus()
+{
+    QJsonObject result;
+
+    result.insert("thermostat_status", thermostat->getStatus());
+    result.insert("temperaturelogger_enable", temperatureLogger->isActive());
+
+    return result;
+}
+
+void ThermostatController::jsonGetEvents(RequestContext *context)
+{
+    QDate start = QDate::fromString(context->getQuery()->getItem("start"), "yyyy-MM-dd");
+    QDate end = QDate::fromString(context->getQuery()->getItem("end"), "yyyy-MM-dd");
 
     QJsonObject result;
     result.insert("success", false);
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
     }
 
@@ -138,18 +182,18 @@ void ThermostatController::jsonGetEvents()
         result.insert("records", array);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void ThermostatController::jsonGetLogsTemperature()
+void ThermostatController::jsonGetLogsTemperature(RequestContext *context)
 {
-    QDateTime start = QDateTime::fromString(query->getItem("start"), "yyyy-MM-dd HH:mm:ss");
-    QDateTime end = QDateTime::fromString(query->getItem("end"), "yyyy-MM-dd HH:mm:ss");
+    QDateTime start = QDateTime::fromString(context->getQuery()->getItem("start"), "yyyy-MM-dd HH:mm:ss");
+    QDateTime end = QDateTime::fromString(context->getQuery()->getItem("end"), "yyyy-MM-dd HH:mm:ss");
 
     QJsonObject result;
     result.insert("success", false);
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
     }
 
@@ -157,51 +201,92 @@ void ThermostatController::jsonGetLogsTemperature()
         result.insert("msg", "start date or end date invalid!");
     }
 
-    if (!result.contains("msg")) {
-        QList<Temperature> list = Temperature::get(start, end);
-        QJsonArray records;
-        float min = 50;
-        float max = 0;
+    if (result.contains("msg")) {
+        loadJsonView(context, result);
+        return;
+    }
 
-        if (end.addSecs(3600) >= QDateTime::currentDateTime()) {
-            QList<Temperature> &list2 = temperatureLogger->getTemperatures();
-            list.append(list2);
-        }
+    // Rows are sent while the query advances, a long range is never held in memory
+    JsonStreamWriter writer(context);
+    float min = 50;
+    float max = 0;
+
+    auto writeSample = [&writer, &min, &max](const QString &id, const QDateTime &date, float value) {
+        writer.beginObject();
+        writer.write("id", id);
+        writer.write("date", date);
+        writer.write("temp", value);
+        writer.endObject();
 
-        foreach (const Temperature &temp, list) {
-            QJsonObject element;
-            element.insert("id", temp.getId());
-            element.insert("date", temp.getDate().toString("yyyy-MM-dd HH:mm:ss"));
-            element.insert("temp", temp.getTemperature());
-            records.push_back(element);
+        if (value < min) {
+            min = value;
+        }
 
-            if (temp.getTemperature() < min) {
-                min = temp.getTemperature();
-            }
+        if (value > max) {
+            max = value;
+        }
+    };
+
+    auto writeTemperature = [&writeSample](const Temperature &temp) {
+        writeSample(temp.getId(), temp.getDate(), temp.getTemperature());
+    };
+
+    // Long ranges are read from the hourly or daily rollups: mean, with min and max of the period
+    TemperatureRollup::Resolution resolution = TemperatureRollup::getResolution(
+                context->getQuery()->getItem("resolution"), TemperatureRollup::getResolution(start, end));
+
+    auto writeRollup = [&writer, &min, &max](const TemperatureRollup &rollup) {
+        writer.beginObject();
+        writer.write("id", rollup.getId());
+        writer.write("date", rollup.getDate().toLocalTime());
+        writer.write("temp", rollup.getMean());
+        writer.write("min", rollup.getMin());
+        writer.write("max", rollup.getMax());
+        writer.endObject();
+
+        if (rollup.getMin() < min) {
+            min = rollup.getMin();
+        }
 
-            if (temp.getTemperature() > max) {
-                max = temp.getTemperature();
-            }
+        if (rollup.getMax() > max) {
+            max = rollup.getMax();
         }
+    };
 
-        result.insert("success", true);
-        result.insert("records", records);
-        result.insert("min", min);
-        result.insert("max", max);
+    writer.beginObject();
+    writer.write("success", true);
+    writer.write("resolution", (int) resolution);
+    writer.write("interval", temperatureLogger->getSampleInterval());
+    writer.writeName("records");
+    writer.beginArray();
+
+    if (resolution == TemperatureRollup::Raw) {
+        Temperature::get(start, end, writeTemperature);
+
+        // Samples not saved yet; a rollup gets them once saved, mixing them with periods would not chart
+        if (end.addSecs(3600) >= QDateTime::currentDateTime()) {
+            temperatureLogger->forEachTemperature(start, end, writeSample);
+        }
+    } else {
+        TemperatureRollup::get(start, end, resolution, writeRollup);
     }
 
-    loadJsonView(result);
+    writer.endArray();
+    writer.write("min", min);
+    writer.write("max", max);
+    writer.endObject();
+    writer.finish();
 }
 
-void ThermostatController::jsonGetLogsHeaters()
+void ThermostatController::jsonGetLogsHeaters(RequestContext *context)
 {
-    QDateTime start = QDateTime::fromString(query->getItem("start"), "yyyy-MM-dd HH:mm:ss");
-    QDateTime end = QDateTime::fromString(query->getItem("end"), "yyyy-MM-dd HH:mm:ss");
+    QDateTime start = QDateTime::fromString(context->getQuery()->getItem("start"), "yyyy-MM-dd HH:mm:ss");
+    QDateTime end = QDateTime::fromString(context->getQuery()->getItem("end"), "yyyy-MM-dd HH:mm:ss");
 
     QJsonObject result;
     result.insert("success", false);
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
     }
 
@@ -209,43 +294,46 @@ void ThermostatController::jsonGetLogsHeaters()
         result.insert("msg", "start date or end date invalid!");
     }
 
-    if (!result.contains("msg")) {
-        QList<HeaterIndicator> list = HeaterIndicator::get(start, end);
-        QJsonArray records;
-
-        foreach (const HeaterIndicator &indicator, list) {
-            QJsonObject element;
-            element.insert("heater_id", indicator.getHeaterId());
-            element.insert("duration", indicator.getDuration());
-            element.insert("start_date", indicator.getStartDate().toString("yyyy-MM-dd HH:mm:ss"));
-            element.insert("end_date", indicator.getEndDate().toString("yyyy-MM-dd HH:mm:ss"));
-            records.push_back(element);
-        }
-
-        result.insert("success", true);
-        result.insert("records", records);
+    if (result.contains("msg")) {
+        loadJsonView(context, result);
+        return;
     }
 
-    loadJsonView(result);
+    JsonStreamWriter writer(context);
+    writer.beginObject();
+    writer.write("success", true);
+    writer.writeName("records");
+    writer.beginArray();
+
+    HeaterIndicator::get(start, end, [&writer](const HeaterIndicator &indicator) {
+        writer.beginObject();
+        writer.write("heater_id", indicator.getHeaterId());
+        writer.write("duration", indicator.getDuration());
+        writer.write("start_date", indicator.getStartDate());
+        writer.write("end_date", indicator.getEndDate());
+        writer.endObject();
+    });
+
+    writer.endArray();
+    writer.endObject();
+    writer.finish();
 }
 
-void ThermostatController::jsonGetStatus()
+void ThermostatController::jsonGetStatus(RequestContext *context)
 {
-    QJsonObject result;
+    QJsonObject result = getStatus();
 
-    result.insert("thermostat_status", thermostat->getStatus());
-    result.insert("temperaturelogger_enable", temperatureLogger->isActive());
     result.insert("success", true);
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void ThermostatController::jsonSetSetpoint()
+void ThermostatController::jsonSetSetpoint(RequestContext *context)
 {
     QJsonObject result;
     bool success = true;
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
         success = false;
     }
@@ -253,7 +341,7 @@ void ThermostatController::jsonSetSetpoint()
     Heater *heater = NULL;
 
     if (success) {
-        heater = Heater::get(query->getItem("heater").toInt());
+        heater = Heater::get(context->getQuery()->getItem("heater").toInt());
     }
 
     if (success && heater == NULL) {
@@ -261,13 +349,13 @@ void ThermostatController::jsonSetSetpoint()
         success = false;
     }
 
-    if (success && query->getItem("heat_temperature") == "" && query->getItem("cool_temperature") == "") {
+    if (success && context->getQuery()->getItem("heat_temperature") == "" && context->getQuery()->getItem("cool_temperature") == "") {
         result.insert("msg", "Temperature missing");
         success = false;
     }
 
-    if (success && query->getItem("heat_temperature") != "") {
-        float temp = query->getItem("heat_temperature").toFloat(&success);
+    if (success && context->getQuery()->getItem("heat_temperature") != "") {
+        float temp = context->getQuery()->getItem("heat_temperature").toFloat(&success);
         if (success) {
             heater->setHeatSetpoint(temp);
             result.insert("heat_temperature", temp);
@@ -276,8 +364,8 @@ void ThermostatController::jsonSetSetpoint()
         }
     }
 
-    if (success && query->getItem("cool_temperature") != "") {
-        float temp = query->getItem("cool_temperature").toFloat(&success);
+    if (success && context->getQuery()->getItem("cool_temperature") != "") {
+        float temp = context->getQuery()->getItem("cool_temperature").toFloat(&success);
         if (success) {
             heater->setCoolSetpoint(temp);
             result.insert("cool_temperature", temp);
@@ -298,15 +386,15 @@ void ThermostatController::jsonSetSetpoint()
         result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void ThermostatController::jsonSetHeaterMode()
+void ThermostatController::jsonSetHeaterMode(RequestContext *context)
 {
     QJsonObject result;
     bool success = true;
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
         success = false;
     }
@@ -314,7 +402,7 @@ void ThermostatController::jsonSetHeaterMode()
     Heater *heater = NULL;
 
     if (success) {
-        heater = Heater::get(query->getItem("heater").toInt());
+        heater = Heater::get(context->getQuery()->getItem("heater").toInt());
     }
 
     if (success && heater == NULL) {
@@ -322,7 +410,7 @@ void ThermostatController::jsonSetHeaterMode()
         success = false;
     }
 
-    if (success && query->getItem("mode") == "") {
+    if (success && context->getQuery()->getItem("mode") == "") {
         result.insert("msg", "Mode missing");
         success = false;
     }
@@ -330,13 +418,13 @@ void ThermostatController::jsonSetHeaterMode()
     if (success) {
         Heater::Mode mode;
 
-        if (query->getItem("mode").toLower() == "off") {
+        if (context->getQuery()->getItem("mode").toLower() == "off") {
             mode = Heater::Off_Mode;
-        } else if (query->getItem("mode").toLower() == "auto") {
+        } else if (context->getQuery()->getItem("mode").toLower() == "auto") {
             mode = Heater::Auto_Mode;
-        } else if (query->getItem("mode").toLower() == "cool") {
+        } else if (context->getQuery()->getItem("mode").toLower() == "cool") {
             mode = Heater::Cool_Mode;
-        } else if (query->getItem("mode").toLower() == "heat") {
+        } else if (context->getQuery()->getItem("mode").toLower() == "heat") {
             mode = Heater::Heat_Mode;
         } else {
             result.insert("msg", "This mode doesn't exist!");
@@ -345,7 +433,7 @@ void ThermostatController::jsonSetHeaterMode()
 
         if (success) {
             heater->setMode(mode);
-            result.insert("mode", query->getItem("mode"));
+            result.insert("mode", context->getQuery()->getItem("mode"));
         }
     }
 
@@ -361,27 +449,27 @@ void ThermostatController::jsonSetHeaterMode()
         result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void ThermostatController::jsonSetEventTime()
+void ThermostatController::jsonSetEventTime(RequestContext *context)
 {
     bool success = true;
     QJsonObject result;
 
-    int event_id = query->getItem("event_id").toInt();
-    int occurrence_id = query->getItem("occurrence_id").toInt();
-    QDateTime startDate = QDateTime::fromString(query->getItem("start_date"), "yyyy-MM-dd HH:mm:ss");
-    QDateTime endDate = QDateTime::fromString(query->getItem("end_date"), "yyyy-MM-dd HH:mm:ss");
-    bool changeAllOccurrences = (query->getItem("all_occurrences")=="true") ? true : false;
+    int event_id = context->getQuery()->getItem("event_id").toInt();
+    int occurrence_id = context->getQuery()->getItem("occurrence_id").toInt();
+    QDateTime startDate = QDateTime::fromString(context->getQuery()->getItem("start_date"), "yyyy-MM-dd HH:mm:ss");
+    QDateTime endDate = QDateTime::fromString(context->getQuery()->getItem("end_date"), "yyyy-MM-dd HH:mm:ss");
+    bool changeAllOccurrences = (context->getQuery()->getItem("all_occurrences")=="true") ? true : false;
     HeaterEvent event;
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
         success = false;
     }
 
-    if (success && query->getItem("all_occurrences")!="true" && query->getItem("all_occurrences")!="false") {
+    if (success && context->getQuery()->getItem("all_occurrences")!="true" && context->getQuery()->getItem("all_occurrences")!="false") {
         result.insert("msg", "all_occurrences parameter invalid");
         success = false;
     }
@@ -451,33 +539,33 @@ void ThermostatController::jsonSetEventTime()
         result.insert("success", false);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void ThermostatController::jsonSetStatus()
+void ThermostatController::jsonSetStatus(RequestContext *context)
 {
     QJsonObject result;
     Settings settings("thermostat");
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
-    } else if (query->getItem("thermostat").toLower() == "running") {
+    } else if (context->getQuery()->getItem("thermostat").toLower() == "running") {
         thermostat->start();
         settings.setValue("start", "true");
-    } else if (query->getItem("thermostat").toLower() == "stopped") {
+    } else if (context->getQuery()->getItem("thermostat").toLower() == "stopped") {
         thermostat->stop();
         settings.setValue("start", "false");
-    } else if (query->getItem("thermostat").toLower() == "onbreak") {
-        if (query->getItem("time").toInt() > 0) {
-            thermostat->setOnBreak(query->getItem("time").toInt());
+    } else if (context->getQuery()->getItem("thermostat").toLower() == "onbreak") {
+        if (context->getQuery()->getItem("time").toInt() > 0) {
+            thermostat->setOnBreak(context->getQuery()->getItem("time").toInt());
             settings.setValue("start", "true");
         } else {
             result.insert("msg", "The time break is missing!");
         }
-    } else if (query->getItem("temperature_logger").toLower() == "running") {
+    } else if (context->getQuery()->getItem("temperature_logger").toLower() == "running") {
         temperatureLogger->start();
         settings.setValue("log_temperature", "true");
-    } else if (query->getItem("temperature_logger").toLower() == "stopped") {
+    } else if (context->getQuery()->getItem("temperature_logger").toLower() == "stopped") {
         temperatureLogger->stop();
         settings.setValue("log_temperature", "false");
     } else {
@@ -490,21 +578,21 @@ void ThermostatController::jsonSetStatus()
         result.insert("success", true);
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void ThermostatController::jsonAddEvent()
+void ThermostatController::jsonAddEvent(RequestContext *context)
 {
-    int heaterId = query->getItem("heater_id").toInt();
-    int occurrence = query->getItem("occurrence_number").toInt();
-    QDateTime startDate = QDateTime::fromString(query->getItem("start_date"), "yyyy-MM-dd HH:mm:ss");
-    QDateTime endDate = QDateTime::fromString(query->getItem("end_date"), "yyyy-MM-dd HH:mm:ss");
-    QString setpoint = query->getItem("setpoint");
+    int heaterId = context->getQuery()->getItem("heater_id").toInt();
+    int occurrence = context->getQuery()->getItem("occurrence_number").toInt();
+    QDateTime startDate = QDateTime::fromString(context->getQuery()->getItem("start_date"), "yyyy-MM-dd HH:mm:ss");
+    QDateTime endDate = QDateTime::fromString(context->getQuery()->getItem("end_date"), "yyyy-MM-dd HH:mm:ss");
+    QString setpoint = context->getQuery()->getItem("setpoint");
 
     QJsonObject result;
     result.insert("success", false);
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
     }
 
@@ -543,27 +631,27 @@ void ThermostatController::jsonAddEvent()
         }
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void ThermostatController::jsonDeleteEvent()
+void ThermostatController::jsonDeleteEvent(RequestContext *context)
 {
     QJsonObject result;
     result.insert("success", false);
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("msg", "You are not logged.");
     }
-    else if (query->getItem("event_id").toInt() > 0) {
-        if (HeaterEvent::removeAll(query->getItem("event_id").toInt())) {
+    else if (context->getQuery()->getItem("event_id").toInt() > 0) {
+        if (HeaterEvent::removeAll(context->getQuery()->getItem("event_id").toInt())) {
             thermostat->check(true);
             result.insert("success", true);
         } else {
             result.insert("msg", "Unknown error");
         }
     }
-    else if (query->getItem("occurrence_id").toInt() > 0) {
-        if (HeaterEvent::removeOne(query->getItem("occurrence_id").toInt())) {
+    else if (context->getQuery()->getItem("occurrence_id").toInt() > 0) {
+        if (HeaterEvent::removeOne(context->getQuery()->getItem("occurrence_id").toInt())) {
             thermostat->check(true);
             result.insert("success", true);
         } else {
@@ -574,6 +662,6 @@ void ThermostatController::jsonDeleteEvent()
         result.insert("msg", "Missing id");
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
@@ -12,25 +12,29 @@ class ThermostatController : public AbstractController
 public:
     ThermostatController(Thermostat *thermostat, QObject *parent = 0);
     ~ThermostatController();
-    void defaultAction();
+    void defaultAction(RequestContext *context);
     void stop();
 
 public slots:
-    void events();
-    void heatersLogs();
-    void jsonGetHeaters();
-    void jsonGetEvents();
-    void jsonGetLogsHeaters();
-    void jsonGetLogsTemperature();
-    void jsonGetStatus();
-    void jsonSetSetpoint();
-    void jsonSetHeaterMode();
-    void jsonSetEventTime();
-    void jsonSetStatus();
-    void jsonAddEvent();
-    void jsonDeleteEvent();
+    void events(RequestContext *context);
+    void heatersLogs(RequestContext *context);
+    void jsonGetHeaters(RequestContext *context);
+    void jsonGetEvents(RequestContext *context);
+    void jsonGetLogsHeaters(RequestContext *context);
+    void jsonGetLogsTemperature(RequestContext *context);
+    void jsonGetStatus(RequestContext *context);
+    void jsonSetSetpoint(RequestContext *context);
+    void jsonSetHeaterMode(RequestContext *context);
+    void jsonSetEventTime(RequestContext *context);
+    void jsonSetStatus(RequestContext *context);
+    void jsonAddEvent(RequestContext *context);
+    void jsonDeleteEvent(RequestContext *context);
 
 protected:
+    QByteArray getHeatersVersion();
+    QJsonArray getHeaters();
+    QJsonObject getStatus();
+
     Thermostat *thermostat;
     TemperatureLogger *temperatureLogger;
 
@@ -1,78 +1,99 @@
 #include "abstractcontroller.h"
-#include <QDir>
+#include "compression.h"
+#include "viewtemplate.h"
+#include <QFileInfo>
 #include <QJsonDocument>
-#include <QMimeDatabase>
-#include <QMimeType>
 
 AbstractController::AbstractController(QObject *parent) : QObject(parent)
 {
 
 }
 
-void AbstractController::setOutput(QTextStream *value)
+void AbstractController::loadJsonView(RequestContext *context, QJsonObject json)
 {
-    output = value;
-}
+    QJsonDocument doc(json);
 
-void AbstractController::setSocket(QTcpSocket *value)
-{
-    socket = value;
-    cookie = "";
+    sendCompressed(context, "Content-Type: application/json; charset=\"utf-8\"\r\n", doc.toJson());
 }
 
-void AbstractController::setHeader(HttpHeader *value)
+void AbstractController::loadVersionedJson(RequestContext *context,
+                                           const QString &name,
+                                           const QByteArray &version,
+                                           std::function<QJsonObject()> build)
 {
-    header = value;
-}
-void AbstractController::setUrlQuery(UrlQuery *value)
-{
-    query = value;
-}
+    // Serialized once per version: a poll without change costs a lookup
+    static const QByteArray startId = QByteArray::number(QDateTime::currentMSecsSinceEpoch(), 36);
+    CachedJson &cached = cachedJsons[name];
+
+    if (cached.version != version || cached.body.isEmpty()) {
+        cached.version = version;
+        cached.etag = "\"" + name.toUtf8() + "-" + startId + "-" + version + "\"";
+        cached.gzipEtag = "\"" + name.toUtf8() + "-" + startId + "-" + version + "-gzip\"";
+        cached.body = QJsonDocument(build()).toJson();
+        cached.gzipBody.clear();
+    }
 
-void AbstractController::loadJsonView(QJsonObject json)
-{
-    QJsonDocument doc(json);
+    QByteArray headers = "Content-Type: application/json; charset=\"utf-8\"\r\n"
+                         "Cache-Control: no-cache\r\n"
+                         "Vary: Accept-Encoding\r\n";
+
+    foreach (const QByteArray &etag, context->getHeader()->getHeader("If-None-Match").split(',')) {
+        if (etag.trimmed() == cached.etag || etag.trimmed() == cached.gzipEtag) {
+            context->sendResponse("304 Not Modified", headers + "ETag: " + etag.trimmed() + "\r\n", "");
+            return;
+        }
+    }
 
-    *output << "HTTP/1.0 200 Ok\r\n";
-    *output << "Content-Type: application/json; charset=\"utf-8\"\r\n";
+    if (cached.body.size() > Compression::getThreshold()
+            && Compression::accepts(context->getHeader()->getHeader("Accept-Encoding"), "gzip")) {
+        if (cached.gzipBody.isEmpty()) {
+            cached.gzipBody = Compression::gzip(cached.body);
+        }
 
-    if (cookie != "") {
-        *output << cookie;
+        if (!cached.gzipBody.isEmpty()) {
+            context->sendResponse("200 OK",
+                                  headers + "ETag: " + cached.gzipEtag + "\r\n"
+                                  "Content-Encoding: gzip\r\n",
+                                  cached.gzipBody);
+            return;
+        }
     }
 
-    *output << "\r\n";
-    *output << doc.toJson();
-    output->flush();
+    context->sendResponse("200 OK", headers + "ETag: " + cached.etag + "\r\n", cached.body);
 }
 
-QByteArray AbstractController::loadHtmlView(const QString &view, const QHash<QString, QByteArray> *data, bool display)
+void AbstractController::loadHtmlView(RequestContext *context, const QString &view, const QHash<QString, QByteArray> *data)
 {
-    QString fileName = QDir::currentPath() + "/" + view;
-
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qCritical() << view << "not found.";
-        return QByteArray();
-    }
-
-    QByteArray block = file.readAll();
+    sendCompressed(context, "Content-Type: text/html; charset=\"utf-8\"\r\n", loadView(view, data));
+}
 
-    if (data != NULL) {
-        foreach (const QString &key, data->keys()) {
-            block.replace("<!-- {" + key + "} -->", data->value(key));
+void AbstractController::sendCompressed(RequestContext *context, const QByteArray &headers, const QByteArray &body)
+{
+    // Small bodies are sent as is, compressing them costs more than it saves
+    if (body.size() > Compression::getThreshold()
+            && Compression::accepts(context->getHeader()->getHeader("Accept-Encoding"), "gzip")) {
+        QByteArray compressed = Compression::gzip(body);
+
+        if (!compressed.isEmpty()) {
+            context->sendResponse("200 OK",
+                                  headers + "Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n",
+                                  compressed);
+            return;
         }
     }
 
-    if (display) {
-        *output << "HTTP/1.0 200 Ok\r\n";
-        *output << "Content-Type: text/html; charset=\"utf-8\"\r\n\r\n";
-        output->flush();
+    context->sendResponse("200 OK", headers + "Vary: Accept-Encoding\r\n", body);
+}
+
+QByteArray AbstractController::loadView(const QString &view, const QHash<QString, QByteArray> *data)
+{
+    QSharedPointer<const ViewTemplate> viewTemplate = ViewTemplate::get(view);
 
-        socket->write(block);
+    if (viewTemplate.isNull()) {
         return QByteArray();
-    } else {
-        return block;
     }
+
+    return viewTemplate->render(data);
 }
 
 QByteArray AbstractController::loadScript(const QString &javaScript)
@@ -80,72 +101,91 @@ QByteArray AbstractController::loadScript(const QString &javaScript)
     QString open = "<script>";
     QString close = "</script>";
 
-    return open.toUtf8() + loadHtmlView(javaScript, NULL, false) + close.toUtf8();
+    return open.toUtf8() + loadView(javaScript) + close.toUtf8();
 }
 
-void AbstractController::loadByteArray(const QByteArray &byteArray, QString contentType)
+void AbstractController::loadByteArray(RequestContext *context, const QByteArray &byteArray, QString contentType)
 {
+    context->sendResponse("200 OK", "Content-Type: " + contentType.toUtf8() + "\r\n", byteArray);
+}
+
+void AbstractController::loadFile(RequestContext *context, QFile &file)
+{
+    AssetCache::Asset asset;
+    QString fileName = QFileInfo(file).absoluteFilePath();
+
+    if (!AssetCache::cache().get(fileName, context->getHeader()->getHeader("Accept-Encoding"), asset)) {
+        notFound(context, "Oops, we are sorry but the page you are looking for was not found...");
+        return;
+    }
 
-        *output << "HTTP/1.0 200 Ok\r\n";
-        *output << "Content-Type: " + contentType + "\r\n\r\n";
-        output->flush();
+    QByteArray headers = "Content-Type: " + asset.mimeType + "\r\n";
+    headers += "ETag: " + asset.etag + "\r\n";
+    headers += "Last-Modified: " + AssetCache::toHttpDate(asset.lastModified) + "\r\n";
+    headers += "Cache-Control: " + AssetCache::cache().getCacheControl(fileName) + "\r\n";
+    headers += "Vary: Accept-Encoding\r\n";
 
-        socket->write(byteArray);
+    if (!asset.encoding.isEmpty()) {
+        headers += "Content-Encoding: " + asset.encoding + "\r\n";
+    }
+
+    if (isNotModified(context->getHeader(), asset)) {
+        context->sendResponse("304 Not Modified", headers, "");
+        return;
+    }
+
+    context->sendResponse("200 OK", headers, asset.data);
 }
 
-void AbstractController::loadFile(QFile &file)
+bool AbstractController::isNotModified(HttpHeader *header, const AssetCache::Asset &asset)
 {
-    if (!file.open(QIODevice::ReadOnly)) {
-        notFound("Oops, we are sorry but the page you are looking for was not found...");
-        return;
+    QByteArray ifNoneMatch = header->getHeader("If-None-Match");
+
+    // If-Modified-Since is only used when the client has no ETag
+    if (!ifNoneMatch.isEmpty()) {
+        foreach (const QByteArray &etag, ifNoneMatch.split(',')) {
+            QByteArray value = etag.trimmed();
+
+            if (value == "*" || value == asset.etag || value == "W/" + asset.etag) {
+                return true;
+            }
+        }
+
+        return false;
     }
 
-    QMimeDatabase db;
-    QMimeType mimeType = db.mimeTypeForFile(file.fileName());
+    QByteArray ifModifiedSince = header->getHeader("If-Modified-Since");
+
+    if (!ifModifiedSince.isEmpty()) {
+        QDateTime date = AssetCache::fromHttpDate(ifModifiedSince);
 
-    *output << "HTTP/1.0 200 Ok\r\n";
-    *output << "Content-Type: " + mimeType.name() + "\r\n\r\n";
-    output->flush();
+        return date.isValid() && asset.lastModified.toMSecsSinceEpoch() / 1000 <= date.toMSecsSinceEpoch() / 1000;
+    }
 
-    // Streaming the file
-    QByteArray block = file.readAll();
-    socket->write(block);
-    file.close();
+    return false;
 }
 
-void AbstractController::notFound(QString message)
+void AbstractController::notFound(RequestContext *context, QString message)
 {
-    *output << "HTTP/1.0 404 Not Found\r\n";
-    *output << "\r\n";
-    *output << message;
-    
-    output->flush();
+    context->sendResponse("404 Not Found", "Content-Type: text/html; charset=\"utf-8\"\r\n", message.toUtf8());
 }
 
-void AbstractController::forbidden(QString message)
+void AbstractController::forbidden(RequestContext *context, QString message)
 {
-    *output << "HTTP/1.0 403 Forbidden\r\n";
-    *output << "\r\n";
-    *output << message;
-    
-    output->flush();
+    context->sendResponse("403 Forbidden", "Content-Type: text/html; charset=\"utf-8\"\r\n", message.toUtf8());
 }
 
-void AbstractController::redirect(QString url)
+void AbstractController::redirect(RequestContext *context, QString url)
 {
-    *output << "HTTP/1.0 302 Found\r\n";
-    *output << "Location: " + url + "\r\n";
-    *output << "\r\n";
-    
-    output->flush();
+    context->sendResponse("302 Found", "Location: " + url.toUtf8() + "\r\n", QByteArray());
 }
 
-QHash<QString, QString> AbstractController::getRouter() const
+const Router &AbstractController::getRouter() const
 {
     return router;
 }
 
-
-
-
-
+bool AbstractController::isDefaultActionConcurrent() const
+{
+    return concurrentDefaultAction;
+}
@@ -1,15 +1,16 @@
 #ifndef ABSTRACTCONTROLLER_H
 #define ABSTRACTCONTROLLER_H
 
-#include "httpheader.h"
-#include "urlquery.h"
+#include "assetcache.h"
+#include "requestcontext.h"
+#include "router.h"
 #include <QFile>
 #include <QHash>
 #include <QJsonObject>
 #include <QObject>
 #include <QString>
-#include <QTcpSocket>
-#include <QTextStream>
+
+#include <functional>
 
 class AbstractController : public QObject
 {
@@ -18,30 +19,58 @@ class AbstractController : public QObject
 public:
     AbstractController(QObject *parent = 0);
 
-    virtual void defaultAction() = 0;
+    virtual void defaultAction(RequestContext *context) = 0;
     virtual void stop() = 0;
-    void setOutput(QTextStream *value);
-    void setSocket(QTcpSocket *value);
-    void setHeader(HttpHeader *value);
-    void setUrlQuery(UrlQuery *value);
-    QHash<QString, QString> getRouter() const;
+    const Router &getRouter() const;
+    bool isDefaultActionConcurrent() const;
 
 protected:
-    void loadJsonView(QJsonObject json);
-    QByteArray loadHtmlView(const QString &view, const QHash<QString, QByteArray> *data = NULL, bool display = true);
+    template <class T>
+    void addRoute(const QString &path, void (T::*handler)(RequestContext *), bool concurrent = false)
+    {
+        addRoute<T>("*", path, handler, concurrent);
+    }
+
+    template <class T>
+    void addRoute(const QByteArray &method,
+                  const QString &path,
+                  void (T::*handler)(RequestContext *),
+                  bool concurrent = false)
+    {
+        T *controller = static_cast<T *>(this);
+        router.addRoute(method, path, [controller, handler](RequestContext *context) {
+            (controller->*handler)(context);
+        }, concurrent);
+    }
+
+    void loadJsonView(RequestContext *context, QJsonObject json);
+    void loadVersionedJson(RequestContext *context,
+                           const QString &name,
+                           const QByteArray &version,
+                           std::function<QJsonObject()> build);
+    void loadHtmlView(RequestContext *context, const QString &view, const QHash<QString, QByteArray> *data = NULL);
+    void sendCompressed(RequestContext *context, const QByteArray &headers, const QByteArray &body);
+    QByteArray loadView(const QString &view, const QHash<QString, QByteArray> *data = NULL);
     QByteArray loadScript(const QString &javaScript);
-    void loadByteArray(const QByteArray &byteArray, QString contentType);
-    void loadFile(QFile &file);
-    void notFound(QString message);
-    void forbidden(QString message);
-    void redirect(QString url);
-
-    QTextStream *output;
-    QTcpSocket *socket;
-    HttpHeader *header;
-    UrlQuery *query;
-    QString cookie;
-    QHash<QString, QString> router;
+    void loadByteArray(RequestContext *context, const QByteArray &byteArray, QString contentType);
+    void loadFile(RequestContext *context, QFile &file);
+    bool isNotModified(HttpHeader *header, const AssetCache::Asset &asset);
+    void notFound(RequestContext *context, QString message);
+    void forbidden(RequestContext *context, QString message);
+    void redirect(RequestContext *context, QString url);
+
+    // Serialized responses of the versioned JSON views, only used by the owner thread
+    struct CachedJson {
+        QByteArray version;
+        QByteArray etag;
+        QByteArray gzipEtag;
+        QByteArray body;
+        QByteArray gzipBody;
+    };
+
+    Router router;
+    QHash<QString, CachedJson> cachedJsons;
+    bool concurrentDefaultAction = false;
 
 };
 
@@ -1,5 +1,6 @@
 #include "abstractcrudcontroller.h"
 #include "libraries/authentification.h"
+#include "libraries/dashboard.h"
 
 #include <QJsonObject>
 #include <QJsonDocument>
@@ -7,15 +8,17 @@
 
 AbstractCrudController::AbstractCrudController(QObject *parent) : AbstractController(parent)
 {
-    router.insert("list.js", "jsonList");
-    router.insert("create.js", "jsonCreate");
-    router.insert("update.js", "jsonUpdate");
-    router.insert("delete.js", "jsonDelete");
+    listVersion = 0;
+
+    addRoute("list.js", &AbstractCrudController::jsonList);
+    addRoute("create.js", &AbstractCrudController::jsonCreate);
+    addRoute("update.js", &AbstractCrudController::jsonUpdate);
+    addRoute("delete.js", &AbstractCrudController::jsonDelete);
 }
 
-void AbstractCrudController::defaultAction()
+void AbstractCrudController::defaultAction(RequestContext *context)
 {
-    crud();
+    crud(context);
 }
 
 void AbstractCrudController::stop()
@@ -23,87 +26,121 @@ void AbstractCrudController::stop()
 
 }
 
-void AbstractCrudController::crud()
+void AbstractCrudController::crud(RequestContext *context)
 {
-    if (!Authentification::auth().isConnected(header, cookie)) {
-        redirect("/auth");
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
+        redirect(context, "/auth");
         return;
     }
 
     QHash<QString, QByteArray> view;
-    view["head"] = loadHtmlView("views/" + name + "/crud.head.html", NULL, false);
-    view["content"] = loadHtmlView("views/" + name + "/crud.body.html", NULL, false);
-    view["bottom"] = loadHtmlView("views/" + name + "/crud.js", NULL, false);
-    loadHtmlView("views/template.html", &view);
+    view["head"] = loadView("views/" + name + "/crud.head.html");
+    view["content"] = loadView("views/" + name + "/crud.body.html");
+    view["bottom"] = loadView("views/" + name + "/crud.js");
+    loadHtmlView(context, "views/template.html", &view);
 }
 
-void AbstractCrudController::jsonList()
+void AbstractCrudController::jsonList(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("Result", "ERROR");
         result.insert("Message", "You are not logged.");
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
 
-    result.insert("Result", "OK");
-    result.insert("Records", getList());
-
-    loadJsonView(result);
+    loadVersionedJson(context, name + "-list", getListVersion(), [this]() {
+        QJsonObject result;
+        result.insert("Result", "OK");
+        result.insert("Records", getList());
+        return result;
+    });
 }
 
-void AbstractCrudController::jsonCreate()
+void AbstractCrudController::jsonCreate(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("Result", "ERROR");
         result.insert("Message", "You are not logged.");
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
     
     result.insert("Result", "OK");
-    result.insert("Record", updateElement(true));
+    result.insert("Record", updateElement(context, true));
+    invalidateList();
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void AbstractCrudController::jsonUpdate()
+void AbstractCrudController::jsonUpdate(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("Result", "ERROR");
         result.insert("Message", "You are not logged.");
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
     
     result.insert("Result", "OK");
-    result.insert("Record", updateElement(false));
+    result.insert("Record", updateElement(context, false));
+    invalidateList();
 
-    loadJsonView(result);
+    loadJsonView(context, result);
 }
 
-void AbstractCrudController::jsonDelete()
+void AbstractCrudController::jsonDelete(RequestContext *context)
 {
     QJsonObject result;
 
-    if (!Authentification::auth().isConnected(header, cookie)) {
+    if (!Authentification::auth().isConnected(context->getHeader(), context->getCookie())) {
         result.insert("Result", "ERROR");
         result.insert("Message", "You are not logged.");
-        loadJsonView(result);
+        loadJsonView(context, result);
         return;
     }
 
-    if (deleteElement(query->getItem("id"))) {
+    if (deleteElement(context->getQuery()->getItem("id"))) {
         result.insert("Result", "OK");
+        invalidateList();
     } else {
         result.insert("Result", "ERROR");
     }
 
-    loadJsonView(result);
+    loadJsonView(context, result);
+}
+
+QByteArray AbstractCrudController::getListVersion()
+{
+    // Changes made by this controller, then by anything emitting the model events
+    QByteArray version = QByteArray::number(listVersion);
+
+    foreach (const Event *event, events) {
+        version += "." + QByteArray::number(event->getVersion());
+    }
+
+    return version;
+}
+
+void AbstractCrudController::watchEvent(Event *event)
+{
+    events.append(event);
+}
+
+void AbstractCrudController::addToDashboard(const QString &section)
+{
+    Dashboard::dashboard().addSection(section, [this]() { return getListVersion(); }, [this]() {
+        return QJsonValue(getList());
+    });
+}
+
+void AbstractCrudController::invalidateList()
+{
+    listVersion++;
 }
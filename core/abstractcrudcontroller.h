@@ -2,6 +2,8 @@
 #define ABSTRACTCRUDCONTROLLER_H
 
 #include "abstractcontroller.h"
+#include "event.h"
+#include <QList>
 #include <QObject>
 #include <QString>
 
@@ -13,22 +15,28 @@ class AbstractCrudController : public AbstractController
 public:
     AbstractCrudController(QObject *parent = 0);
 
-    void defaultAction();
+    void defaultAction(RequestContext *context);
     void stop();
     
 public slots:
-    void crud();
-    void jsonList();
-    void jsonCreate();
-    void jsonUpdate();
-    void jsonDelete();
+    void crud(RequestContext *context);
+    void jsonList(RequestContext *context);
+    void jsonCreate(RequestContext *context);
+    void jsonUpdate(RequestContext *context);
+    void jsonDelete(RequestContext *context);
     
 protected:
     virtual QJsonArray getList() = 0;
-    virtual QJsonObject updateElement(bool createNewObject) = 0;
+    virtual QJsonObject updateElement(RequestContext *context, bool createNewObject) = 0;
     virtual bool deleteElement(QString id) = 0;
+    virtual QByteArray getListVersion();
+    void watchEvent(Event *event);
+    void addToDashboard(const QString &section);
+    void invalidateList();
 
     QString name;
+    QList<Event *> events;
+    int listVersion;
 };
 
 #endif // ABSTRACTCRUDCONTROLLER_H
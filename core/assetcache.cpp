@@ -0,0 +1,190 @@
+#include "assetcache.h"
+#include "compression.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QMimeDatabase>
+#include <QMimeType>
+#include <QMutexLocker>
+#include <QStringList>
+
+AssetCache::AssetCache()
+{
+    // The cost of an asset is its size in bytes
+    assets.setMaxCost(32*1024*1024);
+
+    // Vendored libraries are never modified, the other files (assets/css, assets/images, views)
+    // are revalidated with their ETag
+    QStringList libraries = QStringList() << "ace" << "bootstrap" << "bootstrap-growl" << "bootstrap-switch"
+                                          << "fullcalendar" << "highcharts" << "highstock" << "jquery"
+                                          << "jquery-twbs-pagination" << "jquery-ui" << "jtable";
+
+    foreach (const QString &library, libraries) {
+        cacheControls.append(qMakePair("assets/" + library + "/", QByteArray("public, max-age=604800")));
+    }
+    cacheControls.append(qMakePair(QString(""), QByteArray("no-cache")));
+}
+
+AssetCache& AssetCache::cache()
+{
+    static AssetCache instance;
+    return instance;
+}
+
+bool AssetCache::get(const QString &fileName, const QByteArray &acceptEncoding, Asset &asset)
+{
+    QFileInfo info(fileName);
+
+    if (!info.isFile() || !info.isReadable()) {
+        return false;
+    }
+
+    // Only the files of the application are kept, a modified file is reloaded
+    bool cacheable = !relativePath(fileName).isEmpty();
+    bool found = false;
+    Entry entry;
+
+    if (cacheable) {
+        QMutexLocker locker(&mutex);
+        Entry *cached = assets.object(fileName);
+
+        if (cached != NULL && cached->identity.lastModified == info.lastModified()
+                && cached->identity.data.size() == info.size()) {
+            entry = *cached;
+            found = true;
+        }
+    }
+
+    if (!found && !load(fileName, entry)) {
+        return false;
+    }
+
+    bool gzipAccepted = Compression::accepts(acceptEncoding, "gzip");
+
+    // The gzip variant is built on the first request which accepts it
+    if (gzipAccepted && !entry.gzipBuilt) {
+        if (Compression::isCompressible(entry.identity.mimeType)
+                && entry.identity.data.size() > Compression::getThreshold()) {
+            entry.gzip = Compression::gzip(entry.identity.data);
+        }
+
+        entry.gzipBuilt = true;
+        found = false;
+    }
+
+    if (cacheable && !found) {
+        QMutexLocker locker(&mutex);
+        assets.insert(fileName, new Entry(entry), entry.cost());
+    }
+
+    asset = entry.identity;
+
+    // Each encoding is a distinct representation with its own strong ETag
+    if (!entry.brotli.isEmpty() && Compression::accepts(acceptEncoding, "br")) {
+        asset.data = entry.brotli;
+        asset.encoding = "br";
+    } else if (!entry.gzip.isEmpty() && gzipAccepted) {
+        asset.data = entry.gzip;
+        asset.encoding = "gzip";
+    }
+
+    if (!asset.encoding.isEmpty()) {
+        asset.etag.insert(asset.etag.size() - 1, "-" + asset.encoding);
+    }
+
+    return true;
+}
+
+bool AssetCache::load(const QString &fileName, Entry &entry)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QMimeDatabase db;
+    QMimeType mimeType = db.mimeTypeForFile(fileName);
+    Asset &asset = entry.identity;
+
+    asset.lastModified = QFileInfo(file).lastModified();
+    asset.data = file.readAll();
+    asset.mimeType = mimeType.name().toUtf8();
+    asset.etag = "\"" + QCryptographicHash::hash(asset.data, QCryptographicHash::Sha1).toHex().left(32) + "\"";
+    asset.encoding = "";
+    file.close();
+
+    // Precompressed files built with the assets are used as is
+    entry.brotli = loadSibling(fileName + ".br", asset.lastModified);
+    entry.gzip = loadSibling(fileName + ".gz", asset.lastModified);
+    entry.gzipBuilt = !entry.gzip.isEmpty();
+
+    return true;
+}
+
+QByteArray AssetCache::loadSibling(const QString &fileName, const QDateTime &lastModified)
+{
+    QFile file(fileName);
+
+    // An outdated variant is ignored
+    if (!file.exists() || QFileInfo(file).lastModified() < lastModified || !file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QByteArray data = file.readAll();
+    file.close();
+
+    return data;
+}
+
+int AssetCache::Entry::cost() const
+{
+    return identity.data.size() + gzip.size() + brotli.size();
+}
+
+QByteArray AssetCache::getCacheControl(const QString &fileName) const
+{
+    QString path = relativePath(fileName);
+    QMutexLocker locker(&mutex);
+
+    for (const QPair<QString, QByteArray> &cacheControl : cacheControls) {
+        if (path.startsWith(cacheControl.first)) {
+            return cacheControl.second;
+        }
+    }
+
+    return "no-cache";
+}
+
+void AssetCache::setMaxSize(int bytes)
+{
+    QMutexLocker locker(&mutex);
+    assets.setMaxCost(bytes);
+}
+
+QString AssetCache::relativePath(const QString &fileName) const
+{
+    QString root = QDir::currentPath() + "/";
+
+    if (!fileName.startsWith(root)) {
+        return "";
+    }
+
+    return fileName.mid(root.length());
+}
+
+QByteArray AssetCache::toHttpDate(const QDateTime &date)
+{
+    return QLocale::c().toString(date.toUTC(), "ddd, dd MMM yyyy hh:mm:ss 'GMT'").toLatin1();
+}
+
+QDateTime AssetCache::fromHttpDate(const QByteArray &date)
+{
+    QDateTime result = QLocale::c().toDateTime(QString::fromLatin1(date), "ddd, dd MMM yyyy hh:mm:ss 'GMT'");
+    result.setTimeSpec(Qt::UTC);
+
+    return result;
+}
@@ -0,0 +1,54 @@
+#ifndef ASSETCACHE_H
+#define ASSETCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QDateTime>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+class AssetCache
+{
+public:
+    struct Asset {
+        QByteArray data;
+        QByteArray mimeType;
+        QByteArray etag;
+        QByteArray encoding;
+        QDateTime lastModified;
+    };
+
+    bool get(const QString &fileName, const QByteArray &acceptEncoding, Asset &asset);
+    QByteArray getCacheControl(const QString &fileName) const;
+    void setMaxSize(int bytes);
+
+    static AssetCache& cache();
+    static QByteArray toHttpDate(const QDateTime &date);
+    static QDateTime fromHttpDate(const QByteArray &date);
+
+protected:
+    // The identity representation with its compressed variants
+    struct Entry {
+        Asset identity;
+        QByteArray gzip;
+        QByteArray brotli;
+        bool gzipBuilt;
+
+        int cost() const;
+    };
+
+    AssetCache();
+    bool load(const QString &fileName, Entry &entry);
+    QByteArray loadSibling(const QString &fileName, const QDateTime &lastModified);
+    QString relativePath(const QString &fileName) const;
+
+    QCache<QString, Entry> assets;
+    QList<QPair<QString, QByteArray> > cacheControls;
+
+    // Every http worker uses the cache: entries are copied out under the lock
+    mutable QMutex mutex;
+};
+
+#endif // ASSETCACHE_H
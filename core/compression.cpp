@@ -0,0 +1,153 @@
+#include "compression.h"
+
+#include <QDebug>
+#include <QList>
+
+#include <zlib.h>
+
+int Compression::level = 6;
+int Compression::threshold = 1024;
+
+QByteArray Compression::gzip(const QByteArray &data)
+{
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+
+    // 15 + 16: maximum window with a gzip header and trailer
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        qWarning() << "Gzip initialization failed";
+        return QByteArray();
+    }
+
+    QByteArray result;
+    result.resize(deflateBound(&stream, data.size()));
+
+    stream.next_in = (Bytef *) data.constData();
+    stream.avail_in = data.size();
+    stream.next_out = (Bytef *) result.data();
+    stream.avail_out = result.size();
+
+    int status = deflate(&stream, Z_FINISH);
+    result.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    if (status != Z_STREAM_END) {
+        qWarning() << "Gzip compression failed";
+        return QByteArray();
+    }
+
+    return result;
+}
+
+bool Compression::accepts(const QByteArray &acceptEncoding, const QByteArray &coding)
+{
+    foreach (const QByteArray &element, acceptEncoding.split(',')) {
+        QList<QByteArray> parameters = element.split(';');
+
+        if (parameters.first().trimmed().toLower() != coding) {
+            continue;
+        }
+
+        // "gzip;q=0" means that the coding is refused
+        for (int i = 1; i < parameters.size(); i++) {
+            QByteArray parameter = parameters.at(i).trimmed();
+
+            if (parameter.startsWith("q=") && parameter.mid(2).toDouble() <= 0) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool Compression::isCompressible(const QByteArray &mimeType)
+{
+    return mimeType.startsWith("text/")
+           || mimeType.endsWith("javascript")
+           || mimeType.endsWith("json")
+           || mimeType.endsWith("xml")
+           || mimeType == "application/vnd.ms-fontobject"
+           || mimeType == "font/ttf"
+           || mimeType == "application/x-font-ttf";
+}
+
+int Compression::getLevel()
+{
+    return level;
+}
+
+void Compression::setLevel(int level)
+{
+    Compression::level = qBound(1, level, 9);
+}
+
+int Compression::getThreshold()
+{
+    return threshold;
+}
+
+void Compression::setThreshold(int bytes)
+{
+    threshold = bytes;
+}
+
+GzipStream::GzipStream()
+{
+    stream = new z_stream;
+    stream->zalloc = Z_NULL;
+    stream->zfree = Z_NULL;
+    stream->opaque = Z_NULL;
+
+    valid = deflateInit2(stream, Compression::getLevel(), Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+
+    if (!valid) {
+        qWarning() << "Gzip initialization failed";
+    }
+}
+
+GzipStream::~GzipStream()
+{
+    if (valid) {
+        deflateEnd(stream);
+    }
+
+    delete stream;
+}
+
+QByteArray GzipStream::compress(const QByteArray &data)
+{
+    // Each chunk is flushed so that the client can decode it right away
+    return deflateData(data, Z_SYNC_FLUSH);
+}
+
+QByteArray GzipStream::finish()
+{
+    return deflateData(QByteArray(), Z_FINISH);
+}
+
+QByteArray GzipStream::deflateData(const QByteArray &data, int flush)
+{
+    QByteArray result;
+
+    if (!valid) {
+        return result;
+    }
+
+    char buffer[16*1024];
+    stream->next_in = (Bytef *) data.constData();
+    stream->avail_in = data.size();
+
+    do {
+        stream->next_out = (Bytef *) buffer;
+        stream->avail_out = sizeof(buffer);
+        deflate(stream, flush);
+        result.append(buffer, sizeof(buffer) - stream->avail_out);
+    } while (stream->avail_out == 0);
+
+    return result;
+}
@@ -0,0 +1,42 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <QByteArray>
+
+class Compression
+{
+public:
+    static QByteArray gzip(const QByteArray &data);
+    static bool accepts(const QByteArray &acceptEncoding, const QByteArray &coding);
+    static bool isCompressible(const QByteArray &mimeType);
+
+    static int getLevel();
+    static void setLevel(int level);
+    static int getThreshold();
+    static void setThreshold(int bytes);
+
+protected:
+    static int level;
+    static int threshold;
+};
+
+struct z_stream_s;
+
+// Incremental gzip encoder, for responses which are sent in chunks
+class GzipStream
+{
+public:
+    GzipStream();
+    ~GzipStream();
+
+    QByteArray compress(const QByteArray &data);
+    QByteArray finish();
+
+protected:
+    QByteArray deflateData(const QByteArray &data, int flush);
+
+    z_stream_s *stream;
+    bool valid;
+};
+
+#endif // COMPRESSION_H
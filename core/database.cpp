@@ -1,75 +1,461 @@
 #include "database.h"
+#include "tools.h"
 #include <QDebug>
+#include <QJsonArray>
+#include <QMutexLocker>
 #include <QSqlError>
 #include <QSettings>
 #include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+#include <QThread>
 
 QMutex Database::mutex;
+QString Database::type;
+QHash<QString, Database::Statistics> Database::statistics;
+QThreadStorage<Database::Connection *> Database::connections;
+int Database::maxStatements = 128;
+int Database::healthCheckInterval = 60;
+int Database::busyTimeout = 5000;
 
 Database::Database()
 {
 
 }
 
+Database::Lease::Lease()
+{
+    local = localConnection();
+    local->beginLease();
+    name = local->getName();
+    start = QDateTime::currentDateTime();
+
+    QSqlDatabase db = database();
+    QDateTime lastUsed;
+
+    // The mutex only protects the statistics: connections are never shared
+    mutex.lock();
+    Statistics &stats = statistics[name];
+    stats.leases++;
+    stats.activeLeases++;
+    lastUsed = stats.lastUsed;
+    mutex.unlock();
+
+    // A connection idle for a while may have been closed by the server
+    if (!db.isOpen()) {
+        openConnection(db);
+    } else if (lastUsed.isValid() && lastUsed.secsTo(start) > healthCheckInterval) {
+        checkHealth(db);
+    }
+}
+
+Database::Lease::~Lease()
+{
+    local->endLease();
+
+    QDateTime now = QDateTime::currentDateTime();
+    qint64 time = start.msecsTo(now);
+
+    QMutexLocker locker(&mutex);
+    Statistics &stats = statistics[name];
+    stats.activeLeases--;
+    stats.leaseTime += time;
+    stats.maxLeaseTime = qMax(stats.maxLeaseTime, time);
+    stats.lastUsed = now;
+}
+
+QSqlDatabase Database::Lease::database() const
+{
+    return QSqlDatabase::database(name, false);
+}
+
+QSqlQuery Database::Lease::query() const
+{
+    return QSqlQuery(database());
+}
+
+QSqlQuery Database::Lease::prepare(const QString &sql, bool forwardOnly) const
+{
+    return local->prepare(sql, forwardOnly);
+}
+
+Database::Connection::Connection(const QString &name)
+    : statements(maxStatements)
+{
+    this->name = name;
+    this->depth = 0;
+
+    addConnection(name);
+}
+
+Database::Connection::~Connection()
+{
+    // A connection cannot be removed while queries still use it
+    clear();
+
+    mutex.lock();
+    statistics.remove(name);
+    mutex.unlock();
+
+    QSqlDatabase::removeDatabase(name);
+}
+
+QString Database::Connection::getName() const
+{
+    return name;
+}
+
+QSqlQuery Database::Connection::prepare(const QString &sql, bool forwardOnly)
+{
+    Key key(sql, forwardOnly);
+    Statement *statement = statements.object(key);
+
+    // Prepared once per connection and lent until the end of the lease
+    if (statement != nullptr && statement->lease == 0 && depth > 0) {
+        count(true);
+        statement->lease = depth;
+        lent.append(qMakePair(depth, key));
+        statement->query.finish();
+
+        return statement->query;
+    }
+
+    count(false);
+
+    QSqlQuery query(QSqlDatabase::database(name, false));
+
+    // Forward only must be set before prepare, the driver ignores it afterwards
+    query.setForwardOnly(forwardOnly);
+
+    if (!query.prepare(sql)) {
+        qCritical() << "Error with database: " << query.lastError() << sql;
+        return query;
+    }
+
+    // A statement lent already stays with its lease, this query is used once
+    if (statement == nullptr && depth > 0) {
+        statement = new Statement;
+        statement->query = query;
+        statement->lease = depth;
+        statements.insert(key, statement);
+        lent.append(qMakePair(depth, key));
+    }
+
+    return query;
+}
+
+void Database::Connection::clear()
+{
+    statements.clear();
+    lent.clear();
+}
+
+void Database::Connection::beginLease()
+{
+    depth++;
+}
+
+void Database::Connection::endLease()
+{
+    // The statements lent to the lease are free again, unless evicted meanwhile
+    for (int i = lent.size() - 1; i >= 0 && lent.at(i).first >= depth; i--) {
+        Statement *statement = statements.object(lent.at(i).second);
+
+        if (statement != nullptr && statement->lease >= depth) {
+            statement->lease = 0;
+        }
+        lent.removeAt(i);
+    }
+
+    depth--;
+}
+
+void Database::Connection::count(bool hit)
+{
+    QMutexLocker locker(&mutex);
+
+    if (hit) {
+        statistics[name].statementHits++;
+    } else {
+        statistics[name].statementMisses++;
+    }
+}
+
 void Database::initialize(const QString& type)
+{
+    Database::type = type;
+    localConnection();
+}
+
+QSqlDatabase Database::addConnection(const QString &name)
 {
     QSettings settings(QSettings::SystemScope, QCoreApplication::organizationName());
-    QSqlDatabase db = QSqlDatabase::addDatabase(type);
+    QSqlDatabase db = QSqlDatabase::addDatabase(type, name);
+
+    // An embedded database is a single file, relative to the application directory
+    if (isSqlite()) {
+        QString fileName = settings.value("database/databasename", "").toString();
+        if (fileName.isEmpty()) {
+            fileName = "doxeo.db";
+        }
+
+        db.setDatabaseName(QDir::current().absoluteFilePath(fileName));
+        db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=" + QString::number(busyTimeout));
+        return db;
+    }
 
     db.setHostName(settings.value("database/hostname", "").toString());
     db.setUserName(settings.value("database/username", "").toString());
     db.setPassword(settings.value("database/password", "").toString());
     db.setDatabaseName(settings.value("database/databasename", "").toString());
+
+    return db;
 }
 
-QSqlDatabase Database::get()
+bool Database::openConnection(QSqlDatabase db)
 {
-    mutex.lock();
-    QSqlDatabase db(QSqlDatabase::database());
+    if (!db.open()) {
+        qCritical() << "Connection database failed: " << db.lastError();
+        return false;
+    }
 
-    if (!db.isOpen()) {
-        if(!db.open()) {
-            qCritical() << "Connection database failed: " << db.lastError();
+    if (!isSqlite()) {
+        return true;
+    }
+
+    // WAL lets the worker threads read while the write-behind thread commits;
+    // NORMAL synchronous is safe in WAL mode and spares the SD card a sync per commit
+    QStringList pragmas;
+    pragmas << "PRAGMA journal_mode=WAL"
+            << "PRAGMA synchronous=NORMAL"
+            << "PRAGMA foreign_keys=ON"
+            << "PRAGMA temp_store=MEMORY"
+            << "PRAGMA cache_size=-4000"
+            << "PRAGMA busy_timeout=" + QString::number(busyTimeout);
+
+    QSqlQuery query(db);
+    foreach (const QString &pragma, pragmas) {
+        if (!query.exec(pragma)) {
+            qWarning() << "Database pragma failed: " << pragma << query.lastError();
         }
     }
 
-    return db;
+    return true;
 }
 
-QSqlQuery Database::getQuery()
+bool Database::isSqlite()
 {
-    return QSqlQuery(get());
+    return type == "QSQLITE";
+}
+
+QString Database::dateWithTime(const QString &column)
+{
+    // Keep the date of a datetime column and replace its time by the bound value
+    if (isSqlite()) {
+        return "date(" + column + ") || 'T' || ?";
+    }
+
+    return "concat(date(" + column + "), ' ', ?)";
+}
+
+bool Database::bootstrap(const QString &fileName)
+{
+    QSqlDatabase db = connection();
+
+    // The MySQL schema is installed by hand (sql/doxeo.sql), the embedded one on first start
+    if (!isSqlite() || db.tables().contains("sensor")) {
+        return true;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qCritical() << "Database schema not found: " << fileName;
+        return false;
+    }
+
+    QStringList lines;
+    foreach (const QString &line, QString::fromUtf8(file.readAll()).split('\n')) {
+        if (!line.trimmed().startsWith("--")) {
+            lines.append(line);
+        }
+    }
+
+    QSqlQuery query(db);
+    db.transaction();
+
+    foreach (const QString &statement, lines.join('\n').split(';', SKIP_EMPTY_PARTS)) {
+        if (statement.trimmed().isEmpty()) {
+            continue;
+        }
+
+        if (!query.exec(statement)) {
+            qCritical() << "Database schema failed: " << query.lastError() << statement;
+            db.rollback();
+            return false;
+        }
+    }
+
+    return db.commit();
+}
+
+QString Database::connectionName()
+{
+    QThread *thread = QThread::currentThread();
+
+    if (thread == QCoreApplication::instance()->thread()) {
+        return QSqlDatabase::defaultConnection;
+    }
+
+    return "doxeo_" + QString::number((quintptr) thread, 16);
+}
+
+Database::Connection *Database::localConnection()
+{
+    // A connection can only be used by the thread which created it: the thread storage
+    // deletes it when the thread ends, or with the application for the main thread
+    if (!connections.hasLocalData()) {
+        connections.setLocalData(new Connection(connectionName()));
+    }
+
+    return connections.localData();
+}
+
+QSqlDatabase Database::connection()
+{
+    return QSqlDatabase::database(localConnection()->getName(), false);
+}
+
+QSqlQuery Database::prepare(const QString &sql, bool forwardOnly)
+{
+    return localConnection()->prepare(sql, forwardOnly);
 }
 
 bool Database::exec(QSqlQuery &query)
 {
-    bool success =  query.exec();
+    bool success = query.exec();
+    QString name = connectionName();
+
+    // The server closed the connection (timeout, restart): reconnect and replay the query once
+    if (!success && isConnectionLost(query) && reconnect(connection())) {
+        QString sql = query.lastQuery();
+        bool forwardOnly = query.isForwardOnly();
+        QList<QVariant> values;
+
+        for (int i = 0; i < query.boundValues().size(); i++) {
+            values.append(query.boundValue(i));
+        }
+
+        query = localConnection()->prepare(sql, forwardOnly);
+
+        foreach (const QVariant &value, values) {
+            query.addBindValue(value);
+        }
 
-    if (!success && query.lastError().type() == 2) {
-        QSqlDatabase::database().open();
         success = query.exec();
     }
 
+    mutex.lock();
+    Statistics &stats = statistics[name];
+    stats.queries++;
     if (!success) {
-        qCritical() << "Error with database: " << query.lastError() << query.lastError().type();
-        if (query.lastError().type() == 2) {
-            QSqlDatabase::database().close();
-        }
+        stats.failures++;
+    }
+    mutex.unlock();
+
+    if (!success) {
+        qCritical() << "Error with database: " << query.lastError() << query.lastError().nativeErrorCode();
     }
 
     return success;
 }
 
-void Database::release()
+bool Database::isConnectionLost(const QSqlQuery &query)
 {
-    mutex.unlock();
+    QString code = query.lastError().nativeErrorCode();
+
+    // MySQL: 2006 server has gone away, 2013 lost connection during query
+    if (code == "2006" || code == "2013") {
+        return true;
+    }
+
+    return query.lastError().type() == QSqlError::ConnectionError;
+}
+
+bool Database::reconnect(QSqlDatabase db)
+{
+    // Prepared statements die with the connection
+    localConnection()->clear();
+
+    db.close();
+    bool success = openConnection(db);
+
+    QMutexLocker locker(&mutex);
+    statistics[connectionName()].reconnects++;
+
+    if (!success) {
+        qCritical() << "Database reconnection failed";
+    }
+
+    return success;
+}
+
+bool Database::checkHealth(QSqlDatabase db)
+{
+    QSqlQuery query(db);
+
+    if (query.exec("SELECT 1")) {
+        return true;
+    }
+
+    return reconnect(db);
 }
 
 bool Database::open()
 {
-    mutex.lock();
-    bool result = QSqlDatabase::database().open();
-    mutex.unlock();
+    QSqlDatabase db = connection();
+    return db.isOpen() || openConnection(db);
+}
+
+QJsonObject Database::getStatistics()
+{
+    QMutexLocker locker(&mutex);
+    QJsonObject result;
+    QJsonArray connections;
+    int activeLeases = 0;
+
+    QHash<QString, Statistics>::const_iterator it;
+    for (it = statistics.constBegin(); it != statistics.constEnd(); ++it) {
+        const Statistics &stats = it.value();
+        QJsonObject connection;
+
+        connection.insert("name", it.key());
+        connection.insert("leases", stats.leases);
+        connection.insert("active_leases", stats.activeLeases);
+        connection.insert("queries", stats.queries);
+        connection.insert("failures", stats.failures);
+        connection.insert("reconnects", stats.reconnects);
+        connection.insert("statement_hits", stats.statementHits);
+        connection.insert("statement_misses", stats.statementMisses);
+
+        int lookups = stats.statementHits + stats.statementMisses;
+        connection.insert("statement_hit_rate", lookups > 0 ? (double) stats.statementHits / lookups : 0.0);
+        connection.insert("lease_time_ms", (double) stats.leaseTime);
+        connection.insert("max_lease_time_ms", (double) stats.maxLeaseTime);
+        connection.insert("last_used", stats.lastUsed.toString(Qt::ISODate));
+        connections.append(connection);
+
+        activeLeases += stats.activeLeases;
+    }
+
+    result.insert("type", type);
+    result.insert("connections", connections);
+    result.insert("active_leases", activeLeases);
 
     return result;
 }
+
+void Database::setHealthCheckInterval(int seconds)
+{
+    healthCheckInterval = seconds;
+}
@@ -1,24 +1,130 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QPair>
 #include <QSqlDatabase>
 #include <QSqlQuery>
-#include <QMutex>
+#include <QString>
+#include <QThreadStorage>
 
 class Database
 {
+protected:
+    class Connection;
+
 public:
+    /*
+     * Scoped use of the connection of the current thread. Each thread owns
+     * its connection, so a lease never waits for another thread; it checks
+     * the connection health and keeps the pool statistics up to date.
+     */
+    class Lease
+    {
+    public:
+        Lease();
+        ~Lease();
+
+        QSqlDatabase database() const;
+        QSqlQuery query() const;
+        QSqlQuery prepare(const QString &sql, bool forwardOnly = false) const;
+
+    private:
+        Q_DISABLE_COPY(Lease)
+
+        Connection *local;
+        QString name;
+        QDateTime start;
+    };
+
     Database();
 
     static void initialize(const QString &type);
-    static QSqlDatabase get();
-    static QSqlQuery getQuery();
+
+    // Outside a lease nothing tells when the query is done with: it is not cached
+    static QSqlQuery prepare(const QString &sql, bool forwardOnly = false);
     static bool exec(QSqlQuery &query);
-    static void release();
     static bool open();
+    static bool bootstrap(const QString &fileName);
+    static QJsonObject getStatistics();
+
+    static bool isSqlite();
+    static QString dateWithTime(const QString &column);
+
+    static void setHealthCheckInterval(int seconds);
 
 protected:
+    /*
+     * The connection of a thread and its prepared statements. It belongs to
+     * the thread and goes away with it, the statements before the
+     * connection. Past maxStatements the least recently used statement is
+     * evicted. A statement is lent to one lease at a time: a nested lease
+     * preparing the same SQL gets a query of its own, not cached.
+     */
+    class Connection
+    {
+    public:
+        explicit Connection(const QString &name);
+        ~Connection();
+
+        QString getName() const;
+        QSqlQuery prepare(const QString &sql, bool forwardOnly);
+        void clear();
+
+        void beginLease();
+        void endLease();
+
+    private:
+        Q_DISABLE_COPY(Connection)
+
+        typedef QPair<QString, bool> Key;
+
+        struct Statement {
+            QSqlQuery query;
+            int lease; // depth of the lease using it, 0 when free
+        };
+
+        void count(bool hit);
+
+        QString name;
+        QCache<Key, Statement> statements;
+        QList<QPair<int, Key>> lent;
+        int depth;
+    };
+
+    struct Statistics {
+        int leases = 0;
+        int activeLeases = 0;
+        int queries = 0;
+        int failures = 0;
+        int reconnects = 0;
+        int statementHits = 0;
+        int statementMisses = 0;
+        qint64 leaseTime = 0;
+        qint64 maxLeaseTime = 0;
+        QDateTime lastUsed;
+    };
+
+    static QString connectionName();
+    static Connection *localConnection();
+    static QSqlDatabase connection();
+    static QSqlDatabase addConnection(const QString &name);
+    static bool openConnection(QSqlDatabase db);
+    static bool isConnectionLost(const QSqlQuery &query);
+    static bool reconnect(QSqlDatabase db);
+    static bool checkHealth(QSqlDatabase db);
+
     static QMutex mutex;
+    static QString type;
+    static QHash<QString, Statistics> statistics;
+    static QThreadStorage<Connection *> connections;
+    static int maxStatements;
+    static int healthCheckInterval;
+    static int busyTimeout;
 };
 
 #endif // DATABASE_H
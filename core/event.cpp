@@ -1,7 +1,18 @@
 #include "event.h"
 
-Event::Event(QObject *parent) : QObject(parent)
+Event::Event(QObject *parent) : QObject(parent), version(0)
 {
+    // Any change of the models makes the cached responses built from them outdated
+    connect(this, &Event::dataChanged, this, &Event::increaseVersion, Qt::DirectConnection);
+    connect(this, &Event::valueUpdated, this, &Event::increaseVersion, Qt::DirectConnection);
+}
 
+int Event::getVersion() const
+{
+    return version.load();
 }
 
+void Event::increaseVersion()
+{
+    version.ref();
+}
@@ -1,6 +1,7 @@
 #ifndef EVENT_H
 #define EVENT_H
 
+#include <QAtomicInt>
 #include <QObject>
 
 class Event : public QObject
@@ -8,11 +9,18 @@ class Event : public QObject
     Q_OBJECT
 public:
     explicit Event(QObject *parent = 0);
+    int getVersion() const;
 
 signals:
     void valueUpdated(QString id, QString type, QString value);
     void dataChanged();
     void sendCmd(QObject *sensor, QString msg, QString comment);
+
+private slots:
+    void increaseVersion();
+
+private:
+    QAtomicInt version;
 };
 
 #endif // EVENT_H
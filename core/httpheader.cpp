@@ -1,27 +1,189 @@
 #include "httpheader.h"
 
+HttpHeader::HttpHeader()
+{
+    state = RequestLine;
+    bodyLength = 0;
+    scanned = 0;
+}
 
-HttpHeader::HttpHeader(QTcpSocket *request)
+HttpHeader::State HttpHeader::parse(QByteArray &buffer)
 {
-    QStringList firstHeader = QString(request->readLine()).split(QRegExp("[ \r\n][ \r\n]*"));
+    if (state == RequestLine) {
+        // Ignore the empty lines allowed before the request line
+        int start = 0;
+        while (start < buffer.size() && (buffer.at(start) == '\r' || buffer.at(start) == '\n')) {
+            start++;
+        }
 
-    if (firstHeader.size() > 1) {
-        method = firstHeader[0];
-        url = firstHeader[1];
-    } else {
-        method = "";
-        url = "";
+        if (start > 0) {
+            buffer.remove(0, start);
+        }
+
+        if (!buffer.isEmpty()) {
+            state = Headers;
+        }
+    }
+
+    if (state == Headers) {
+        // Resume the search where the previous read stopped
+        int end = buffer.indexOf("\r\n\r\n", qMax(0, scanned - 3));
+        int separatorLength = 4;
+
+        if (end < 0) {
+            end = buffer.indexOf("\n\n", qMax(0, scanned - 1));
+            separatorLength = 2;
+        }
+
+        if (end < 0) {
+            scanned = buffer.size();
+
+            if (buffer.size() > maxHeaderSize) {
+                setError("431 Request Header Fields Too Large");
+            }
+
+            return state;
+        }
+
+        if (end > maxHeaderSize) {
+            setError("431 Request Header Fields Too Large");
+            return state;
+        }
+
+        raw = buffer.left(end);
+        buffer.remove(0, end + separatorLength);
+
+        if (!parseHeaderBlock()) {
+            return state;
+        }
+
+        state = bodyLength > 0 ? Body : Complete;
+    }
+
+    if (state == Body) {
+        int length = qMin(bodyLength - body.size(), buffer.size());
+        body.append(buffer.constData(), length);
+        buffer.remove(0, length);
+
+        if (body.size() == bodyLength) {
+            state = Complete;
+        }
+    }
+
+    return state;
+}
+
+bool HttpHeader::parseHeaderBlock()
+{
+    const char *data = raw.constData();
+    int size = raw.size();
+
+    // Request line: METHOD SP URL SP VERSION
+    int lineEnd = raw.indexOf('\n');
+    if (lineEnd < 0) {
+        lineEnd = size;
+    }
+
+    int firstSpace = raw.indexOf(' ');
+    int secondSpace = firstSpace < 0 ? -1 : raw.indexOf(' ', firstSpace + 1);
+
+    if (firstSpace <= 0 || secondSpace < 0 || secondSpace > lineEnd) {
+        setError("400 Bad Request");
+        return false;
+    }
+
+    int versionEnd = lineEnd;
+    while (versionEnd > secondSpace && (data[versionEnd - 1] == '\r' || data[versionEnd - 1] == ' ')) {
+        versionEnd--;
+    }
+
+    method = QString::fromLatin1(data, firstSpace);
+    url = QString::fromUtf8(data + firstSpace + 1, secondSpace - firstSpace - 1);
+    version = QString::fromLatin1(data + secondSpace + 1, versionEnd - secondSpace - 1);
+
+    if (!version.startsWith("HTTP/")) {
+        setError("400 Bad Request");
+        return false;
+    }
+
+    // Header fields are kept as offsets into the raw block
+    int position = lineEnd + 1;
+    while (position < size) {
+        int end = raw.indexOf('\n', position);
+        if (end < 0) {
+            end = size;
+        }
+
+        int colon = raw.indexOf(':', position);
+        if (colon > position && colon < end) {
+            Field field;
+            int nameEnd = colon;
+            int valueStart = colon + 1;
+            int valueEnd = end;
+
+            while (nameEnd > position && data[nameEnd - 1] == ' ') {
+                nameEnd--;
+            }
+
+            while (valueStart < valueEnd && (data[valueStart] == ' ' || data[valueStart] == '\t')) {
+                valueStart++;
+            }
+
+            while (valueEnd > valueStart
+                   && (data[valueEnd - 1] == '\r' || data[valueEnd - 1] == ' ' || data[valueEnd - 1] == '\t')) {
+                valueEnd--;
+            }
+
+            field.nameStart = position;
+            field.nameLength = nameEnd - position;
+            field.valueStart = valueStart;
+            field.valueLength = valueEnd - valueStart;
+            fields.append(field);
+        }
+
+        position = end + 1;
+    }
+
+    if (!getHeader("Transfer-Encoding").isEmpty()) {
+        setError("411 Length Required");
+        return false;
     }
 
-    foreach(QByteArray line, request->readAll().split('\n')) {
-        int colon = line.indexOf(':');
-        if (colon > 0) {
-            QByteArray headerName = line.left(colon).trimmed();
-            QByteArray headerValue = line.mid(colon + 1).trimmed();
+    QByteArray contentLength = getHeader("Content-Length");
+    if (!contentLength.isEmpty()) {
+        bool ok;
+        bodyLength = contentLength.toInt(&ok);
 
-            headers.insertMulti(headerName, headerValue);
+        if (!ok || bodyLength < 0) {
+            setError("400 Bad Request");
+            return false;
         }
+
+        if (bodyLength > maxBodySize) {
+            setError("413 Payload Too Large");
+            return false;
+        }
+
+        body.reserve(bodyLength);
     }
+
+    return true;
+}
+
+void HttpHeader::setError(const QByteArray &status)
+{
+    state = Error;
+    errorStatus = status;
+}
+
+HttpHeader::State HttpHeader::getState() const
+{
+    return state;
+}
+
+QByteArray HttpHeader::getErrorStatus() const
+{
+    return errorStatus;
 }
 
 QString HttpHeader::getUrl() const
@@ -29,29 +191,69 @@ QString HttpHeader::getUrl() const
     return url;
 }
 
-QString HttpHeader::getCookie(QString name)
+QString HttpHeader::getVersion() const
+{
+    return version;
+}
+
+QByteArray HttpHeader::getHeader(const QByteArray &name) const
 {
-    if (!headers.contains("Cookie")) {
-        return "";
+    // Only the value found is copied: the result outlives the header
+    foreach (const Field &field, fields) {
+        if (field.nameLength == name.size()
+            && qstrnicmp(raw.constData() + field.nameStart, name.constData(), name.size()) == 0) {
+            return raw.mid(field.valueStart, field.valueLength);
+        }
     }
 
-    QString data = headers["Cookie"];
-    QStringList list = data.split("; ");
+    return QByteArray();
+}
+
+QByteArray HttpHeader::getBody() const
+{
+    return body;
+}
+
+QString HttpHeader::getCookie(QString name)
+{
+    QByteArray data = getHeader("Cookie");
+    QByteArray key = name.toUtf8();
+    int position = 0;
+
+    while (position < data.size()) {
+        int end = data.indexOf(';', position);
+        if (end < 0) {
+            end = data.size();
+        }
+
+        while (position < end && data.at(position) == ' ') {
+            position++;
+        }
 
-    foreach (QString element, list) {
-        QStringList cookie = element.split("=");
-        if (cookie.length() == 2 && cookie.at(0) == name) {
-            return cookie.at(1);
+        if (end - position > key.size() && data.at(position + key.size()) == '='
+            && qstrncmp(data.constData() + position, key.constData(), key.size()) == 0) {
+            int valueStart = position + key.size() + 1;
+            return QString::fromUtf8(data.constData() + valueStart, end - valueStart);
         }
+
+        position = end + 1;
     }
 
     return "";
 }
 
+bool HttpHeader::isKeepAlive() const
+{
+    QByteArray connection = getHeader("Connection").toLower();
+
+    if (version == "HTTP/1.1") {
+        return !connection.contains("close");
+    } else {
+        return connection.contains("keep-alive");
+    }
+}
+
 QString HttpHeader::getMethod() const
 {
     return method;
 }
-
-
-
@@ -1,22 +1,59 @@
 #ifndef HTTPHEADER_H
 #define HTTPHEADER_H
 
-#include <QTcpSocket>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
 
 class HttpHeader
 {
 public:
+    enum State {
+        RequestLine,
+        Headers,
+        Body,
+        Complete,
+        Error
+    };
+
     HttpHeader();
-    HttpHeader(QTcpSocket *request);
+
+    State parse(QByteArray &buffer);
+    State getState() const;
+    QByteArray getErrorStatus() const;
 
     QString getMethod() const;
     QString getUrl() const;
+    QString getVersion() const;
+    QByteArray getHeader(const QByteArray &name) const;
+    QByteArray getBody() const;
     QString getCookie(QString name);
+    bool isKeepAlive() const;
+
+    static const int maxHeaderSize = 16 * 1024;
+    static const int maxBodySize = 1024 * 1024;
 
 private:
+    struct Field {
+        int nameStart;
+        int nameLength;
+        int valueStart;
+        int valueLength;
+    };
+
+    bool parseHeaderBlock();
+    void setError(const QByteArray &status);
+
+    State state;
+    QByteArray errorStatus;
+    QByteArray raw;
+    QVector<Field> fields;
     QString method;
     QString url;
-    QHash<QByteArray, QByteArray> headers;
+    QString version;
+    QByteArray body;
+    int bodyLength;
+    int scanned;
 };
 
 #endif // HTTPHEADER_H
@@ -1,14 +1,46 @@
 #include "httpserver.h"
 #include "httpheader.h"
+#include <QDebug>
 #include <QDir>
 #include <QElapsedTimer>
+#include <QRunnable>
 #include <QSslConfiguration>
-#include <QSslKey>
-#include <QSslSocket>
+
+// A handler run by the pool of the server
+class HandlerTask : public QRunnable
+{
+public:
+    HandlerTask(std::function<void()> handler)
+    {
+        this->handler = handler;
+    }
+
+    void run()
+    {
+        handler();
+    }
+
+protected:
+    std::function<void()> handler;
+};
 
 HttpServer::HttpServer(QObject *parent) : QTcpServer(parent)
 {
-    connect(this, &HttpServer::newConnection, this, &HttpServer::newClient);
+    qRegisterMetaType<qintptr>("qintptr");
+
+    // A streamed response to a slow client holds its thread until it is drained or aborted
+    handlerPool.setMaxThreadCount(16);
+}
+
+HttpServer::~HttpServer()
+{
+    // The handlers still running write to contexts owned by the workers
+    handlerPool.waitForDone();
+
+    for (QThread *thread : threads) {
+        thread->quit();
+        thread->wait();
+    }
 }
 
 bool HttpServer::start(quint16 port)
@@ -16,6 +48,47 @@ bool HttpServer::start(quint16 port)
     return listen(QHostAddress::Any, port);
 }
 
+void HttpServer::setKeepAlive(int timeout, int maxRequests)
+{
+    keepAliveTimeout = timeout;
+    maxRequestsPerConnection = maxRequests;
+}
+
+int HttpServer::getKeepAliveTimeout() const
+{
+    return keepAliveTimeout;
+}
+
+int HttpServer::getMaxRequestsPerConnection() const
+{
+    return maxRequestsPerConnection;
+}
+
+void HttpServer::setWorkerCount(int count)
+{
+    if (!workers.isEmpty()) {
+        qWarning() << "Http workers are already started";
+        return;
+    }
+
+    // Without worker thread, connections are handled by the main thread
+    if (count <= 0) {
+        workers.append(new HttpWorker(this, this));
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        QThread *thread = new QThread(this);
+        HttpWorker *worker = new HttpWorker(this);
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+        thread->start();
+
+        threads.append(thread);
+        workers.append(worker);
+    }
+}
+
 void HttpServer::enableSsl(QFile &key, QFile &certificate, QFile &chain)
 {
     // add key
@@ -37,113 +110,102 @@ void HttpServer::enableSsl(QFile &key, QFile &certificate, QFile &chain)
     sslEnable = true;
 }
 
-void HttpServer::incomingConnection(qintptr socketDescriptor)
+bool HttpServer::isSslEnabled() const
 {
-    if (!sslEnable) {
-        QTcpSocket *socket = new QTcpSocket(this);
-        socket->setSocketDescriptor(socketDescriptor);
-        addPendingConnection(socket);
-    } else {
-        QSslSocket *socket = new QSslSocket(this);
-
-        if (socket->setSocketDescriptor(socketDescriptor)) {
-            connect(socket, &QSslSocket::encrypted, this, &HttpServer::encrypted);
-            connect(socket,
-                    SIGNAL(sslErrors(QList<QSslError>)),
-                    this,
-                    SLOT(sslErrors(QList<QSslError>)));
-            connect(socket, &QSslSocket::peerVerifyError, this, &HttpServer::peerVerifyError);
-
-            socket->setProtocol(QSsl::TlsV1_2);
-            socket->setLocalCertificate(certificate);
-            socket->setLocalCertificateChain(chains);
-            socket->setPrivateKey(key);
-            socket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
-            socket->setPeerVerifyMode(QSslSocket::QueryPeer);
-            socket->startServerEncryption();
-
-            addPendingConnection(socket);
-        } else {
-            socket->deleteLater();
-        }
-    }
+    return sslEnable;
 }
 
-void HttpServer::encrypted() {}
+void HttpServer::configureSsl(QSslSocket *socket) const
+{
+    socket->setProtocol(QSsl::TlsV1_2);
+    socket->setLocalCertificate(certificate);
+    socket->setLocalCertificateChain(chains);
+    socket->setPrivateKey(key);
+    socket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
+    socket->setPeerVerifyMode(QSslSocket::QueryPeer);
+}
 
-void HttpServer::newClient()
+void HttpServer::incomingConnection(qintptr socketDescriptor)
 {
-    QTcpSocket *socket = nextPendingConnection();
+    if (workers.isEmpty()) {
+        setWorkerCount(0);
+    }
 
-    connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
-    connect(socket, SIGNAL(disconnected()), this, SLOT(discardClient()));
+    // Connections are spread over the workers, which own their socket from now on
+    HttpWorker *worker = workers.at(nextWorker);
+    nextWorker = (nextWorker + 1) % workers.size();
+
+    QMetaObject::invokeMethod(worker,
+                              "addConnection",
+                              Qt::QueuedConnection,
+                              Q_ARG(qintptr, socketDescriptor));
 }
 
-void HttpServer::readClient()
+void HttpServer::dispatch(RequestContext *context)
 {
-    QElapsedTimer timer;
-    timer.start();
-
-    QTcpSocket *socket = (QTcpSocket *) sender();
     AbstractController *controller;
+    QStringList segments = context->getQuery()->getAllQuery();
 
-    if (socket->canReadLine()) {
-        QTextStream os(socket);
-        os.setAutoDetectUnicode(true);
-        HttpHeader httpHeader(socket);
-        UrlQuery urlQuery(httpHeader.getUrl());
-
-        QString function;
-
-        if (controllers.contains(urlQuery.getQuery(0))) {
-            controller = controllers[urlQuery.getQuery(0)];
-            function = urlQuery.getQuery(1);
-        } else {
-            controller = controllers["default"];
-            function = urlQuery.getQuery(0);
-        }
-
-        controller->setSocket(socket);
-        controller->setHeader(&httpHeader);
-        controller->setUrlQuery(&urlQuery);
-        controller->setOutput(&os);
-
-        if (controller->getRouter().contains(function.toStdString().c_str())) {
-            QMetaObject::invokeMethod(controller,
-                                      controller->getRouter()[function].toStdString().c_str(),
-                                      Qt::DirectConnection);
-        } else {
-            controller->defaultAction();
-        }
-
-        socket->disconnectFromHost();
-
-        if (socket->state() == QTcpSocket::UnconnectedState) {
-            socket->deleteLater();
-        }
-
-        if (timer.elapsed() > 3000) {
-            qDebug() << httpHeader.getUrl() << "took" << timer.elapsed() << "milliseconds.";
-        }
+    if (!segments.isEmpty() && controllers.contains(segments.first())) {
+        controller = controllers[segments.takeFirst()];
+    } else {
+        controller = controllers["default"];
     }
-}
 
-void HttpServer::discardClient()
-{
-    QTcpSocket *socket = (QTcpSocket *) sender();
-    socket->deleteLater();
-}
+    const Router::Route *route = nullptr;
+    QHash<QString, QString> parameters;
+    Router::Match match = controller->getRouter().match(context->getHeader()->getMethod().toLatin1(),
+                                                        segments,
+                                                        &route,
+                                                        &parameters);
+
+    if (match == Router::MethodNotAllowed) {
+        context->sendResponse("405 Method Not Allowed",
+                              "Allow: " + controller->getRouter().getAllowedMethods(segments) + "\r\n",
+                              "");
+        context->handlerReturned();
+        return;
+    }
 
-void HttpServer::sslErrors(const QList<QSslError> &errors)
-{
-    for (QSslError error : errors) {
-        qWarning() << "Ssl error: " << error.errorString();
+    context->setParameters(parameters);
+    bool concurrent = route != nullptr ? route->concurrent : controller->isDefaultActionConcurrent();
+
+    // Handlers which touch the models run in the thread owning them, others run in the pool:
+    // the worker never waits for a handler and keeps sending what it writes
+    if (concurrent) {
+        handlerPool.start(new HandlerTask([this, controller, route, context]() {
+            invokeHandler(controller, route, context);
+        }));
+    } else if (controller->thread() == QThread::currentThread()) {
+        invokeHandler(controller, route, context);
+    } else {
+        QMetaObject::invokeMethod(controller, [this, controller, route, context]() {
+            invokeHandler(controller, route, context);
+        }, Qt::QueuedConnection);
     }
 }
 
-void HttpServer::peerVerifyError(const QSslError &error)
+void HttpServer::invokeHandler(AbstractController *controller, const Router::Route *route, RequestContext *context)
 {
-    qWarning() << "Ssl error: " << error.errorString();
+    QElapsedTimer timer;
+    timer.start();
+
+    if (route != nullptr) {
+        route->handler(context);
+    } else {
+        controller->defaultAction(context);
+    }
+
+    if (timer.elapsed() > 3000) {
+        qDebug() << context->getHeader()->getUrl() << "took" << timer.elapsed() << "milliseconds.";
+    }
+
+    // The context is released by its worker once the handler has returned
+    if (context->thread() == QThread::currentThread()) {
+        context->handlerReturned();
+    } else {
+        QMetaObject::invokeMethod(context, "handlerReturned", Qt::QueuedConnection);
+    }
 }
 
 void HttpServer::addController(AbstractController *controller, QString params)
@@ -3,11 +3,15 @@
 
 #include <QFile>
 #include <QHash>
-#include <QSslError>
+#include <QList>
 #include <QSslKey>
+#include <QSslSocket>
 #include <QTcpServer>
+#include <QThread>
+#include <QThreadPool>
 
 #include "abstractcontroller.h"
+#include "httpworker.h"
 
 class HttpServer : public QTcpServer
 {
@@ -15,27 +19,36 @@ class HttpServer : public QTcpServer
 
 public:
     HttpServer(QObject *parent = 0);
+    ~HttpServer();
     void enableSsl(QFile &key, QFile &certificate, QFile &chain);
+    bool isSslEnabled() const;
+    void configureSsl(QSslSocket *socket) const;
     void addController(AbstractController *controller, QString params);
     QHash<QString, AbstractController*> getControllers();
     bool start(quint16 port);
-
-private slots:
-    void encrypted();
-    void newClient();
-    void readClient();
-    void discardClient();
-    void sslErrors(const QList<QSslError> &errors);
-    void peerVerifyError(const QSslError &error);
+    void setKeepAlive(int timeout, int maxRequests);
+    int getKeepAliveTimeout() const;
+    int getMaxRequestsPerConnection() const;
+    void setWorkerCount(int count);
+    void dispatch(RequestContext *context);
 
 private:
     void incomingConnection(qintptr socketDescriptor);
+    void invokeHandler(AbstractController *controller, const Router::Route *route, RequestContext *context);
 
     bool sslEnable = false;
     QSslKey key;
     QSslCertificate certificate;
     QList<QSslCertificate> chains;
     QHash<QString, AbstractController *> controllers;
+    QList<HttpWorker *> workers;
+    QList<QThread *> threads;
+
+    // Concurrent handlers, which may wait for a slow client, run here instead of in the workers
+    QThreadPool handlerPool;
+    int nextWorker = 0;
+    int keepAliveTimeout = 15000;
+    int maxRequestsPerConnection = 100;
 };
 
 #endif
@@ -0,0 +1,176 @@
+#include "httpworker.h"
+#include "httpserver.h"
+
+#include <QDebug>
+#include <QSslSocket>
+
+HttpWorker::HttpWorker(HttpServer *server, QObject *parent) : QObject(parent)
+{
+    this->server = server;
+}
+
+void HttpWorker::addConnection(qintptr socketDescriptor)
+{
+    QTcpSocket *socket;
+
+    // Sockets are created here so that they live in the thread of the worker
+    if (!server->isSslEnabled()) {
+        socket = new QTcpSocket(this);
+
+        if (!socket->setSocketDescriptor(socketDescriptor)) {
+            socket->deleteLater();
+            return;
+        }
+    } else {
+        QSslSocket *sslSocket = new QSslSocket(this);
+
+        if (!sslSocket->setSocketDescriptor(socketDescriptor)) {
+            sslSocket->deleteLater();
+            return;
+        }
+
+        connect(sslSocket,
+                SIGNAL(sslErrors(QList<QSslError>)),
+                this,
+                SLOT(sslErrors(QList<QSslError>)));
+        connect(sslSocket, &QSslSocket::peerVerifyError, this, &HttpWorker::peerVerifyError);
+
+        server->configureSsl(sslSocket);
+        sslSocket->startServerEncryption();
+        socket = sslSocket;
+    }
+
+    // Close idle connections: the timer is restarted after each response
+    Connection connection;
+    connection.requestCount = 0;
+    connection.context = nullptr;
+    connection.processing = false;
+    connection.idleTimer = new QTimer(socket);
+    connection.idleTimer->setSingleShot(true);
+    connection.idleTimer->setInterval(server->getKeepAliveTimeout());
+    connect(connection.idleTimer, &QTimer::timeout, socket, &QTcpSocket::disconnectFromHost);
+    connection.idleTimer->start();
+    connections.insert(socket, connection);
+
+    // Bytes the worker has not taken yet stay in the kernel instead of the socket
+    socket->setReadBufferSize(maxBufferSize);
+
+    connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
+    connect(socket, SIGNAL(disconnected()), this, SLOT(discardClient()));
+}
+
+void HttpWorker::readClient()
+{
+    QTcpSocket *socket = (QTcpSocket *) sender();
+
+    if (!connections.contains(socket)) {
+        return;
+    }
+
+    processRequests(socket);
+}
+
+void HttpWorker::fillBuffer(QTcpSocket *socket)
+{
+    Connection &connection = connections[socket];
+    qint64 room = maxBufferSize - connection.buffer.size();
+
+    // Pipelined requests are only read once there is room for them: a full buffer
+    // stops the reads and the client is held back by TCP flow control
+    if (room > 0 && socket->bytesAvailable() > 0) {
+        connection.buffer.append(socket->read(room));
+    }
+}
+
+void HttpWorker::processRequests(QTcpSocket *socket)
+{
+    if (!connections.contains(socket) || connections[socket].processing) {
+        return;
+    }
+
+    connections[socket].processing = true;
+
+    // Pipelined requests are answered in order: the next one waits for the current response
+    while (connections.contains(socket) && connections[socket].context == nullptr
+           && socket->state() == QTcpSocket::ConnectedState) {
+        fillBuffer(socket);
+
+        Connection &connection = connections[socket];
+        HttpHeader::State state = connection.header.parse(connection.buffer);
+
+        if (state == HttpHeader::Error) {
+            sendError(socket, connection.header.getErrorStatus());
+            break;
+        } else if (state != HttpHeader::Complete) {
+            // The rest of the request may already wait in the socket
+            if (socket->bytesAvailable() > 0 && connection.buffer.size() < maxBufferSize) {
+                continue;
+            }
+
+            break;
+        }
+
+        connection.idleTimer->stop();
+        connection.requestCount++;
+        bool keepAlive = connection.header.isKeepAlive()
+                         && connection.requestCount < server->getMaxRequestsPerConnection();
+
+        RequestContext *context = new RequestContext(socket, connection.header, keepAlive, this);
+        connection.header = HttpHeader();
+        connection.context = context;
+        connect(context, &RequestContext::finished, this, &HttpWorker::requestFinished);
+
+        server->dispatch(context);
+    }
+
+    if (connections.contains(socket)) {
+        connections[socket].processing = false;
+    }
+}
+
+void HttpWorker::requestFinished()
+{
+    RequestContext *context = (RequestContext *) sender();
+    QTcpSocket *socket = context->getSocket();
+    context->deleteLater();
+
+    if (socket == nullptr || !connections.contains(socket) || connections[socket].context != context) {
+        return;
+    }
+
+    connections[socket].context = nullptr;
+
+    if (context->isKeepAlive()) {
+        connections[socket].idleTimer->start();
+        processRequests(socket);
+    } else {
+        socket->disconnectFromHost();
+    }
+}
+
+void HttpWorker::sendError(QTcpSocket *socket, const QByteArray &status)
+{
+    socket->write("HTTP/1.1 " + status + "\r\n"
+                  "Content-Length: 0\r\n"
+                  "Connection: close\r\n\r\n");
+    socket->disconnectFromHost();
+}
+
+void HttpWorker::discardClient()
+{
+    QTcpSocket *socket = (QTcpSocket *) sender();
+    connections.remove(socket);
+    socket->deleteLater();
+}
+
+void HttpWorker::sslErrors(const QList<QSslError> &errors)
+{
+    for (QSslError error : errors) {
+        qWarning() << "Ssl error: " << error.errorString();
+    }
+}
+
+void HttpWorker::peerVerifyError(const QSslError &error)
+{
+    qWarning() << "Ssl error: " << error.errorString();
+}
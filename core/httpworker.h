@@ -0,0 +1,53 @@
+#ifndef HTTPWORKER_H
+#define HTTPWORKER_H
+
+#include "httpheader.h"
+#include "requestcontext.h"
+
+#include <QHash>
+#include <QObject>
+#include <QSslError>
+#include <QTcpSocket>
+#include <QTimer>
+
+class HttpServer;
+
+class HttpWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    HttpWorker(HttpServer *server, QObject *parent = 0);
+
+public slots:
+    void addConnection(qintptr socketDescriptor);
+
+private slots:
+    void readClient();
+    void discardClient();
+    void requestFinished();
+    void sslErrors(const QList<QSslError> &errors);
+    void peerVerifyError(const QSslError &error);
+
+private:
+    struct Connection {
+        int requestCount;
+        QTimer *idleTimer;
+        QByteArray buffer;
+        HttpHeader header;
+        RequestContext *context;
+        bool processing;
+    };
+
+    void fillBuffer(QTcpSocket *socket);
+    void processRequests(QTcpSocket *socket);
+    void sendError(QTcpSocket *socket, const QByteArray &status);
+
+    // A complete request always fits: the header block and the largest body
+    static const int maxBufferSize = HttpHeader::maxHeaderSize + HttpHeader::maxBodySize;
+
+    HttpServer *server;
+    QHash<QTcpSocket *, Connection> connections;
+};
+
+#endif // HTTPWORKER_H
@@ -0,0 +1,221 @@
+#include "jsonstreamwriter.h"
+
+#include <QtNumeric>
+
+JsonStreamWriter::JsonStreamWriter(RequestContext *context, int chunkSize)
+{
+    this->context = context;
+    this->chunkSize = chunkSize;
+    this->afterName = false;
+    this->finished = false;
+    this->gzip = NULL;
+
+    QByteArray headers = "Content-Type: application/json; charset=\"utf-8\"\r\n"
+                         "Vary: Accept-Encoding\r\n";
+
+    if (Compression::accepts(context->getHeader()->getHeader("Accept-Encoding"), "gzip")) {
+        gzip = new GzipStream();
+        headers += "Content-Encoding: gzip\r\n";
+    }
+
+    buffer.reserve(chunkSize + 1024);
+    context->beginChunked("200 OK", headers);
+}
+
+JsonStreamWriter::~JsonStreamWriter()
+{
+    finish();
+    delete gzip;
+}
+
+void JsonStreamWriter::beginObject()
+{
+    separate();
+    buffer.append('{');
+    firstElements.append(true);
+}
+
+void JsonStreamWriter::endObject()
+{
+    buffer.append('}');
+    firstElements.removeLast();
+    flush();
+}
+
+void JsonStreamWriter::beginArray()
+{
+    separate();
+    buffer.append('[');
+    firstElements.append(true);
+}
+
+void JsonStreamWriter::endArray()
+{
+    buffer.append(']');
+    firstElements.removeLast();
+    flush();
+}
+
+void JsonStreamWriter::writeName(const QString &name)
+{
+    writeValue(name);
+    buffer.append(':');
+    afterName = true;
+}
+
+void JsonStreamWriter::writeValue(const QString &value)
+{
+    separate();
+    buffer.append('"');
+
+    for (int i = 0; i < value.size(); i++) {
+        ushort unicode = value.at(i).unicode();
+
+        if (unicode == '"' || unicode == '\\') {
+            buffer.append('\\');
+            buffer.append((char) unicode);
+        } else if (unicode == '\n') {
+            buffer.append("\\n");
+        } else if (unicode == '\r') {
+            buffer.append("\\r");
+        } else if (unicode == '\t') {
+            buffer.append("\\t");
+        } else if (unicode < 0x20) {
+            buffer.append("\\u00");
+            buffer.append("0123456789abcdef"[unicode >> 4]);
+            buffer.append("0123456789abcdef"[unicode & 0xf]);
+        } else if (unicode < 0x80) {
+            buffer.append((char) unicode);
+        } else if (value.at(i).isHighSurrogate() && i + 1 < value.size()) {
+            buffer.append(value.mid(i, 2).toUtf8());
+            i++;
+        } else {
+            buffer.append(value.mid(i, 1).toUtf8());
+        }
+    }
+
+    buffer.append('"');
+}
+
+void JsonStreamWriter::writeValue(const char *value)
+{
+    writeValue(QString::fromUtf8(value));
+}
+
+void JsonStreamWriter::writeValue(int value)
+{
+    separate();
+    buffer.append(QByteArray::number(value));
+}
+
+void JsonStreamWriter::writeValue(float value)
+{
+    separate();
+
+    // JSON has no nan nor infinity: a sensor error is sent as a missing value
+    if (!qIsFinite(value)) {
+        buffer.append("null");
+        return;
+    }
+
+    buffer.append(QByteArray::number(value, 'g', 7));
+}
+
+void JsonStreamWriter::writeValue(double value)
+{
+    separate();
+
+    if (!qIsFinite(value)) {
+        buffer.append("null");
+        return;
+    }
+
+    buffer.append(QByteArray::number(value, 'g', 15));
+}
+
+void JsonStreamWriter::writeValue(bool value)
+{
+    separate();
+    buffer.append(value ? "true" : "false");
+}
+
+void JsonStreamWriter::writeValue(const QDateTime &value)
+{
+    separate();
+    buffer.append('"');
+    buffer.append(formatDateTime(value));
+    buffer.append('"');
+}
+
+void JsonStreamWriter::finish()
+{
+    if (finished) {
+        return;
+    }
+
+    finished = true;
+
+    QByteArray data = buffer;
+    buffer.clear();
+
+    if (gzip != NULL) {
+        data = gzip->compress(data) + gzip->finish();
+    }
+
+    context->writeChunk(data);
+    context->endChunked();
+}
+
+QByteArray JsonStreamWriter::formatDateTime(const QDateTime &date)
+{
+    if (!date.isValid()) {
+        return QByteArray();
+    }
+
+    // Same output as toString("yyyy-MM-dd HH:mm:ss"), without parsing the format for each row
+    QDate d = date.date();
+    QTime t = date.time();
+    char result[20];
+    int values[6] = {d.year(), d.month(), d.day(), t.hour(), t.minute(), t.second()};
+    int widths[6] = {4, 2, 2, 2, 2, 2};
+    char separators[6] = {'-', '-', ' ', ':', ':', '\0'};
+    int position = 0;
+
+    for (int i = 0; i < 6; i++) {
+        for (int j = widths[i] - 1; j >= 0; j--) {
+            result[position + j] = '0' + values[i] % 10;
+            values[i] /= 10;
+        }
+
+        position += widths[i];
+        result[position++] = separators[i];
+    }
+
+    return QByteArray(result, 19);
+}
+
+void JsonStreamWriter::separate()
+{
+    if (afterName) {
+        afterName = false;
+        return;
+    }
+
+    if (!firstElements.isEmpty()) {
+        if (!firstElements.last()) {
+            buffer.append(',');
+        }
+
+        firstElements.last() = false;
+    }
+}
+
+void JsonStreamWriter::flush()
+{
+    if (buffer.size() < chunkSize) {
+        return;
+    }
+
+    context->writeChunk(gzip != NULL ? gzip->compress(buffer) : buffer);
+    buffer.clear();
+}
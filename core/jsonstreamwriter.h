@@ -0,0 +1,56 @@
+#ifndef JSONSTREAMWRITER_H
+#define JSONSTREAMWRITER_H
+
+#include "compression.h"
+#include "requestcontext.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+
+// Writes a JSON document to the client in chunks, without building it in memory
+class JsonStreamWriter
+{
+public:
+    JsonStreamWriter(RequestContext *context, int chunkSize = 16*1024);
+    ~JsonStreamWriter();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void writeName(const QString &name);
+    void writeValue(const QString &value);
+    void writeValue(const char *value);
+    void writeValue(int value);
+    void writeValue(float value);
+    void writeValue(double value);
+    void writeValue(bool value);
+    void writeValue(const QDateTime &value);
+
+    template <class T>
+    void write(const QString &name, const T &value)
+    {
+        writeName(name);
+        writeValue(value);
+    }
+
+    void finish();
+
+    static QByteArray formatDateTime(const QDateTime &date);
+
+protected:
+    void separate();
+    void flush();
+
+    RequestContext *context;
+    GzipStream *gzip;
+    QByteArray buffer;
+    QVector<bool> firstElements;
+    bool afterName;
+    bool finished;
+    int chunkSize;
+};
+
+#endif // JSONSTREAMWRITER_H
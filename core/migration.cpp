@@ -0,0 +1,340 @@
+#include "migration.h"
+#include "database.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QSqlError>
+#include <QSqlQuery>
+
+int Migration::version = 0;
+
+QList<Migration::Step> Migration::steps()
+{
+    QList<Step> result;
+
+    // Temperature::get: WHERE date >= ? AND date <= ? ORDER BY date
+    result.append(addIndex(1, "temperature", "temperature_date_id", QStringList() << "date" << "id"));
+
+    // HeaterIndicator::get: WHERE start_date >= ? AND start_date <= ? ORDER BY start_date
+    result.append(addIndex(2, "heater_indicator", "heater_indicator_start_date", QStringList() << "start_date"));
+
+    // HeaterEvent::getEvents: WHERE end_date >= ? AND start_date <= ? ORDER BY start_date
+    result.append(addIndex(3, "schedule_occurrence", "schedule_occurrence_start_date", QStringList() << "start_date" << "end_date"));
+
+    // Hourly and daily temperature aggregates, kept up to date by TemperatureRollup::save
+    Step rollups;
+    rollups.version = 4;
+    rollups.description = "temperature rollup tables";
+    foreach (const QString &table, QStringList() << "temperature_hourly" << "temperature_daily") {
+        rollups.statements << "CREATE TABLE IF NOT EXISTS " + table + " ("
+                              "id VARCHAR(20) NOT NULL, "
+                              "period DATETIME NOT NULL, "
+                              "temp_min FLOAT NOT NULL, "
+                              "temp_max FLOAT NOT NULL, "
+                              "temp_sum DOUBLE NOT NULL, "
+                              "sample_count INTEGER NOT NULL, "
+                              "PRIMARY KEY (period, id))";
+    }
+    result.append(rollups);
+
+    // One-time backfill of the rollups from the existing samples, month by month
+    Step backfill;
+    backfill.version = 5;
+    backfill.description = "temperature rollup backfill";
+    backfill.batches = rebuildRollups;
+    result.append(backfill);
+
+    // Temperature::save ignores a sample stored already: a batch replayed from the journal after
+    // a crash between the commit and its truncation. The duplicates written before are removed
+    // (one row kept per sensor and date) and the rollups which counted them are rebuilt.
+    Step uniqueSamples = addIndex(6, "temperature", "temperature_id_date", QStringList() << "id" << "date", true);
+    uniqueSamples.description = "temperature unique samples";
+    if (Database::isSqlite()) {
+        uniqueSamples.statements << "DELETE FROM temperature WHERE rowid NOT IN "
+                                    "(SELECT MIN(rowid) FROM temperature GROUP BY id, date)";
+    } else {
+        // No row id in the MySQL table: the duplicated samples are copied aside and written back once
+        uniqueSamples.statements << "CREATE TEMPORARY TABLE temperature_duplicate AS "
+                                    "SELECT id, date, MIN(temperature) AS temperature FROM temperature "
+                                    "GROUP BY id, date HAVING COUNT(*) > 1"
+                                 << "DELETE temperature FROM temperature JOIN temperature_duplicate "
+                                    "ON temperature.id = temperature_duplicate.id AND temperature.date = temperature_duplicate.date"
+                                 << "INSERT INTO temperature (id, date, temperature) "
+                                    "SELECT id, date, temperature FROM temperature_duplicate"
+                                 << "DROP TEMPORARY TABLE temperature_duplicate";
+    }
+    uniqueSamples.batches = rebuildRollups;
+    result.append(uniqueSamples);
+
+    // Time-weighted means: the area under the line of the samples and the time it covers.
+    // The periods rolled up before keep their mean by count (duration 0).
+    Step weights;
+    weights.version = 7;
+    weights.description = "temperature rollup time weights";
+    foreach (const QString &table, QStringList() << "temperature_hourly" << "temperature_daily") {
+        weights.statements << "ALTER TABLE " + table + " ADD COLUMN temp_area DOUBLE NOT NULL DEFAULT 0"
+                           << "ALTER TABLE " + table + " ADD COLUMN duration DOUBLE NOT NULL DEFAULT 0";
+    }
+    result.append(weights);
+
+    // Last sample of each sensor rolled up from the time series store, saved with the rollups
+    Step marks;
+    marks.version = 8;
+    marks.description = "temperature rollup marks";
+    marks.statements << "CREATE TABLE IF NOT EXISTS temperature_rollup_mark ("
+                        "id VARCHAR(20) NOT NULL PRIMARY KEY, "
+                        "last_time BIGINT NOT NULL)";
+    result.append(marks);
+
+    return result;
+}
+
+Migration::Step Migration::addIndex(int version, const QString &table, const QString &index, const QStringList &columns, bool unique)
+{
+    Step step;
+    step.version = version;
+    step.description = "index " + index;
+    step.table = table;
+    step.index = index;
+    step.columns = columns;
+    step.unique = unique;
+
+    return step;
+}
+
+bool Migration::rebuildRollups(QSqlDatabase db)
+{
+    QSqlQuery query(db);
+
+    // Samples are in local time, the time zone of the MySQL session. Hourly periods are UTC
+    // hours, daily periods the UTC time of the local midnight.
+    QString hour = "DATE_FORMAT(CONVERT_TZ(date, @@session.time_zone, '+00:00'), '%Y-%m-%d %H:00:00')";
+    QString day = "CONVERT_TZ(DATE(CONVERT_TZ(period, '+00:00', @@session.time_zone)), @@session.time_zone, '+00:00')";
+    if (Database::isSqlite()) {
+        hour = "strftime('%Y-%m-%dT%H:00:00.000Z', date, 'utc')";
+        day = "strftime('%Y-%m-%dT%H:%M:%S.000Z', datetime(period, 'localtime', 'start of day'), 'utc')";
+    }
+
+    if (!query.exec("DELETE FROM temperature_hourly") || !query.exec("DELETE FROM temperature_daily")) {
+        qCritical() << "Temperature rollups not cleared: " << query.lastError();
+        return false;
+    }
+
+    if (!query.exec("SELECT MIN(date), MAX(date) FROM temperature") || !query.next()) {
+        qCritical() << "Temperature range not readable: " << query.lastError();
+        return false;
+    }
+
+    if (query.isNull(0)) {
+        return true;
+    }
+
+    // One month per statement: a long history is not grouped at once, and the progress is logged.
+    // The hours are grouped by UTC month, then the days by local month from the hours.
+    QDateTime first = query.value(0).toDateTime();
+    QDateTime last = query.value(1).toDateTime();
+
+    QSqlQuery hourly(db);
+    hourly.prepare("INSERT INTO temperature_hourly (id, period, temp_min, temp_max, temp_sum, sample_count) "
+                   "SELECT id, " + hour + ", MIN(temperature), MAX(temperature), SUM(temperature), COUNT(*) "
+                   "FROM temperature WHERE date >= ? AND date < ? GROUP BY id, " + hour);
+
+    QSqlQuery daily(db);
+    daily.prepare("INSERT INTO temperature_daily (id, period, temp_min, temp_max, temp_sum, sample_count) "
+                  "SELECT id, " + day + ", MIN(temp_min), MAX(temp_max), SUM(temp_sum), SUM(sample_count) "
+                  "FROM temperature_hourly WHERE period >= ? AND period < ? GROUP BY id, " + day);
+
+    foreach (Qt::TimeSpec spec, QList<Qt::TimeSpec>() << Qt::UTC << Qt::LocalTime) {
+        QSqlQuery &insert = spec == Qt::UTC ? hourly : daily;
+        QString name = spec == Qt::UTC ? "hourly" : "daily";
+        QDate firstDate = first.toTimeSpec(spec).date();
+        QDate lastDate = last.toTimeSpec(spec).date();
+        QDateTime from(QDate(firstDate.year(), firstDate.month(), 1), QTime(0, 0), spec);
+        int months = (lastDate.year() - firstDate.year()) * 12 + lastDate.month() - firstDate.month() + 1;
+
+        for (int month = 1; month <= months; month++) {
+            QDateTime to = from.addMonths(1);
+
+            // The samples are compared in local time, the hourly periods in UTC
+            insert.addBindValue(spec == Qt::UTC ? from.toLocalTime() : from.toUTC());
+            insert.addBindValue(spec == Qt::UTC ? to.toLocalTime() : to.toUTC());
+
+            if (!insert.exec()) {
+                qCritical() << "Temperature rollups not rebuilt: " << name << from.toString("yyyy-MM") << insert.lastError();
+                return false;
+            }
+
+            qDebug() << "Temperature rollups rebuilt:" << name << from.toString("yyyy-MM") << month << "/" << months;
+            from = to;
+        }
+    }
+
+    return true;
+}
+
+bool Migration::run()
+{
+    Database::Lease lease;
+    QSqlDatabase db = lease.database();
+
+    if (!createVersionTable(db)) {
+        return false;
+    }
+
+    QSqlQuery query(db);
+    if (!query.exec("SELECT MAX(version) FROM schema_version")) {
+        qCritical() << "Schema version not readable: " << query.lastError();
+        return false;
+    }
+    version = query.next() ? query.value(0).toInt() : 0;
+
+    bool changed = false;
+
+    foreach (const Step &step, steps()) {
+        if (step.version <= version) {
+            // Applied already: only an index dropped by hand is rebuilt
+            if (!step.index.isEmpty() && !hasIndex(db, step.table, step.index)) {
+                qWarning() << "Schema index missing, rebuilt: " << step.index;
+                if (!createIndex(db, step)) {
+                    return false;
+                }
+                changed = true;
+            }
+            continue;
+        }
+
+        qDebug() << "Schema migration" << step.version << step.description;
+        if (!apply(db, step)) {
+            return false;
+        }
+
+        version = step.version;
+        changed = true;
+    }
+
+    // New indexes are only picked by the SQLite planner with fresh statistics
+    if (changed && Database::isSqlite()) {
+        query.exec("PRAGMA optimize");
+    }
+
+    return true;
+}
+
+int Migration::getVersion()
+{
+    return version;
+}
+
+bool Migration::createVersionTable(QSqlDatabase db)
+{
+    QSqlQuery query(db);
+    bool success = query.exec("CREATE TABLE IF NOT EXISTS schema_version ("
+                              "version INTEGER NOT NULL PRIMARY KEY, "
+                              "description VARCHAR(100) NOT NULL, "
+                              "applied_at DATETIME NOT NULL)");
+
+    if (!success) {
+        qCritical() << "Schema version table not created: " << query.lastError();
+    }
+
+    return success;
+}
+
+bool Migration::hasIndex(QSqlDatabase db, const QString &table, const QString &index)
+{
+    QSqlQuery query(db);
+
+    if (Database::isSqlite()) {
+        query.prepare("SELECT COUNT(*) FROM sqlite_master WHERE type='index' AND tbl_name=? AND name=?");
+    } else {
+        query.prepare("SELECT COUNT(*) FROM information_schema.statistics "
+                      "WHERE table_schema=DATABASE() AND table_name=? AND index_name=?");
+    }
+    query.addBindValue(table);
+    query.addBindValue(index);
+
+    return query.exec() && query.next() && query.value(0).toInt() > 0;
+}
+
+bool Migration::createIndex(QSqlDatabase db, const Step &step)
+{
+    QSqlQuery query(db);
+    QString columns = step.columns.join(", ");
+    QString type = step.unique ? "UNIQUE INDEX " : "INDEX ";
+
+    if (Database::isSqlite()) {
+        if (query.exec("CREATE " + type + "IF NOT EXISTS " + step.index + " ON " + step.table + " (" + columns + ")")) {
+            return true;
+        }
+    } else {
+        // Online DDL: the table stays readable and writable while the index is built
+        QString sql = "ALTER TABLE " + step.table + " ADD " + type + step.index + " (" + columns + ")";
+        if (query.exec(sql + ", ALGORITHM=INPLACE, LOCK=NONE")) {
+            return true;
+        }
+
+        // Servers older than MySQL 5.6 do not know the online syntax
+        qWarning() << "Online index creation not supported, table locked: " << step.table << query.lastError();
+        if (query.exec(sql)) {
+            return true;
+        }
+    }
+
+    qCritical() << "Schema index not created: " << step.index << query.lastError();
+    return false;
+}
+
+bool Migration::apply(QSqlDatabase db, const Step &step)
+{
+    QSqlQuery query(db);
+
+    // A step and its version are recorded together: a backfill stopped halfway is rolled back
+    // and run again on the next start (MySQL commits a DDL statement at once)
+    bool transaction = db.transaction();
+
+    foreach (const QString &statement, step.statements) {
+        if (!query.exec(statement)) {
+            qCritical() << "Schema migration failed: " << step.version << query.lastError() << statement;
+            if (transaction) {
+                db.rollback();
+            }
+            return false;
+        }
+    }
+
+    if (step.batches != nullptr && !step.batches(db)) {
+        qCritical() << "Schema migration failed: " << step.version;
+        if (transaction) {
+            db.rollback();
+        }
+        return false;
+    }
+
+    // After the statements, which may prepare the rows for it
+    if (!step.index.isEmpty() && !hasIndex(db, step.table, step.index) && !createIndex(db, step)) {
+        if (transaction) {
+            db.rollback();
+        }
+        return false;
+    }
+
+    query.prepare("INSERT INTO schema_version (version, description, applied_at) VALUES (?, ?, ?)");
+    query.addBindValue(step.version);
+    query.addBindValue(step.description);
+    query.addBindValue(QDateTime::currentDateTime());
+
+    if (!query.exec()) {
+        qCritical() << "Schema version not recorded: " << step.version << query.lastError();
+        if (transaction) {
+            db.rollback();
+        }
+        return false;
+    }
+
+    if (transaction && !db.commit()) {
+        qCritical() << "Schema migration not committed: " << step.version << db.lastError();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef MIGRATION_H
+#define MIGRATION_H
+
+#include <QList>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+/*
+ * Versioned schema changes, applied in order at startup. The applied versions
+ * are recorded in the schema_version table. An index step is checked again on
+ * every start and recreated if it went missing; on MySQL it is built online
+ * (in place, without locking the table) when the server supports it. The
+ * statements of a step run before its index, so a unique index can follow
+ * the removal of the duplicates it would reject. A backfill runs in batches,
+ * with its progress in the log.
+ */
+class Migration
+{
+public:
+    static bool run();
+    static int getVersion();
+
+protected:
+    struct Step {
+        int version;
+        QString description;
+        QString table;
+        QString index;
+        QStringList columns;
+        QStringList statements;
+        bool unique = false;
+
+        // Work too long for one statement, run after the statements in the same transaction
+        bool (*batches)(QSqlDatabase db) = nullptr;
+    };
+
+    static QList<Step> steps();
+    static Step addIndex(int version, const QString &table, const QString &index, const QStringList &columns, bool unique = false);
+
+    static bool createVersionTable(QSqlDatabase db);
+    static bool hasIndex(QSqlDatabase db, const QString &table, const QString &index);
+    static bool createIndex(QSqlDatabase db, const Step &step);
+    static bool apply(QSqlDatabase db, const Step &step);
+    static bool rebuildRollups(QSqlDatabase db);
+
+    static int version;
+};
+
+#endif // MIGRATION_H
@@ -0,0 +1,270 @@
+#include "requestcontext.h"
+
+#include <QDebug>
+#include <QThread>
+
+RequestContext::RequestContext(QTcpSocket *socket, const HttpHeader &header, bool keepAlive, QObject *parent)
+    : QObject(parent), socket(socket), header(header), query(header.getUrl())
+{
+    this->keepAlive = keepAlive;
+    this->async = false;
+    this->done = false;
+    this->streaming = false;
+    this->chunked = false;
+    this->written = false;
+    this->handlerRunning = true;
+    this->unsent = 0;
+    this->closed = false;
+    this->peerAddress = socket->peerAddress();
+    this->cookie = "";
+
+    connect(socket, &QTcpSocket::bytesWritten, this, &RequestContext::socketBytesWritten);
+    connect(socket, &QTcpSocket::disconnected, this, &RequestContext::socketClosed);
+    connect(socket, &QObject::destroyed, this, &RequestContext::socketClosed);
+
+    if (this->header.getHeader("Content-Type").startsWith("application/x-www-form-urlencoded")) {
+        query.addFormData(this->header.getBody());
+    }
+}
+
+QTcpSocket *RequestContext::getSocket() const
+{
+    return socket;
+}
+
+QHostAddress RequestContext::getPeerAddress() const
+{
+    return peerAddress;
+}
+
+HttpHeader *RequestContext::getHeader()
+{
+    return &header;
+}
+
+UrlQuery *RequestContext::getQuery()
+{
+    return &query;
+}
+
+QString &RequestContext::getCookie()
+{
+    return cookie;
+}
+
+bool RequestContext::isKeepAlive() const
+{
+    return keepAlive;
+}
+
+QString RequestContext::getParameter(const QString &name) const
+{
+    return parameters.value(name);
+}
+
+void RequestContext::setParameters(const QHash<QString, QString> &parameters)
+{
+    this->parameters = parameters;
+}
+
+void RequestContext::setAsync()
+{
+    async = true;
+}
+
+bool RequestContext::isAsync() const
+{
+    return async;
+}
+
+bool RequestContext::isFinished() const
+{
+    return done;
+}
+
+void RequestContext::sendResponse(const QByteArray &status, const QByteArray &headers, const QByteArray &body)
+{
+    if (done) {
+        qWarning() << "Response already sent for" << header.getUrl();
+        return;
+    }
+
+    done = true;
+
+    QByteArray response = buildHead(status, headers);
+
+    // Every response is framed with Content-Length so that the connection can be reused
+    if (!status.startsWith("304")) {
+        response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    }
+
+    response += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    response += "\r\n";
+    response += body;
+
+    write(response, true);
+}
+
+void RequestContext::beginChunked(const QByteArray &status, const QByteArray &headers)
+{
+    if (done) {
+        qWarning() << "Response already sent for" << header.getUrl();
+        return;
+    }
+
+    done = true;
+    streaming = true;
+
+    QByteArray response = buildHead(status, headers);
+
+    // HTTP/1.0 clients do not know chunks: the end of the body is the end of the connection
+    if (header.getVersion() == "HTTP/1.0") {
+        keepAlive = false;
+    } else {
+        chunked = true;
+        response += "Transfer-Encoding: chunked\r\n";
+    }
+
+    response += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    response += "\r\n";
+
+    write(response, false);
+}
+
+void RequestContext::writeChunk(const QByteArray &data)
+{
+    // An empty chunk would end the body
+    if (!streaming || data.isEmpty()) {
+        return;
+    }
+
+    waitForDrain();
+
+    drainMutex.lock();
+    bool aborted = closed;
+    drainMutex.unlock();
+
+    // The rest of the body of a client which left is dropped here
+    if (aborted) {
+        return;
+    }
+
+    if (chunked) {
+        write(QByteArray::number(data.size(), 16) + "\r\n" + data + "\r\n", false);
+    } else {
+        write(data, false);
+    }
+}
+
+void RequestContext::endChunked()
+{
+    if (!streaming) {
+        return;
+    }
+
+    streaming = false;
+    write(chunked ? "0\r\n\r\n" : "", true);
+}
+
+QByteArray RequestContext::buildHead(const QByteArray &status, const QByteArray &headers)
+{
+    QByteArray head = "HTTP/1.1 " + status + "\r\n";
+    head += headers;
+    head += cookie.toUtf8();
+
+    return head;
+}
+
+void RequestContext::write(const QByteArray &data, bool complete)
+{
+    drainMutex.lock();
+    unsent += data.size();
+    drainMutex.unlock();
+
+    // The socket belongs to the worker thread, the handler may run in another one
+    if (thread() == QThread::currentThread()) {
+        writeData(data, complete);
+    } else {
+        QMetaObject::invokeMethod(this, [this, data, complete]() {
+            writeData(data, complete);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void RequestContext::writeData(const QByteArray &data, bool complete)
+{
+    // The client may have left while an asynchronous handler was running
+    if (!socket.isNull() && !data.isEmpty()) {
+        socket->write(data);
+
+        // Hand the chunk to the kernel now, not when the handler returns to the event loop
+        socket->flush();
+    }
+
+    if (!complete) {
+        return;
+    }
+
+    written = true;
+
+    if (!handlerRunning) {
+        emit finished();
+    }
+}
+
+void RequestContext::waitForDrain()
+{
+    // Never blocks the worker: its event loop is what sends the bytes. Streamed routes are
+    // concurrent and run in the pool, the event stream skips frames for a slow client
+    if (thread() == QThread::currentThread()) {
+        return;
+    }
+
+    // The handler runs in another thread: the worker wakes it as the bytes are sent
+    QMutexLocker locker(&drainMutex);
+
+    while (unsent > highWaterMark && !closed) {
+        if (!drained.wait(&drainMutex, drainTimeout)) {
+            qWarning() << "Slow client, response aborted:" << header.getUrl();
+            closed = true;
+
+            QMetaObject::invokeMethod(this, [this]() {
+                if (!socket.isNull()) {
+                    socket->abort();
+                }
+            }, Qt::QueuedConnection);
+        }
+    }
+}
+
+void RequestContext::socketBytesWritten(qint64 bytes)
+{
+    QMutexLocker locker(&drainMutex);
+
+    // The bytes of a previous response on the same connection may be counted here
+    unsent = qMax<qint64>(0, unsent - bytes);
+    drained.wakeAll();
+}
+
+void RequestContext::socketClosed()
+{
+    QMutexLocker locker(&drainMutex);
+
+    closed = true;
+    unsent = 0;
+    drained.wakeAll();
+}
+
+void RequestContext::handlerReturned()
+{
+    handlerRunning = false;
+
+    // A handler which neither answered nor deferred its response
+    if (!done && !async) {
+        sendResponse("404 Not Found", "", "");
+    } else if (streaming && !async) {
+        endChunked();
+    } else if (written) {
+        emit finished();
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef REQUESTCONTEXT_H
+#define REQUESTCONTEXT_H
+
+#include "httpheader.h"
+#include "urlquery.h"
+
+#include <QHash>
+#include <QHostAddress>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTcpSocket>
+#include <QWaitCondition>
+
+class RequestContext : public QObject
+{
+    Q_OBJECT
+
+public:
+    RequestContext(QTcpSocket *socket, const HttpHeader &header, bool keepAlive, QObject *parent = 0);
+
+    QTcpSocket *getSocket() const;
+    QHostAddress getPeerAddress() const;
+    HttpHeader *getHeader();
+    UrlQuery *getQuery();
+    QString &getCookie();
+    bool isKeepAlive() const;
+    QString getParameter(const QString &name) const;
+    void setParameters(const QHash<QString, QString> &parameters);
+
+    void setAsync();
+    bool isAsync() const;
+    bool isFinished() const;
+
+    void sendResponse(const QByteArray &status, const QByteArray &headers, const QByteArray &body);
+    void beginChunked(const QByteArray &status, const QByteArray &headers);
+    void writeChunk(const QByteArray &data);
+    void endChunked();
+
+    // A chunked response written from another thread waits above this many unsent bytes,
+    // and is aborted when the client takes longer than the drain timeout to read them
+    static const int highWaterMark = 256 * 1024;
+    static const int drainTimeout = 30000;
+
+public slots:
+    void handlerReturned();
+
+private slots:
+    void socketBytesWritten(qint64 bytes);
+    void socketClosed();
+
+signals:
+    void finished();
+
+protected:
+    QByteArray buildHead(const QByteArray &status, const QByteArray &headers);
+    void write(const QByteArray &data, bool complete);
+    void writeData(const QByteArray &data, bool complete);
+    void waitForDrain();
+
+    QPointer<QTcpSocket> socket;
+    QHostAddress peerAddress;
+    HttpHeader header;
+    UrlQuery query;
+    QString cookie;
+    QHash<QString, QString> parameters;
+    bool keepAlive;
+    bool async;
+    bool done;
+    bool streaming;
+    bool chunked;
+    bool written;
+    bool handlerRunning;
+
+    // Bytes given to write() and not sent yet, shared with a handler in another thread
+    QMutex drainMutex;
+    QWaitCondition drained;
+    qint64 unsent;
+    bool closed;
+};
+
+#endif // REQUESTCONTEXT_H
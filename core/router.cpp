@@ -0,0 +1,131 @@
+#include "router.h"
+#include "tools.h"
+
+#include <QDebug>
+
+#include <algorithm>
+
+Router::Router()
+{
+    root = new Node();
+}
+
+Router::~Router()
+{
+    deleteNode(root);
+}
+
+void Router::deleteNode(Node *node)
+{
+    foreach (Node *child, node->children) {
+        deleteNode(child);
+    }
+
+    if (node->parameter != nullptr) {
+        deleteNode(node->parameter);
+    }
+
+    delete node;
+}
+
+void Router::addRoute(const QByteArray &method, const QString &path, Handler handler, bool concurrent)
+{
+    Node *node = root;
+
+    foreach (const QString &segment, path.split('/', SKIP_EMPTY_PARTS)) {
+        if (segment.startsWith(':')) {
+            if (node->parameter == nullptr) {
+                node->parameter = new Node();
+            } else if (node->parameterName != segment.mid(1)) {
+                qWarning() << "Route" << path << "renames the parameter" << node->parameterName;
+            }
+
+            node->parameterName = segment.mid(1);
+            node = node->parameter;
+        } else {
+            if (!node->children.contains(segment)) {
+                node->children.insert(segment, new Node());
+            }
+
+            node = node->children.value(segment);
+        }
+    }
+
+    Route route;
+    route.handler = handler;
+    route.concurrent = concurrent;
+    node->routes.insert(method.toUpper(), route);
+}
+
+const Router::Node *Router::find(const QStringList &segments, QHash<QString, QString> *parameters) const
+{
+    const Node *node = root;
+    const Node *deepest = nullptr;
+    QHash<QString, QString> values;
+
+    // The deepest node holding a route wins: handlers read the remaining segments themselves
+    foreach (const QString &segment, segments) {
+        if (node->children.contains(segment)) {
+            node = node->children.value(segment);
+        } else if (node->parameter != nullptr && !segment.isEmpty()) {
+            values.insert(node->parameterName, segment);
+            node = node->parameter;
+        } else {
+            break;
+        }
+
+        if (!node->routes.isEmpty()) {
+            deepest = node;
+
+            if (parameters != nullptr) {
+                *parameters = values;
+            }
+        }
+    }
+
+    return deepest;
+}
+
+Router::Match Router::match(const QByteArray &method,
+                            const QStringList &segments,
+                            const Route **route,
+                            QHash<QString, QString> *parameters) const
+{
+    const Node *node = find(segments, parameters);
+
+    if (node == nullptr) {
+        return NotFound;
+    }
+
+    QHash<QByteArray, Route>::const_iterator i = node->routes.constFind(method);
+
+    if (i == node->routes.constEnd()) {
+        i = node->routes.constFind("*");
+    }
+
+    if (i == node->routes.constEnd()) {
+        return MethodNotAllowed;
+    }
+
+    *route = &i.value();
+    return Found;
+}
+
+QByteArray Router::getAllowedMethods(const QStringList &segments) const
+{
+    const Node *node = find(segments, nullptr);
+
+    if (node == nullptr) {
+        return "";
+    }
+
+    QList<QByteArray> methods = node->routes.keys();
+    std::sort(methods.begin(), methods.end());
+
+    QByteArray result;
+    foreach (const QByteArray &method, methods) {
+        result += result.isEmpty() ? method : ", " + method;
+    }
+
+    return result;
+}
@@ -0,0 +1,52 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+class RequestContext;
+
+class Router
+{
+public:
+    typedef std::function<void(RequestContext *)> Handler;
+
+    struct Route {
+        Handler handler;
+        bool concurrent;
+    };
+
+    enum Match {Found, NotFound, MethodNotAllowed};
+
+    Router();
+    ~Router();
+
+    void addRoute(const QByteArray &method, const QString &path, Handler handler, bool concurrent = false);
+    Match match(const QByteArray &method,
+                const QStringList &segments,
+                const Route **route,
+                QHash<QString, QString> *parameters) const;
+    QByteArray getAllowedMethods(const QStringList &segments) const;
+
+private:
+    Q_DISABLE_COPY(Router)
+
+    // Routes are stored in a tree of path segments, ":name" segments match any value
+    struct Node {
+        QHash<QString, Node *> children;
+        Node *parameter = nullptr;
+        QString parameterName;
+        QHash<QByteArray, Route> routes;
+    };
+
+    const Node *find(const QStringList &segments, QHash<QString, QString> *parameters) const;
+    void deleteNode(Node *node);
+
+    Node *root;
+};
+
+#endif // ROUTER_H
@@ -1,4 +1,5 @@
 #include "tools.h"
+#include "database.h"
 #include <QSqlQuery>
 #include <QJsonObject>
 #include <QSqlRecord>
@@ -28,7 +29,8 @@ QString Tools::randomString(int stringLength)
 
 
 QJsonArray Tools::sqlQuery(QString sqlquery) {
-    QSqlQuery query;
+    Database::Lease lease;
+    QSqlQuery query = lease.query();
     //query.setForwardOnly(true);
     if (!query.exec(sqlquery)) {
         qDebug() << "Error: " << query.lastError();
@@ -4,6 +4,13 @@
 #include <QString>
 #include <QJsonArray>
 
+// QString::SkipEmptyParts is deprecated from Qt 5.14, Qt::SkipEmptyParts only exists since
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+#define SKIP_EMPTY_PARTS Qt::SkipEmptyParts
+#else
+#define SKIP_EMPTY_PARTS QString::SkipEmptyParts
+#endif
+
 class Tools
 {
 public:
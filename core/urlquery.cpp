@@ -1,26 +1,74 @@
 #include "urlquery.h"
-#include <QUrl>
+
+#include <algorithm>
+
+UrlQuery::UrlQuery()
+{
+
+}
 
 UrlQuery::UrlQuery(QString url)
 {
-    url.remove(QRegExp("^/+")); //remove double slash for apache proxy
-    query = url.split("/");
-
-    if (query.last().contains("?")) {
-        QString text = query.last();
-        text.remove(QRegExp("^.*\\?"));
-        QStringList list = text.split("&");
-
-        foreach(QString element, list) {
-            QStringList a = element.split("=");
-            if (a.length() > 1) {
-                this->item.insert(normalize(a.at(0)), normalize(a.at(1)));
+    QByteArray data = url.toUtf8();
+    int start = 0;
+
+    //remove double slash for apache proxy
+    while (start < data.size() && data.at(start) == '/') {
+        start++;
+    }
+
+    int mark = data.indexOf('?', start);
+    int end = mark == -1 ? data.size() : mark;
+
+    // Path segments are decoded one by one, an encoded slash stays in its segment
+    while (true) {
+        int slash = data.indexOf('/', start);
+
+        if (slash == -1 || slash > end) {
+            query.append(decode(data.constData() + start, end - start, false));
+            break;
+        }
+
+        query.append(decode(data.constData() + start, slash - start, false));
+        start = slash + 1;
+    }
+
+    if (mark != -1) {
+        parseItems(data.constData() + mark + 1, data.size() - mark - 1);
+    }
+}
+
+void UrlQuery::addFormData(const QByteArray &data)
+{
+    parseItems(data.constData(), data.size());
+}
+
+void UrlQuery::parseItems(const char *data, int size)
+{
+    int start = 0;
+
+    while (start <= size) {
+        int end = start;
+        int equal = -1;
+
+        while (end < size && data[end] != '&') {
+            if (equal == -1 && data[end] == '=') {
+                equal = end;
+            }
+            end++;
+        }
+
+        // Only the first "=" separates the key, the value may contain others
+        if (end > start) {
+            if (equal != -1) {
+                item.insertMulti(decode(data + start, equal - start, true),
+                                 decode(data + equal + 1, end - equal - 1, true));
             } else {
-                this->item.insert(normalize(a.at(0)), "");
+                item.insertMulti(decode(data + start, end - start, true), "");
             }
         }
 
-        query.last().remove(QRegExp("\\?.*$"));
+        start = end + 1;
     }
 }
 
@@ -40,38 +88,60 @@ QStringList UrlQuery::getAllQuery()
 
 QString UrlQuery::getItem(QString key)
 {
-    if (item.contains(key)) {
-        return item[key];
-    } else {
-        return "";
-    }
+    // The last occurrence of a repeated key wins
+    return item.value(key, "");
 }
 
-QString UrlQuery::normalize(const QString &text)
+QStringList UrlQuery::getItems(QString key)
 {
-    QString input = "http://www.test.com/" + text;
-    input.replace("+", " ");
-    QByteArray latin = input.toLatin1();
-    QByteArray utf8 = input.toUtf8();
-    QString result;
-    if (latin != utf8) {
-       // URL string containing unicode characters (no percent encoding expected)
-       result = QUrl::fromUserInput(input).toDisplayString().remove("http://www.test.com/");
-    } else {
-       // URL string containing ASCII characters only (assume possible %-encoding)
-       result = QUrl::fromUserInput(QUrl::fromPercentEncoding(input.toLatin1())).toDisplayString().remove("http://www.test.com/");
+    QStringList values = item.values(key);
+    std::reverse(values.begin(), values.end());
+
+    return values;
+}
+
+QString UrlQuery::decode(const char *data, int size, bool form)
+{
+    QByteArray result;
+    result.reserve(size);
+
+    for (int i = 0; i < size; i++) {
+        char c = data[i];
+
+        // An encoded slash is kept in path segments, it is not a separator
+        if (c == '%' && i + 2 < size) {
+            int high = hexValue(data[i + 1]);
+            int low = hexValue(data[i + 2]);
+
+            if (high != -1 && low != -1 && (form || high != 2 || low != 0xf)) {
+                c = (char) (high * 16 + low);
+                i += 2;
+            }
+        } else if (c == '+' && form) {
+            c = ' ';
+        }
+
+        // Form values are stored with Unix line endings
+        if (c == '\n' && form && result.endsWith('\r')) {
+            result[result.size() - 1] = '\n';
+            continue;
+        }
+
+        result.append(c);
     }
 
-    result.replace("%22", "\"");
-    result.replace("%7B", "{");
-    result.replace("%7D", "}");
-    result.replace("%3C", "<");
-    result.replace("%3E", ">");
-    result.replace("%5C", "\\");
-    result.replace("%7C", "|");
-    result.replace("%0D%0A", "\n");
-    result.replace("%0A", "\n");
-
-    return result;
+    return QString::fromUtf8(result);
 }
 
+int UrlQuery::hexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
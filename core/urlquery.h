@@ -14,9 +14,13 @@ public:
     QString getQuery(int element);
     QStringList getAllQuery();
     QString getItem(QString key);
+    QStringList getItems(QString key);
+    void addFormData(const QByteArray &data);
 
 private:
-    QString normalize(const QString &text);
+    void parseItems(const char *data, int size);
+    static QString decode(const char *data, int size, bool form);
+    static int hexValue(char c);
 
     QStringList query;
     QHash<QString, QString> item;
@@ -0,0 +1,102 @@
+#include "viewtemplate.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+QHash<QString, QSharedPointer<const ViewTemplate> > ViewTemplate::views;
+QMutex ViewTemplate::mutex;
+#ifdef QT_DEBUG
+bool ViewTemplate::developmentMode = true;
+#else
+bool ViewTemplate::developmentMode = false;
+#endif
+
+ViewTemplate::ViewTemplate(const QByteArray &source, const QDateTime &lastModified)
+{
+    this->source = source;
+    this->lastModified = lastModified;
+
+    int position = 0;
+    int start;
+
+    while ((start = source.indexOf("<!-- {", position)) != -1) {
+        int end = source.indexOf("} -->", start);
+
+        if (end == -1) {
+            break;
+        }
+
+        Segment literal = {false, source.mid(position, start - position), ""};
+        segments.append(literal);
+
+        position = end + 5;
+        Segment slot = {true, source.mid(start, position - start), QString::fromUtf8(source.mid(start + 6, end - start - 6))};
+        segments.append(slot);
+    }
+
+    Segment literal = {false, source.mid(position), ""};
+    segments.append(literal);
+}
+
+QByteArray ViewTemplate::render(const QHash<QString, QByteArray> *data) const
+{
+    if (data == NULL) {
+        return source;
+    }
+
+    // The page is built in a single buffer of the final size
+    int size = 0;
+    foreach (const Segment &segment, segments) {
+        size += segment.slot && data->contains(segment.key) ? data->value(segment.key).size() : segment.text.size();
+    }
+
+    QByteArray block;
+    block.reserve(size);
+
+    foreach (const Segment &segment, segments) {
+        // Unknown slots are left in the page, as placeholders are HTML comments
+        if (segment.slot && data->contains(segment.key)) {
+            block.append(data->value(segment.key));
+        } else {
+            block.append(segment.text);
+        }
+    }
+
+    return block;
+}
+
+QSharedPointer<const ViewTemplate> ViewTemplate::get(const QString &view)
+{
+    QString fileName = QDir::currentPath() + "/" + view;
+
+    mutex.lock();
+    QSharedPointer<const ViewTemplate> cached = views.value(view);
+    mutex.unlock();
+
+    // Views are only reloaded on change while developing them
+    if (!cached.isNull() && (!developmentMode || cached->lastModified == QFileInfo(fileName).lastModified())) {
+        return cached;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << view << "not found.";
+        return QSharedPointer<const ViewTemplate>();
+    }
+
+    QSharedPointer<const ViewTemplate> viewTemplate(new ViewTemplate(file.readAll(), QFileInfo(file).lastModified()));
+    file.close();
+
+    QMutexLocker locker(&mutex);
+    views.insert(view, viewTemplate);
+
+    return viewTemplate;
+}
+
+void ViewTemplate::setDevelopmentMode(bool enable)
+{
+    developmentMode = enable;
+}
@@ -0,0 +1,39 @@
+#ifndef VIEWTEMPLATE_H
+#define VIEWTEMPLATE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+
+class ViewTemplate
+{
+public:
+    QByteArray render(const QHash<QString, QByteArray> *data = NULL) const;
+
+    static QSharedPointer<const ViewTemplate> get(const QString &view);
+    static void setDevelopmentMode(bool enable);
+
+protected:
+    // A view is split once into literal text and "<!-- {key} -->" slots
+    struct Segment {
+        bool slot;
+        QByteArray text;
+        QString key;
+    };
+
+    ViewTemplate(const QByteArray &source, const QDateTime &lastModified);
+
+    QByteArray source;
+    QList<Segment> segments;
+    QDateTime lastModified;
+
+    static QHash<QString, QSharedPointer<const ViewTemplate> > views;
+    static QMutex mutex;
+    static bool developmentMode;
+};
+
+#endif // VIEWTEMPLATE_H
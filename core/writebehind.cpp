@@ -0,0 +1,216 @@
+#include "writebehind.h"
+#include "database.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSqlQuery>
+
+WriteBehind *WriteBehind::instance = nullptr;
+QThread *WriteBehind::thread = nullptr;
+QMutex WriteBehind::mutex;
+QMutex WriteBehind::writeMutex;
+QHash<WriteBehind::Key, WriteBehind::Write> WriteBehind::pending;
+QList<WriteBehind::Key> WriteBehind::order;
+bool WriteBehind::flushRequested = false;
+int WriteBehind::maxPending = 256;
+qint64 WriteBehind::queued = 0;
+qint64 WriteBehind::coalesced = 0;
+qint64 WriteBehind::written = 0;
+qint64 WriteBehind::failed = 0;
+qint64 WriteBehind::transactions = 0;
+
+WriteBehind::WriteBehind(int interval)
+{
+    timer = new QTimer(this);
+    timer->setInterval(interval);
+    connect(timer, &QTimer::timeout, this, &WriteBehind::flush);
+}
+
+void WriteBehind::start(int interval)
+{
+    if (instance != nullptr) {
+        return;
+    }
+
+    thread = new QThread();
+    instance = new WriteBehind(interval);
+    instance->moveToThread(thread);
+    thread->start();
+
+    QMetaObject::invokeMethod(instance->timer, "start", Qt::QueuedConnection);
+}
+
+void WriteBehind::stop()
+{
+    if (instance == nullptr) {
+        return;
+    }
+
+    // Last flush before the database goes away
+    QMetaObject::invokeMethod(instance, "flush", Qt::BlockingQueuedConnection);
+
+    thread->quit();
+    thread->wait();
+
+    delete instance;
+    delete thread;
+    instance = nullptr;
+    thread = nullptr;
+}
+
+void WriteBehind::enqueue(const QString &key, const QString &sql, const QList<QVariant> &values)
+{
+    Write write;
+    write.sql = sql;
+    write.values = values;
+
+    mutex.lock();
+
+    if (instance == nullptr) {
+        mutex.unlock();
+        execute(QList<Write>() << write);
+        return;
+    }
+
+    queued++;
+
+    // Only the same statement is coalesced: an insert and a later update of a row both run, in order
+    Key pendingKey(key, sql);
+
+    if (pending.contains(pendingKey)) {
+        pending[pendingKey].values = values;
+        coalesced++;
+    } else {
+        pending.insert(pendingKey, write);
+        order.append(pendingKey);
+    }
+
+    bool flushNow = pending.size() >= maxPending && !flushRequested;
+    if (flushNow) {
+        flushRequested = true;
+    }
+
+    mutex.unlock();
+
+    if (flushNow) {
+        QMetaObject::invokeMethod(instance, "flush", Qt::QueuedConnection);
+    }
+}
+
+bool WriteBehind::writeNow(const QString &key, const QString &sql, const QList<QVariant> &values)
+{
+    Write write;
+    write.sql = sql;
+    write.values = values;
+
+    // Serialized with the batches: a pending write of the row never lands after this one
+    QMutexLocker writeLocker(&writeMutex);
+
+    mutex.lock();
+    QList<Write> writes = take(key);
+    mutex.unlock();
+
+    if (!writes.isEmpty()) {
+        execute(writes);
+    }
+
+    return execute(QList<Write>() << write);
+}
+
+void WriteBehind::cancel(const QString &key)
+{
+    QMutexLocker locker(&mutex);
+    take(key);
+}
+
+QList<WriteBehind::Write> WriteBehind::take(const QString &key)
+{
+    QList<Write> writes;
+
+    for (int i = 0; i < order.size(); ) {
+        if (order.at(i).first == key) {
+            writes.append(pending.take(order.takeAt(i)));
+        } else {
+            i++;
+        }
+    }
+
+    return writes;
+}
+
+void WriteBehind::flush()
+{
+    QList<Write> writes;
+
+    // Held until the batch is committed: see writeNow
+    QMutexLocker writeLocker(&writeMutex);
+
+    mutex.lock();
+    foreach (const Key &key, order) {
+        writes.append(pending.value(key));
+    }
+    pending.clear();
+    order.clear();
+    flushRequested = false;
+    mutex.unlock();
+
+    if (!writes.isEmpty()) {
+        execute(writes);
+    }
+}
+
+bool WriteBehind::execute(const QList<Write> &writes)
+{
+    Database::Lease lease;
+    QSqlDatabase db = lease.database();
+    int errors = 0;
+
+    // One transaction for the whole batch: a single round-trip to commit
+    bool transaction = db.transaction();
+
+    foreach (const Write &write, writes) {
+        QSqlQuery query = lease.prepare(write.sql);
+
+        foreach (const QVariant &value, write.values) {
+            query.addBindValue(value);
+        }
+
+        if (!Database::exec(query)) {
+            errors++;
+        }
+    }
+
+    if (transaction && !db.commit()) {
+        qCritical() << "Write-behind commit failed, " << writes.size() << " writes lost";
+        errors = writes.size();
+    }
+
+    QMutexLocker locker(&mutex);
+    written += writes.size() - errors;
+    failed += errors;
+    transactions++;
+
+    return errors == 0;
+}
+
+QJsonObject WriteBehind::getStatistics()
+{
+    QMutexLocker locker(&mutex);
+    QJsonObject result;
+
+    result.insert("running", instance != nullptr);
+    result.insert("pending", pending.size());
+    result.insert("queued", (double) queued);
+    result.insert("coalesced", (double) coalesced);
+    result.insert("written", (double) written);
+    result.insert("failed", (double) failed);
+    result.insert("transactions", (double) transactions);
+
+    return result;
+}
+
+void WriteBehind::setMaxPending(int value)
+{
+    QMutexLocker locker(&mutex);
+    maxPending = value;
+}
@@ -0,0 +1,75 @@
+#ifndef WRITEBEHIND_H
+#define WRITEBEHIND_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <QVariant>
+
+/*
+ * Write-behind queue for frequent updates (switch status, battery level,
+ * settings). Writes are keyed by row and statement: a newer write of the
+ * same statement on a pending row replaces it, different statements of a
+ * row are kept in order. A database thread commits the pending writes in
+ * one transaction every flush interval, as soon as maxPending rows are
+ * waiting, and a last time on stop(). Without start(), writes are executed
+ * at once. writeNow() executes a write in the calling thread, after the
+ * pending writes of its row.
+ */
+class WriteBehind : public QObject
+{
+    Q_OBJECT
+
+public:
+    static void start(int interval = 1000);
+    static void stop();
+
+    static void enqueue(const QString &key, const QString &sql, const QList<QVariant> &values);
+    static bool writeNow(const QString &key, const QString &sql, const QList<QVariant> &values);
+    static void cancel(const QString &key);
+
+    static QJsonObject getStatistics();
+    static void setMaxPending(int value);
+
+public slots:
+    void flush();
+
+protected:
+    struct Write {
+        QString sql;
+        QList<QVariant> values;
+    };
+
+    // Row key and statement
+    typedef QPair<QString, QString> Key;
+
+    explicit WriteBehind(int interval);
+
+    static bool execute(const QList<Write> &writes);
+    static QList<Write> take(const QString &key);
+
+    QTimer *timer;
+
+    static WriteBehind *instance;
+    static QThread *thread;
+    static QMutex mutex;
+    static QMutex writeMutex;
+    static QHash<Key, Write> pending;
+    static QList<Key> order;
+    static bool flushRequested;
+    static int maxPending;
+
+    static qint64 queued;
+    static qint64 coalesced;
+    static qint64 written;
+    static qint64 failed;
+    static qint64 transactions;
+};
+
+#endif // WRITEBEHIND_H
@@ -8,6 +8,8 @@ CONFIG += debug_and_release
 
 QT       += network sql serialport qml websockets
 
+LIBS += -lz
+
 TARGET = doxeo-monitor
 TEMPLATE = app
 
@@ -35,6 +37,7 @@ SOURCES += main.cpp\
     models/heaterevent.cpp \
     controllers/thermostatcontroller.cpp \
     models/temperature.cpp \
+    models/temperaturerollup.cpp \
     libraries/temperaturelogger.cpp \
     models/heaterindicator.cpp \
     libraries/device.cpp \
@@ -61,7 +64,24 @@ SOURCES += main.cpp\
     models/session.cpp \
     controllers/cameracontroller.cpp \
     models/camera.cpp \
-    libraries/websocketevent.cpp
+    libraries/websocketevent.cpp \
+    libraries/modelfeed.cpp \
+    libraries/eventstream.cpp \
+    libraries/dashboard.cpp \
+    core/requestcontext.cpp \
+    core/httpworker.cpp \
+    core/router.cpp \
+    core/assetcache.cpp \
+    core/compression.cpp \
+    core/viewtemplate.cpp \
+    core/jsonstreamwriter.cpp \
+    core/writebehind.cpp \
+    core/migration.cpp \
+    libraries/timeseriescodec.cpp \
+    libraries/timeseriesstore.cpp \
+    libraries/samplebuffer.cpp \
+    libraries/samplejournal.cpp \
+    libraries/samplefilter.cpp
 
 HEADERS  += \
     controllers/mysensorscontroller.h \
@@ -87,6 +107,7 @@ HEADERS  += \
     models/heaterevent.h \
     controllers/thermostatcontroller.h \
     models/temperature.h \
+    models/temperaturerollup.h \
     libraries/temperaturelogger.h \
     models/heaterindicator.h \
     libraries/device.h \
@@ -113,6 +134,23 @@ HEADERS  += \
     models/session.h \
     models/camera.h \
     controllers/cameracontroller.h \
-    libraries/websocketevent.h
+    libraries/websocketevent.h \
+    libraries/modelfeed.h \
+    libraries/eventstream.h \
+    libraries/dashboard.h \
+    core/requestcontext.h \
+    core/httpworker.h \
+    core/router.h \
+    core/assetcache.h \
+    core/compression.h \
+    core/viewtemplate.h \
+    core/jsonstreamwriter.h \
+    core/writebehind.h \
+    core/migration.h \
+    libraries/timeseriescodec.h \
+    libraries/timeseriesstore.h \
+    libraries/samplebuffer.h \
+    libraries/samplejournal.h \
+    libraries/samplefilter.h
 
 RESOURCES +=
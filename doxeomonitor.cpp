@@ -13,23 +13,32 @@
 #include "controllers/settingcontroller.h"
 #include "controllers/switchcontroller.h"
 #include "controllers/thermostatcontroller.h"
+#include "core/assetcache.h"
+#include "core/compression.h"
 #include "core/database.h"
+#include "core/migration.h"
+#include "core/viewtemplate.h"
+#include "core/writebehind.h"
 #include "libraries/authentification.h"
 #include "libraries/device.h"
+#include "libraries/eventstream.h"
 #include "libraries/firebasecloudmessaging.h"
 #include "libraries/gsm.h"
 #include "libraries/jeedom.h"
 #include "libraries/messagelogger.h"
+#include "libraries/modelfeed.h"
 #include "libraries/mysensors.h"
 #include "libraries/scriptengine.h"
 #include "libraries/scripthelper.h"
 #include "libraries/settings.h"
 #include "libraries/thermostat.h"
+#include "libraries/timeseriesstore.h"
 #include "libraries/websocketevent.h"
 #include "models/heater.h"
 #include "models/session.h"
 #include "models/setting.h"
 #include "models/switch.h"
+#include "models/temperature.h"
 #include "models/user.h"
 
 #include <iostream>
@@ -101,11 +110,30 @@ int DoxeoMonitor::start()
         qWarning() << "Websocket not started";
     }
 
-    // Connection to Mysql Database
-    Database::initialize("QMYSQL");
+    // Push model deltas to websocket and /events clients
+    ModelFeed *modelFeed = new ModelFeed(this);
+    connect(modelFeed,
+            SIGNAL(delta(QString, QJsonObject)),
+            webSocketEvent,
+            SLOT(publish(QString, QJsonObject)));
+    connect(modelFeed,
+            SIGNAL(delta(QString, QJsonObject)),
+            &EventStream::stream(),
+            SLOT(publish(QString, QJsonObject)));
+
+    // Connection to the database: Mysql server or embedded SQLite file
+    Database::initialize(settings.value("database/driver", "QMYSQL").toString());
     if (!Database::open())
     {
-        qCritical() << applicationName() + " Mysql connection failed";
+        qCritical() << applicationName() + " database connection failed";
+    }
+    else if (!Database::bootstrap(QDir::currentPath() + "/sql/doxeo.sqlite.sql"))
+    {
+        qCritical() << applicationName() + " database schema not created";
+    }
+    else if (!Migration::run())
+    {
+        qCritical() << applicationName() + " database schema not up to date";
     }
 
     // Initialize logger messages
@@ -121,6 +149,31 @@ int DoxeoMonitor::start()
     Setting::update();
     Settings mySettings("general");
 
+    // Frequent updates are written by a database thread, at most this many ms later
+    WriteBehind::start(mySettings.value("db_flush_interval", "1000").toInt());
+
+    // Temperature samples in the compressed time series store instead of the temperature table
+    if (mySettings.value("temperature_storage", "database") == "timeseries")
+    {
+        Temperature::setTimeSeries(TimeSeriesStore::store().open(QDir::currentPath() + "/data/timeseries"));
+    }
+
+    // Compression of the responses and size of the asset cache (in MB)
+    Compression::setLevel(mySettings.value("http_compression_level", "6").toInt());
+    Compression::setThreshold(mySettings.value("http_compression_threshold", "1024").toInt());
+    AssetCache::cache().setMaxSize(mySettings.value("asset_cache_size", "32").toInt()*1024*1024);
+
+    // Views are reloaded when modified in development mode, the default of debug builds
+    if (mySettings.contains("http_dev_mode"))
+    {
+        ViewTemplate::setDevelopmentMode(mySettings.value("http_dev_mode") == "true");
+    }
+
+    // Handle http connections in worker threads, configured before they are started
+    int httpWorkers = mySettings.value("http_workers", "2").toInt();
+    httpServer->setWorkerCount(httpWorkers);
+    httpsServer->setWorkerCount(httpWorkers);
+
     // Initialize Firebase Cloud Messaging
     //FirebaseCloudMessaging *fcm = new FirebaseCloudMessaging(mySettings.value("fcm_projectname", "doxeo"), this);
     //fcm->setServerKey(mySettings.value("fcm_serverkey", ""));
@@ -193,6 +246,9 @@ void DoxeoMonitor::closeApplication()
     {
         ctrl->stop();
     }
+
+    // Write what is still pending before leaving
+    WriteBehind::stop();
 }
 
 QString DoxeoMonitor::commandLine(QString title)
@@ -231,6 +287,13 @@ void DoxeoMonitor::configure()
         settings.setValue("application/path", userInput);
     }
 
+    oldValue = settings.value("database/driver", "QMYSQL").toString();
+    userInput = commandLine("Enter database driver, QMYSQL or QSQLITE (" + oldValue + "):");
+    if (userInput != "")
+    {
+        settings.setValue("database/driver", userInput);
+    }
+
     oldValue = settings.value("database/hostname", "").toString();
     userInput = commandLine("Enter database host name (" + oldValue + "):");
     if (userInput != "")
@@ -253,7 +316,7 @@ void DoxeoMonitor::configure()
     }
 
     oldValue = settings.value("database/databasename", "").toString();
-    userInput = commandLine("Enter database name (" + oldValue + "):");
+    userInput = commandLine("Enter database name, or file with QSQLITE (" + oldValue + "):");
     if (userInput != "")
     {
         settings.setValue("database/databasename", userInput);
@@ -267,11 +330,12 @@ void DoxeoMonitor::createUser()
     QString password;
     User newUser = User();
 
-    // Connection to Mysql Database
-    Database::initialize("QMYSQL");
-    if (!Database::open())
+    // Connection to the database: Mysql server or embedded SQLite file
+    QSettings settings(QSettings::SystemScope, QCoreApplication::organizationName());
+    Database::initialize(settings.value("database/driver", "QMYSQL").toString());
+    if (!Database::open() || !Database::bootstrap(QDir::currentPath() + "/sql/doxeo.sqlite.sql"))
     {
-        cout << "Mysql connection failed!";
+        cout << "Database connection failed!";
         return;
     }
 
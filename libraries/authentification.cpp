@@ -6,7 +6,7 @@
 #include <QList>
 #include <QDebug>
 
-Authentification::Authentification()
+Authentification::Authentification() : mutex(QMutex::Recursive)
 {
     foreach (Session *session, Session::getAll()) {
          Authentification::Remember remember;
@@ -117,6 +117,9 @@ bool Authentification::isConnected(QList<QNetworkCookie> cookies)
 
 bool Authentification::isIdValid(QString id, QString login, QString code)
 {
+    // Requests are checked from the http worker threads
+    QMutexLocker locker(&mutex);
+
     if (id == "") {
         return false;
     }
@@ -153,6 +156,8 @@ User &Authentification::getConnectedUser(HttpHeader *header, QString &cookie)
 
 void Authentification::removeUserAutoconnect(QString login)
 {
+    QMutexLocker locker(&mutex);
+
     QHashIterator<QString, Authentification::Remember> i(rememberList);
     while (i.hasNext()) {
         i.next();
@@ -178,6 +183,9 @@ void Authentification::clearCookies(QString &cookie)
 
 void Authentification::insertRememberCode(QString id, Remember remember)
 {
+    // The session list is also changed by the http worker threads, in removeRememberCode
+    QMutexLocker locker(&mutex);
+
     Session *session = new Session(id);
     session->setUser(remember.login);
     session->setPassword(remember.code);
@@ -188,6 +196,8 @@ void Authentification::insertRememberCode(QString id, Remember remember)
 
 void Authentification::removeRememberCode(QString id)
 {
+    QMutexLocker locker(&mutex);
+
     Session *session = Session::get(id);
     if (session != NULL) {
         session->remove();
@@ -4,6 +4,7 @@
 #include <core/httpheader.h>
 #include <models/user.h>
 #include <QHash>
+#include <QMutex>
 #include <QString>
 #include <QNetworkCookie>
 
@@ -33,6 +34,7 @@ protected:
     bool isIdValid(QString id, QString login, QString code);
 
     QHash<QString,Remember> rememberList;
+    QMutex mutex;
 };
 
 #endif // AUTHENTIFICATION_H
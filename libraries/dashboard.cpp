@@ -0,0 +1,90 @@
+#include "dashboard.h"
+
+#include <QDateTime>
+#include <QMutexLocker>
+
+Dashboard::Dashboard()
+{
+    // versions of a previous run are older than any version of this one
+    firstVersion = QDateTime::currentMSecsSinceEpoch();
+    version = firstVersion;
+}
+
+Dashboard& Dashboard::dashboard()
+{
+    static Dashboard instance;
+    return instance;
+}
+
+void Dashboard::addSection(const QString &name, Stamp stamp, Builder build)
+{
+    QMutexLocker locker(&mutex);
+
+    Section section;
+    section.stamp = stamp;
+    section.build = build;
+    section.version = version;
+    section.built = false;
+
+    sections.insert(name, section);
+}
+
+qint64 Dashboard::refresh()
+{
+    QMutexLocker locker(&mutex);
+    return refreshSections();
+}
+
+QJsonObject Dashboard::getSnapshot(qint64 since)
+{
+    QMutexLocker locker(&mutex);
+    QJsonObject result;
+    QJsonObject changes;
+
+    refreshSections();
+
+    // unknown versions get everything
+    bool full = since < firstVersion || since > version;
+
+    QMap<QString, Section>::const_iterator it;
+    for (it = sections.constBegin(); it != sections.constEnd(); ++it) {
+        if (full || it.value().version > since) {
+            changes.insert(it.key(), it.value().value);
+        }
+    }
+
+    result.insert("success", true);
+    result.insert("version", QString::number(version));
+    result.insert("full", full);
+    result.insert("sections", changes);
+
+    return result;
+}
+
+qint64 Dashboard::refreshSections()
+{
+    bool changed = false;
+
+    QMap<QString, Section>::iterator it;
+    for (it = sections.begin(); it != sections.end(); ++it) {
+        Section &section = it.value();
+        QByteArray stamp = section.stamp();
+
+        if (section.built && stamp == section.lastStamp) {
+            continue;
+        }
+
+        // every section changed by this refresh shares the same new version
+        if (!changed) {
+            changed = true;
+            version++;
+        }
+
+        section.value = section.build();
+        section.lastStamp = stamp;
+        section.version = version;
+        section.built = true;
+    }
+
+    return version;
+}
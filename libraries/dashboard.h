@@ -0,0 +1,51 @@
+#ifndef DASHBOARD_H
+#define DASHBOARD_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+#include <functional>
+
+/*
+ * Snapshot of everything the home page shows, split in sections owned by
+ * the controllers. A section is rebuilt only when its stamp changed and
+ * records the dashboard version of that change, so that clients can ask
+ * for the sections changed since the version they already have.
+ */
+class Dashboard
+{
+public:
+    typedef std::function<QByteArray()> Stamp;
+    typedef std::function<QJsonValue()> Builder;
+
+    static Dashboard& dashboard();
+
+    void addSection(const QString &name, Stamp stamp, Builder build);
+    qint64 refresh();
+    QJsonObject getSnapshot(qint64 since = 0);
+
+protected:
+    Dashboard();
+
+    struct Section {
+        Stamp stamp;
+        Builder build;
+        QByteArray lastStamp;
+        QJsonValue value;
+        qint64 version;
+        bool built;
+    };
+
+    qint64 refreshSections();
+
+    QMap<QString, Section> sections;
+    QMutex mutex;
+    qint64 firstVersion;
+    qint64 version;
+};
+
+#endif // DASHBOARD_H
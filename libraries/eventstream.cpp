@@ -0,0 +1,187 @@
+#include "eventstream.h"
+#include "libraries/modelfeed.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QThread>
+
+EventStream::EventStream()
+{
+    // ids keep growing across restarts so that stale Last-Event-IDs are detected
+    lastId = QDateTime::currentMSecsSinceEpoch() * 1000;
+    replaySize = 512;
+    heartbeatInterval = 15000;
+}
+
+EventStream& EventStream::stream()
+{
+    static EventStream instance;
+    return instance;
+}
+
+bool EventStream::subscribe(RequestContext *context, const QSet<QString> &topics, qint64 lastEventId)
+{
+    // the client object must live in the thread of the context, concurrent routes run in the pool
+    if (context->thread() != QThread::currentThread()) {
+        bool subscribed = false;
+
+        QMetaObject::invokeMethod(context, [this, context, &topics, lastEventId, &subscribed]() {
+            subscribed = subscribe(context, topics, lastEventId);
+        }, Qt::BlockingQueuedConnection);
+
+        return subscribed;
+    }
+
+    QTcpSocket *socket = context->getSocket();
+
+    if (socket == nullptr || socket->state() != QTcpSocket::ConnectedState) {
+        return false;
+    }
+
+    EventStreamClient *client = new EventStreamClient(context, topics, heartbeatInterval);
+
+    context->setAsync();
+    context->beginChunked("200 OK",
+                          "Content-Type: text/event-stream; charset=utf-8\r\n"
+                          "Cache-Control: no-cache\r\n"
+                          "X-Accel-Buffering: no\r\n");
+    context->writeChunk("retry: 3000\n\n");
+
+    // replay and registration under the same lock: nothing is lost or sent twice
+    QMutexLocker locker(&mutex);
+
+    if (lastEventId > 0 && lastEventId != lastId) {
+        if (lastEventId > lastId || replay.isEmpty() || replay.first().id > lastEventId + 1) {
+            client->send("resync", createFrame(lastId, "{\"topic\":\"resync\"}"));
+        }
+
+        foreach (const Entry &entry, replay) {
+            if (entry.id > lastEventId) {
+                client->send(entry.topic, entry.frame);
+            }
+        }
+    }
+
+    connect(this, &EventStream::event, client, &EventStreamClient::send, Qt::QueuedConnection);
+
+    return true;
+}
+
+int EventStream::getHeartbeatInterval() const
+{
+    return heartbeatInterval;
+}
+
+void EventStream::setHeartbeatInterval(int value)
+{
+    heartbeatInterval = value;
+}
+
+void EventStream::setReplaySize(int value)
+{
+    QMutexLocker locker(&mutex);
+    replaySize = value;
+}
+
+void EventStream::publish(QString topic, QJsonObject message)
+{
+    QMutexLocker locker(&mutex);
+
+    Entry entry;
+    entry.id = ++lastId;
+    entry.topic = topic;
+    entry.frame = createFrame(entry.id, QJsonDocument(message).toJson(QJsonDocument::Compact));
+
+    replay.append(entry);
+    while (replay.size() > replaySize) {
+        replay.removeFirst();
+    }
+
+    emit event(topic, entry.frame);
+}
+
+QByteArray EventStream::createFrame(qint64 id, const QByteArray &data)
+{
+    return "id: " + QByteArray::number(id) + "\ndata: " + data + "\n\n";
+}
+
+EventStreamClient::EventStreamClient(RequestContext *context, const QSet<QString> &topics, int heartbeatInterval)
+    : QObject(context)
+{
+    this->context = context;
+    this->topics = topics;
+    this->behind = false;
+
+    // comment lines keep proxies and mobile networks from closing an idle stream
+    heartbeatTimer = new QTimer(this);
+    heartbeatTimer->setInterval(heartbeatInterval);
+    connect(heartbeatTimer, &QTimer::timeout, this, &EventStreamClient::heartbeat);
+    heartbeatTimer->start();
+
+    connect(context->getSocket(), &QTcpSocket::disconnected, this, &EventStreamClient::close);
+}
+
+void EventStreamClient::send(QString topic, QByteArray frame)
+{
+    if (!topics.isEmpty() && topic != "resync" && !ModelFeed::matchTopic(topics, topic)) {
+        return;
+    }
+
+    if (catchUp()) {
+        context->writeChunk(frame);
+    }
+}
+
+void EventStreamClient::heartbeat()
+{
+    QTcpSocket *socket = context->getSocket();
+
+    if (socket == nullptr || socket->state() != QTcpSocket::ConnectedState) {
+        close();
+        return;
+    }
+
+    // the client did not catch up since its frames were skipped: give up on it
+    if (behind && behindTimer.elapsed() > heartbeatTimer->interval()
+            && socket->bytesToWrite() > maxBufferedBytes) {
+        qWarning() << "Event stream client too slow, dropped:" << socket->peerAddress().toString();
+        socket->abort();
+        return;
+    }
+
+    if (catchUp()) {
+        context->writeChunk(": ping\n\n");
+    }
+}
+
+bool EventStreamClient::catchUp()
+{
+    QTcpSocket *socket = context->getSocket();
+
+    // slow consumer: frames are skipped rather than piled up in the socket buffer
+    if (socket == nullptr || socket->bytesToWrite() > maxBufferedBytes) {
+        if (!behind) {
+            behind = true;
+            behindTimer.start();
+        }
+        return false;
+    }
+
+    // drained again: the client refetches what it missed, the event id is left as is
+    if (behind) {
+        behind = false;
+        context->writeChunk("data: {\"topic\":\"resync\"}\n\n");
+    }
+
+    return true;
+}
+
+void EventStreamClient::close()
+{
+    // ends the response: the worker then deletes the context and this client
+    heartbeatTimer->stop();
+    disconnect(&EventStream::stream(), nullptr, this, nullptr);
+    context->endChunked();
+}
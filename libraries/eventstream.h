@@ -0,0 +1,91 @@
+#ifndef EVENTSTREAM_H
+#define EVENTSTREAM_H
+
+#include "core/requestcontext.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+/*
+ * Server-Sent Events version of the model feed. Deltas are numbered and
+ * kept in a bounded replay buffer so that a client reconnecting with
+ * Last-Event-ID gets what it missed.
+ */
+class EventStream : public QObject
+{
+    Q_OBJECT
+
+public:
+    static EventStream& stream();
+
+    bool subscribe(RequestContext *context, const QSet<QString> &topics, qint64 lastEventId);
+
+    int getHeartbeatInterval() const;
+    void setHeartbeatInterval(int value);
+    void setReplaySize(int value);
+
+public slots:
+    void publish(QString topic, QJsonObject message);
+
+signals:
+    void event(QString topic, QByteArray frame);
+
+protected:
+    EventStream();
+
+    struct Entry {
+        qint64 id;
+        QString topic;
+        QByteArray frame;
+    };
+
+    static QByteArray createFrame(qint64 id, const QByteArray &data);
+
+    QList<Entry> replay;
+    QMutex mutex;
+    qint64 lastId;
+    int replaySize;
+    int heartbeatInterval;
+};
+
+/*
+ * One /events response. It lives in the thread of its request context and
+ * dies with it. A client which does not read its stream has its frames
+ * skipped and is told to resync once it caught up, or dropped if it does
+ * not catch up within a heartbeat interval.
+ */
+class EventStreamClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    EventStreamClient(RequestContext *context, const QSet<QString> &topics, int heartbeatInterval);
+
+    // Below the high water mark of the context: writing a frame never blocks the worker
+    static const int maxBufferedBytes = 64 * 1024;
+
+public slots:
+    void send(QString topic, QByteArray frame);
+
+private slots:
+    void heartbeat();
+    void close();
+
+private:
+    bool catchUp();
+
+    RequestContext *context;
+    QSet<QString> topics;
+    QTimer *heartbeatTimer;
+    bool behind;
+    QElapsedTimer behindTimer;
+};
+
+#endif // EVENTSTREAM_H
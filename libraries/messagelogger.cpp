@@ -4,6 +4,7 @@
 MessageLogger::MessageLogger()
 {
     idCpt = 1;
+    alertVersion = 0;
 }
 
 MessageLogger::~MessageLogger()
@@ -42,24 +43,44 @@ void MessageLogger::messageHandler(QtMsgType type, const QMessageLogContext &con
 
 void MessageLogger::addMessage(QString type, QString msg)
 {
+    // Messages are also logged from the http worker threads
+    mutex.lock();
     MessageLogger::Log log = {idCpt, QDateTime::currentDateTime(), msg, type};
     messages.append(log);
     idCpt++;
+
+    if (type == "warning" || type == "critical") {
+        alertVersion++;
+    }
     
     if (messages.size() > 3000) {
+        // dropping the oldest message may drop an alert
+        if (messages.first().type == "warning" || messages.first().type == "critical") {
+            alertVersion++;
+        }
         messages.removeFirst();
     }
+    mutex.unlock();
 
     emit newMessage(type, msg);
 }
 
-QList<MessageLogger::Log>& MessageLogger::getMessages()
+QList<MessageLogger::Log> MessageLogger::getMessages()
 {
+    QMutexLocker locker(&mutex);
     return messages;
 }
 
+int MessageLogger::getAlertVersion()
+{
+    QMutexLocker locker(&mutex);
+    return alertVersion;
+}
+
 void MessageLogger::removeBeforeId(int id, QString type)
 {
+    QMutexLocker locker(&mutex);
+    alertVersion++;
     QMutableListIterator<MessageLogger::Log> i(messages);
     while (i.hasNext()) {
         if ((id == 0 || i.peekNext().id <= id) && (i.next().type == type || type == "all")) {
@@ -4,6 +4,7 @@
 #include <QDateTime>
 #include <QList>
 #include <QMessageLogContext>
+#include <QMutex>
 #include <QObject>
 #include <QString>
 
@@ -19,9 +20,10 @@ public:
         QString type;
     };
 
-    QList<Log>& getMessages();
+    QList<Log> getMessages();
     void addMessage(QString type, QString msg);
     void removeBeforeId(int id, QString type);
+    int getAlertVersion();
 
     static MessageLogger& logger();
     static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
@@ -34,7 +36,9 @@ protected:
     ~MessageLogger();
 
     QList<Log> messages;
+    QMutex mutex;
     int idCpt;
+    int alertVersion;
 };
 
 #endif // MESSAGELOGGER_H
@@ -0,0 +1,174 @@
+#include "modelfeed.h"
+#include "libraries/messagelogger.h"
+#include "models/camera.h"
+#include "models/heater.h"
+#include "models/scenario.h"
+#include "models/script.h"
+#include "models/sensor.h"
+#include "models/setting.h"
+#include "models/switch.h"
+
+#include <QDateTime>
+
+ModelFeed::ModelFeed(QObject *parent) : QObject(parent)
+{
+    connect(Sensor::getEvent(), SIGNAL(valueUpdated(QString,QString,QString)), this, SLOT(sensorUpdated(QString,QString,QString)));
+    connect(Switch::getEvent(), SIGNAL(valueUpdated(QString,QString,QString)), this, SLOT(switchUpdated(QString,QString,QString)));
+    connect(Heater::getEvent(), SIGNAL(valueUpdated(QString,QString,QString)), this, SLOT(heaterUpdated(QString,QString,QString)));
+    connect(Setting::getEvent(), SIGNAL(valueUpdated(QString,QString,QString)), this, SLOT(settingUpdated(QString,QString,QString)));
+
+    connect(Sensor::getEvent(), SIGNAL(dataChanged()), this, SLOT(sensorListChanged()));
+    connect(Switch::getEvent(), SIGNAL(dataChanged()), this, SLOT(switchListChanged()));
+    connect(Heater::getEvent(), SIGNAL(dataChanged()), this, SLOT(heaterListChanged()));
+    connect(Setting::getEvent(), SIGNAL(dataChanged()), this, SLOT(settingListChanged()));
+    connect(Scenario::getEvent(), SIGNAL(dataChanged()), this, SLOT(scenarioListChanged()));
+    connect(Script::getEvent(), SIGNAL(dataChanged()), this, SLOT(scriptListChanged()));
+    connect(Camera::getEvent(), SIGNAL(dataChanged()), this, SLOT(cameraListChanged()));
+
+    // messages can be logged from any thread
+    connect(&MessageLogger::logger(),
+            SIGNAL(newMessage(QString, QString)),
+            this,
+            SLOT(messageLogged(QString, QString)),
+            Qt::QueuedConnection);
+}
+
+QJsonObject ModelFeed::createDelta(QString topic, QString id, QString value)
+{
+    QJsonObject message;
+
+    message.insert("topic", topic);
+    message.insert("id", id);
+    message.insert("value", value);
+
+    return message;
+}
+
+bool ModelFeed::matchTopic(const QSet<QString> &topics, const QString &topic)
+{
+    if (topics.contains(topic) || topics.contains("*")) {
+        return true;
+    }
+
+    // "sensor.*" matches every sensor topic
+    int dot = topic.indexOf('.');
+    return dot > 0 && topics.contains(topic.left(dot) + ".*");
+}
+
+void ModelFeed::sensorUpdated(QString id, QString type, QString value)
+{
+    Sensor *sensor = Sensor::get(id);
+    QJsonObject message = createDelta("sensor." + type, id, value);
+
+    if (sensor != NULL) {
+        message.insert("record", sensor->toJson());
+    }
+    emit delta(message.value("topic").toString(), message);
+
+    if (type != "value") {
+        return;
+    }
+
+    // heater temperatures are read from their sensor
+    foreach (Heater *heater, Heater::heaters()->values()) {
+        if (heater->getSensor() == id) {
+            QJsonObject heaterMessage = createDelta("heater.temperature",
+                                                    QString::number(heater->getId()),
+                                                    QString::number(heater->getTemperature()));
+            heaterMessage.insert("record", heater->toJson());
+            emit delta("heater.temperature", heaterMessage);
+        }
+    }
+}
+
+void ModelFeed::switchUpdated(QString id, QString type, QString value)
+{
+    Switch *sw = Switch::get(id);
+    QJsonObject message = createDelta("switch." + type, id, value);
+
+    if (sw != NULL) {
+        message.insert("record", sw->toJson());
+    }
+    emit delta(message.value("topic").toString(), message);
+}
+
+void ModelFeed::heaterUpdated(QString id, QString type, QString value)
+{
+    Heater *heater = Heater::get(id.toInt());
+    QString topic = "heater." + type;
+
+    if (type == "heat_setpoint" || type == "cool_setpoint") {
+        topic = "heater.setpoint";
+    }
+
+    QJsonObject message = createDelta(topic, id, value);
+    message.insert("setpoint", type);
+
+    if (heater != NULL) {
+        message.insert("record", heater->toJson());
+    }
+    emit delta(topic, message);
+}
+
+void ModelFeed::settingUpdated(QString id, QString type, QString value)
+{
+    Q_UNUSED(type);
+
+    emit delta("setting.value", createDelta("setting.value", id, value));
+}
+
+void ModelFeed::sensorListChanged()
+{
+    publishList("sensor");
+}
+
+void ModelFeed::switchListChanged()
+{
+    publishList("switch");
+}
+
+void ModelFeed::heaterListChanged()
+{
+    publishList("heater");
+}
+
+void ModelFeed::settingListChanged()
+{
+    publishList("setting");
+}
+
+void ModelFeed::scenarioListChanged()
+{
+    publishList("scenario");
+}
+
+void ModelFeed::scriptListChanged()
+{
+    publishList("script");
+}
+
+void ModelFeed::cameraListChanged()
+{
+    publishList("camera");
+}
+
+void ModelFeed::messageLogged(QString type, QString message)
+{
+    QJsonObject result;
+
+    result.insert("topic", "log.append");
+    result.insert("type", type);
+    result.insert("message", message);
+    result.insert("date", QDateTime::currentDateTime().toString("dd/MM/yyyy hh:mm:ss zzz"));
+
+    emit delta("log.append", result);
+}
+
+void ModelFeed::publishList(QString model)
+{
+    QJsonObject message;
+
+    message.insert("topic", model + ".list");
+
+    emit delta(model + ".list", message);
+}
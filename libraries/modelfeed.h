@@ -0,0 +1,46 @@
+#ifndef MODELFEED_H
+#define MODELFEED_H
+
+#include <QJsonObject>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+/*
+ * Turns model events into typed deltas. Every delta carries the topic it
+ * belongs to ("sensor.value", "switch.status", "heater.setpoint",
+ * "log.append", "<model>.list"...) and, when the model still exists, the
+ * up to date record so that clients can patch their state in place.
+ */
+class ModelFeed : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ModelFeed(QObject *parent = 0);
+
+    static QJsonObject createDelta(QString topic, QString id, QString value);
+    static bool matchTopic(const QSet<QString> &topics, const QString &topic);
+
+signals:
+    void delta(QString topic, QJsonObject message);
+
+private slots:
+    void sensorUpdated(QString id, QString type, QString value);
+    void switchUpdated(QString id, QString type, QString value);
+    void heaterUpdated(QString id, QString type, QString value);
+    void settingUpdated(QString id, QString type, QString value);
+    void sensorListChanged();
+    void switchListChanged();
+    void heaterListChanged();
+    void settingListChanged();
+    void scenarioListChanged();
+    void scriptListChanged();
+    void cameraListChanged();
+    void messageLogged(QString type, QString message);
+
+private:
+    void publishList(QString model);
+};
+
+#endif // MODELFEED_H
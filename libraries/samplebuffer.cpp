@@ -0,0 +1,110 @@
+#include "samplebuffer.h"
+
+SampleBuffer::SampleBuffer(int capacity)
+{
+    this->capacity = capacity;
+    this->total = 0;
+}
+
+void SampleBuffer::append(const QString &id, qint64 time, float value)
+{
+    int index = dictionary.value(id, -1);
+
+    if (index < 0) {
+        Ring ring;
+        ring.times.resize(capacity);
+        ring.values.resize(capacity);
+        ring.first = 0;
+        ring.count = 0;
+
+        index = rings.size();
+        rings.append(ring);
+        ids.append(id);
+        dictionary.insert(id, index);
+    }
+
+    Ring &ring = rings[index];
+    int position = (ring.first + ring.count) % capacity;
+
+    // Full ring: the oldest sample is dropped by moving the start
+    if (ring.count == capacity) {
+        ring.first = (ring.first + 1) % capacity;
+    } else {
+        ring.count++;
+        total++;
+    }
+
+    ring.times[position] = time;
+    ring.values[position] = value;
+}
+
+void SampleBuffer::clear()
+{
+    // The rings and the dictionary are kept: sensors come back at the next sample
+    for (int i = 0; i < rings.size(); i++) {
+        rings[i].first = 0;
+        rings[i].count = 0;
+    }
+
+    total = 0;
+}
+
+int SampleBuffer::size() const
+{
+    return total;
+}
+
+bool SampleBuffer::isEmpty() const
+{
+    return total == 0;
+}
+
+qint64 SampleBuffer::getOldestTime() const
+{
+    qint64 result = -1;
+
+    foreach (const Ring &ring, rings) {
+        if (ring.count > 0 && (result < 0 || ring.times.at(ring.first) < result)) {
+            result = ring.times.at(ring.first);
+        }
+    }
+
+    return result;
+}
+
+int SampleBuffer::lowerBound(const Ring &ring, qint64 time) const
+{
+    // Samples of a ring are in time order: binary search on the logical positions
+    int low = 0;
+    int high = ring.count;
+
+    while (low < high) {
+        int middle = (low + high) / 2;
+
+        if (ring.times.at((ring.first + middle) % capacity) < time) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+void SampleBuffer::forEach(qint64 start, qint64 end, std::function<void(const QString &, qint64, float)> callback) const
+{
+    for (int index = 0; index < rings.size(); index++) {
+        const Ring &ring = rings.at(index);
+        const QString &id = ids.at(index);
+
+        for (int i = lowerBound(ring, start); i < ring.count; i++) {
+            int position = (ring.first + i) % capacity;
+
+            if (ring.times.at(position) > end) {
+                break;
+            }
+
+            callback(id, ring.times.at(position), ring.values.at(position));
+        }
+    }
+}
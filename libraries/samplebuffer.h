@@ -0,0 +1,48 @@
+#ifndef SAMPLEBUFFER_H
+#define SAMPLEBUFFER_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+/*
+ * In-memory window of sensor samples: one fixed-capacity ring per sensor,
+ * stored in columns (epoch seconds, float values) and indexed by a sensor
+ * dictionary, so a sample takes 8 bytes. When a ring is full its oldest
+ * sample is overwritten. Not thread-safe: the owner locks it.
+ */
+class SampleBuffer
+{
+public:
+    explicit SampleBuffer(int capacity = 4096);
+
+    void append(const QString &id, qint64 time, float value);
+    void clear();
+
+    int size() const;
+    bool isEmpty() const;
+    qint64 getOldestTime() const;
+
+    void forEach(qint64 start, qint64 end, std::function<void(const QString &, qint64, float)> callback) const;
+
+protected:
+    struct Ring {
+        QVector<quint32> times;
+        QVector<float> values;
+        int first;
+        int count;
+    };
+
+    int lowerBound(const Ring &ring, qint64 time) const;
+
+    QStringList ids;
+    QHash<QString, int> dictionary;
+    QVector<Ring> rings;
+    int capacity;
+    int total;
+};
+
+#endif // SAMPLEBUFFER_H
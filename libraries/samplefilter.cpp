@@ -0,0 +1,113 @@
+#include "samplefilter.h"
+#include "settings.h"
+
+SampleFilter::SampleFilter() : SampleFilter(Policy())
+{
+
+}
+
+SampleFilter::SampleFilter(const Policy &policy)
+{
+    this->policy = policy;
+    archived = false;
+    pending = false;
+    upperSlope = 0;
+    lowerSlope = 0;
+}
+
+SampleFilter::Policy SampleFilter::getPolicy(const QString &category)
+{
+    Settings settings("sampling");
+    Policy policy;
+
+    policy.deadband = settings.value(category + "_deadband", "0").toFloat();
+    policy.maxInterval = settings.value(category + "_max_interval", "3600").toInt();
+    policy.events = settings.value(category + "_events", "false") == "true";
+
+    return policy;
+}
+
+QList<SampleFilter::Sample> SampleFilter::add(qint64 time, float value)
+{
+    QList<Sample> result;
+
+    if (!archived || policy.deadband <= 0) {
+        result.append(Sample(time, value));
+        archived = true;
+        archive = Sample(time, value);
+        pending = false;
+        return result;
+    }
+
+    // Same second as the last stored sample: nothing to draw
+    if (time <= archive.first) {
+        return result;
+    }
+
+    if (!pending) {
+        openDoor(time, value);
+    } else {
+        double elapsed = time - archive.first;
+        double upper = qMin(upperSlope, (value + policy.deadband - archive.second) / elapsed);
+        double lower = qMax(lowerSlope, (value - policy.deadband - archive.second) / elapsed);
+
+        if (lower > upper) {
+            // The door closed: the segment ends at the previous sample and the next one starts there
+            result.append(closeDoor());
+            openDoor(time, value);
+        } else {
+            upperSlope = upper;
+            lowerSlope = lower;
+            snapshot = Sample(time, value);
+        }
+    }
+
+    if (policy.maxInterval > 0 && snapshot.first - archive.first >= policy.maxInterval) {
+        result.append(closeDoor());
+        pending = false;
+    }
+
+    return result;
+}
+
+QList<SampleFilter::Sample> SampleFilter::flush()
+{
+    QList<Sample> result;
+
+    // The readings since the last stored sample end their segment now
+    if (pending) {
+        result.append(closeDoor());
+        pending = false;
+    }
+
+    return result;
+}
+
+qint64 SampleFilter::getLastTime() const
+{
+    if (pending) {
+        return snapshot.first;
+    }
+
+    return archived ? archive.first : -1;
+}
+
+void SampleFilter::openDoor(qint64 time, float value)
+{
+    double elapsed = time - archive.first;
+
+    upperSlope = (value + policy.deadband - archive.second) / elapsed;
+    lowerSlope = (value - policy.deadband - archive.second) / elapsed;
+    snapshot = Sample(time, value);
+    pending = true;
+}
+
+SampleFilter::Sample SampleFilter::closeDoor()
+{
+    // The stored value is on the middle line of the door, not the reading itself:
+    // every sample of the segment is then within the deadband of the chart line
+    double slope = (upperSlope + lowerSlope) / 2;
+    archive = Sample(snapshot.first, archive.second + slope * (snapshot.first - archive.first));
+
+    return archive;
+}
@@ -0,0 +1,50 @@
+#ifndef SAMPLEFILTER_H
+#define SAMPLEFILTER_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+
+/*
+ * Swinging door compression of the samples of one sensor. A sample is only
+ * stored when no straight line from the last stored sample can pass within
+ * the deadband of every sample seen since; the chart line between two stored
+ * samples is then never further than the deadband from a reading. A sample
+ * is stored at least every max interval. A deadband of 0 stores every sample.
+ * flush() stores the last reading of an open door, when the sensor goes
+ * silent or the logger stops.
+ */
+class SampleFilter
+{
+public:
+    typedef QPair<qint64, float> Sample;
+
+    struct Policy {
+        float deadband = 0;
+        int maxInterval = 3600;
+        bool events = false;
+    };
+
+    SampleFilter();
+    explicit SampleFilter(const Policy &policy);
+
+    QList<Sample> add(qint64 time, float value);
+    QList<Sample> flush();
+    qint64 getLastTime() const;
+
+    static Policy getPolicy(const QString &category);
+
+protected:
+    void openDoor(qint64 time, float value);
+    Sample closeDoor();
+
+    Policy policy;
+    bool archived;
+    Sample archive;
+    bool pending;
+    Sample snapshot;
+    double upperSlope;
+    double lowerSlope;
+};
+
+#endif // SAMPLEFILTER_H
@@ -0,0 +1,202 @@
+#include "samplejournal.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Record: id length (1), id (utf-8), time (8), value (4), checksum (2)
+static const int recordOverhead = 1 + 8 + 4 + 2;
+
+SampleJournal::SampleJournal()
+{
+    pending = 0;
+}
+
+SampleJournal::~SampleJournal()
+{
+    close();
+}
+
+bool SampleJournal::open(const QString &fileName, std::function<void(const QString &, qint64, float)> replay)
+{
+    QFileInfo info(fileName);
+
+    if (!info.dir().exists() && !QDir().mkpath(info.absolutePath())) {
+        qCritical() << "Journal directory not created: " << info.absolutePath();
+        return false;
+    }
+
+    // Unbuffered: a record is in the file when append() returns, fsynced by the next sync()
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Unbuffered)) {
+        qCritical() << "Journal not opened: " << fileName << file.errorString();
+        return false;
+    }
+
+    QByteArray data = file.readAll();
+    const uchar *bytes = (const uchar *) data.constData();
+    int position = 0;
+    int replayed = 0;
+
+    while (position < data.size()) {
+        int length = bytes[position];
+        int size = recordOverhead + length;
+
+        // A record cut by a crash ends the journal
+        if (position + size > data.size()) {
+            break;
+        }
+
+        const uchar *record = bytes + position;
+        quint16 expected = qFromLittleEndian<quint16>(record + size - 2);
+
+        if (checksum(QByteArray::fromRawData((const char *) record, size - 2)) != expected) {
+            break;
+        }
+
+        QString id = QString::fromUtf8((const char *) record + 1, length);
+        qint64 time = qFromLittleEndian<qint64>(record + 1 + length);
+        quint32 bits = qFromLittleEndian<quint32>(record + 1 + length + 8);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+
+        replay(id, time, value);
+        position += size;
+        replayed++;
+    }
+
+    if (position < data.size()) {
+        qWarning() << "Journal truncated after a torn record: " << fileName << (data.size() - position) << "bytes";
+        file.resize(position);
+    }
+
+    file.seek(position);
+
+    if (replayed > 0) {
+        qDebug() << "Journal replayed" << replayed << "samples";
+    }
+
+    return true;
+}
+
+bool SampleJournal::isOpen() const
+{
+    return file.isOpen();
+}
+
+void SampleJournal::close()
+{
+    if (file.isOpen()) {
+        sync();
+        file.close();
+    }
+}
+
+bool SampleJournal::append(const QString &id, qint64 time, float value)
+{
+    if (!file.isOpen()) {
+        return false;
+    }
+
+    QByteArray idData = id.toUtf8().left(255);
+    QByteArray record(recordOverhead + idData.size(), '\0');
+    uchar *data = (uchar *) record.data();
+    quint32 bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    data[0] = idData.size();
+    memcpy(data + 1, idData.constData(), idData.size());
+    qToLittleEndian<qint64>(time, data + 1 + idData.size());
+    qToLittleEndian<quint32>(bits, data + 1 + idData.size() + 8);
+    qToLittleEndian<quint16>(checksum(record.left(record.size() - 2)), data + record.size() - 2);
+
+    if (file.write(record) != record.size()) {
+        qCritical() << "Journal not written: " << file.errorString();
+        return false;
+    }
+
+    pending++;
+    return true;
+}
+
+bool SampleJournal::sync()
+{
+    if (!file.isOpen() || pending == 0) {
+        return true;
+    }
+
+    // One fsync for all the records appended since the last one
+    bool success = file.flush();
+
+#ifdef Q_OS_WIN
+    success = success && _commit(file.handle()) == 0;
+#else
+    success = success && fsync(file.handle()) == 0;
+#endif
+
+    if (!success) {
+        qCritical() << "Journal not synced: " << file.fileName();
+        return false;
+    }
+
+    pending = 0;
+    return true;
+}
+
+bool SampleJournal::truncate()
+{
+    if (!file.isOpen()) {
+        return false;
+    }
+
+    pending++;
+
+    if (!file.resize(0) || !file.seek(0)) {
+        qCritical() << "Journal not truncated: " << file.errorString();
+        return false;
+    }
+
+    return sync();
+}
+
+bool SampleJournal::rotate(const QString &fileName)
+{
+    if (!file.isOpen() || !sync()) {
+        return false;
+    }
+
+    QString name = file.fileName();
+    file.close();
+
+    // Left by a batch written already
+    QFile::remove(fileName);
+
+    bool success = QFile::rename(name, fileName);
+    if (!success) {
+        qCritical() << "Journal not rotated: " << fileName;
+    }
+
+    // Empty, or the same records again when the rename failed
+    file.setFileName(name);
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Unbuffered) || !file.seek(file.size())) {
+        qCritical() << "Journal not opened: " << name << file.errorString();
+        return false;
+    }
+
+    return success;
+}
+
+quint16 SampleJournal::checksum(const QByteArray &data)
+{
+    return qChecksum(data.constData(), data.size());
+}
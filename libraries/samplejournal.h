@@ -0,0 +1,40 @@
+#ifndef SAMPLEJOURNAL_H
+#define SAMPLEJOURNAL_H
+
+#include <QFile>
+#include <QString>
+
+#include <functional>
+
+/*
+ * Write-ahead log of the samples waiting in memory. Each sample is appended
+ * as a checksummed record, written to the file at once so a crash of the
+ * process does not lose it; sync() makes the appended records durable in one
+ * fsync. On open the records are replayed, up to a torn last record, and
+ * truncate() empties the log once the samples are in the database. rotate()
+ * hands the records over to another file, removed once they are written,
+ * while the journal goes on empty.
+ */
+class SampleJournal
+{
+public:
+    SampleJournal();
+    ~SampleJournal();
+
+    bool open(const QString &fileName, std::function<void(const QString &, qint64, float)> replay);
+    bool isOpen() const;
+    void close();
+
+    bool append(const QString &id, qint64 time, float value);
+    bool sync();
+    bool truncate();
+    bool rotate(const QString &fileName);
+
+protected:
+    static quint16 checksum(const QByteArray &data);
+
+    QFile file;
+    int pending;
+};
+
+#endif // SAMPLEJOURNAL_H
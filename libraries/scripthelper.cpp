@@ -40,7 +40,7 @@ int ScriptHelper::getMinute()
 int ScriptHelper::getWarningNumber()
 {
     QList<QString> result;
-    QList<MessageLogger::Log> &logs = MessageLogger::logger().getMessages();
+    QList<MessageLogger::Log> logs = MessageLogger::logger().getMessages();
 
     foreach (const MessageLogger::Log &log, logs) {
         if (log.type == "warning" || log.type == "critical") {
@@ -56,7 +56,7 @@ int ScriptHelper::getWarningNumber()
 QString ScriptHelper::getWarning(int number)
 {
     QList<QString> result;
-    QList<MessageLogger::Log> &logs = MessageLogger::logger().getMessages();
+    QList<MessageLogger::Log> logs = MessageLogger::logger().getMessages();
 
     foreach (const MessageLogger::Log &log, logs) {
         if (log.type == "warning" || log.type == "critical") {
@@ -1,11 +1,38 @@
 #include "temperaturelogger.h"
+#include "models/temperaturerollup.h"
 
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+
+#include <climits>
 
 TemperatureLogger::TemperatureLogger(QObject *parent) : QObject(parent)
 {
     timer.setInterval(10*60*1000); // 10 minutes
     connect(&timer, SIGNAL(timeout()), this, SLOT(run()));
+    connect(Sensor::getEvent(), SIGNAL(valueUpdated(QString,QString,QString)),
+            this, SLOT(sensorUpdated(QString,QString,QString)), Qt::QueuedConnection);
+
+    // Samples buffered before a crash or a kill are back in the buffer, then in the database.
+    // A batch stopped while it was written is written again: its stored samples are ignored.
+    QString fileName = QDir::currentPath() + "/data/temperature.wal";
+    savingJournal = fileName + ".saving";
+
+    if (QFile::exists(savingJournal)) {
+        SampleJournal batch;
+        batch.open(savingJournal, [this](const QString &id, qint64 time, float value) {
+            saving.append(id, time, value);
+        });
+    }
+
+    journal.open(fileName, [this](const QString &id, qint64 time, float value) {
+        samples.append(id, time, value);
+    });
+
+    if (!saving.isEmpty() || !samples.isEmpty()) {
+        save();
+    }
 }
 
 void TemperatureLogger::run()
@@ -25,27 +52,87 @@ void TemperatureLogger::run()
             }
         } else {
             if (parseSuccess  && temp > -30 && temp < 50) {
-                Temperature temperature(sensor->getId(), temp);
-                temperatureList.append(temperature);
-
-                if (temperatureList.length() > 15000) {
-                    temperatureList.removeFirst();
-                }
+                QMutexLocker locker(&mutex);
+                record(sensor->getId(), QDateTime::currentMSecsSinceEpoch() / 1000, temp);
             } else {
                 qWarning() << "Sensor value " << sensor->getValue() << " of sensor " << sensor->getName() << " is not valid!";
             }
         }
     }
 
-    if (!temperatureList.isEmpty() &&
-        temperatureList.first().getDate().addSecs(3600) < QDateTime::currentDateTime())
-    {
+    qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
+    mutex.lock();
+
+    // A sensor silent for longer than the max interval: its last reading ends the line
+    for (auto it = filters.begin(); it != filters.end(); ++it) {
+        qint64 lastTime = it.value().getLastTime();
+
+        if (policy.maxInterval > 0 && lastTime >= 0 && now - lastTime > policy.maxInterval) {
+            keep(it.key(), it.value().flush());
+        }
+    }
+
+    // One fsync per tick for the readings journaled since the last one
+    journal.sync();
+    bool saveNeeded = !saving.isEmpty() || (!samples.isEmpty() &&
+                      samples.getOldestTime() + 3600 < now);
+    mutex.unlock();
+
+    if (saveNeeded) {
         save();
     }
 }
 
+void TemperatureLogger::sensorUpdated(QString id, QString type, QString value)
+{
+    // Every reading goes through the filter: the changes between two ticks are kept
+    if (!policy.events || !timer.isActive() || type != "value") {
+        return;
+    }
+
+    Sensor *sensor = Sensor::getSensorList().value(id, nullptr);
+    if (sensor == nullptr || sensor->getCategory().compare("temperature", Qt::CaseInsensitive) != 0) {
+        return;
+    }
+
+    bool parseSuccess;
+    float temp = value.toFloat(&parseSuccess);
+
+    // Journaled now, made durable by the fsync of the next tick
+    if (parseSuccess && temp > -30 && temp < 50) {
+        QMutexLocker locker(&mutex);
+        record(id, QDateTime::currentMSecsSinceEpoch() / 1000, temp);
+    }
+}
+
+void TemperatureLogger::record(const QString &id, qint64 time, float value)
+{
+    if (!filters.contains(id)) {
+        filters.insert(id, SampleFilter(policy));
+    }
+
+    keep(id, filters[id].add(time, value));
+}
+
+void TemperatureLogger::keep(const QString &id, const QList<SampleFilter::Sample> &kept)
+{
+    // Only the samples kept by the sampling policy are buffered and journaled
+    foreach (const SampleFilter::Sample &sample, kept) {
+        samples.append(id, sample.first, sample.second);
+        journal.append(id, sample.first, sample.second);
+    }
+}
+
 void TemperatureLogger::start()
 {
+    mutex.lock();
+    policy = SampleFilter::getPolicy("temperature");
+    filters.clear();
+    mutex.unlock();
+
+    // Rollups draw the line between two samples, up to the gap the chart shows
+    TemperatureRollup::setMaxGap(getSampleInterval() * 3 / 2);
+
     timer.start();
     qDebug() << "TemperatureLogger started";
 }
@@ -53,6 +140,15 @@ void TemperatureLogger::start()
 void TemperatureLogger::stop()
 {
     timer.stop();
+
+    // The readings of the open doors are stored before the logger goes away
+    mutex.lock();
+    for (auto it = filters.begin(); it != filters.end(); ++it) {
+        keep(it.key(), it.value().flush());
+    }
+    journal.sync();
+    mutex.unlock();
+
     save();
 }
 
@@ -61,15 +157,67 @@ bool TemperatureLogger::isActive()
     return timer.isActive();
 }
 
-QList<Temperature>& TemperatureLogger::getTemperatures()
+int TemperatureLogger::getSampleInterval()
 {
-    return temperatureList;
+    // Longest time between two stored samples of a sensor which keeps reporting:
+    // the max interval is checked on a reading, the next tick at the latest
+    QMutexLocker locker(&mutex);
+    return policy.deadband > 0 ? policy.maxInterval + timer.interval() / 1000 : timer.interval() / 1000;
 }
 
-void TemperatureLogger::save()
+void TemperatureLogger::forEachTemperature(QDateTime start, QDateTime end, std::function<void(const QString &, const QDateTime &, float)> callback)
 {
-    if (!temperatureList.isEmpty() && Temperature::save(temperatureList)) {
-        temperatureList.clear();
+    // Read by the http worker threads: only the window is copied under the lock, the
+    // callback writes the response after, so a slow client does not hold up the sensors
+    QList<Temperature> window;
+    auto copy = [&window](const QString &id, qint64 time, float value) {
+        window.append(Temperature(id, QDateTime::fromMSecsSinceEpoch(time * 1000), value));
+    };
+
+    mutex.lock();
+
+    // The batch being written first: it is older than the buffer
+    saving.forEach(start.toMSecsSinceEpoch() / 1000, end.toMSecsSinceEpoch() / 1000, copy);
+    samples.forEach(start.toMSecsSinceEpoch() / 1000, end.toMSecsSinceEpoch() / 1000, copy);
+
+    mutex.unlock();
+
+    foreach (const Temperature &temp, window) {
+        callback(temp.getId(), temp.getDate(), temp.getTemperature());
     }
 }
 
+void TemperatureLogger::save()
+{
+    // One batch at a time; the sensors and the readers only wait for the swap, not the database
+    QMutexLocker saveLocker(&saveMutex);
+
+    mutex.lock();
+
+    // A batch which failed is written again before the newer samples
+    if (saving.isEmpty()) {
+        if (samples.isEmpty() || !journal.rotate(savingJournal)) {
+            mutex.unlock();
+            return;
+        }
+
+        saving = samples;
+        samples.clear();
+    }
+
+    mutex.unlock();
+
+    // Only changed under both locks: read here without the sample lock
+    QList<Temperature> temperatureList;
+    saving.forEach(0, LLONG_MAX, [&temperatureList](const QString &id, qint64 time, float value) {
+        temperatureList.append(Temperature(id, QDateTime::fromMSecsSinceEpoch(time * 1000), value));
+    });
+
+    if (!Temperature::save(temperatureList)) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    saving.clear();
+    QFile::remove(savingJournal);
+}
@@ -1,12 +1,19 @@
 #ifndef TEMPERATURELOGGER_H
 #define TEMPERATURELOGGER_H
 
+#include "samplebuffer.h"
+#include "samplefilter.h"
+#include "samplejournal.h"
 #include "models/temperature.h"
 #include "models/sensor.h"
 
+#include <QDateTime>
+#include <QHash>
 #include <QObject>
 #include <QTimer>
-#include <QList>
+#include <QMutex>
+
+#include <functional>
 
 class TemperatureLogger : public QObject
 {
@@ -17,16 +24,27 @@ public:
     void start();
     void stop();
     bool isActive();
-    QList<Temperature> &getTemperatures();
+    int getSampleInterval();
+    void forEachTemperature(QDateTime start, QDateTime end, std::function<void(const QString &, const QDateTime &, float)> callback);
 
 protected slots:
     void run();
+    void sensorUpdated(QString id, QString type, QString value);
 
 protected:
     void save();
+    void record(const QString &id, qint64 time, float value);
+    void keep(const QString &id, const QList<SampleFilter::Sample> &kept);
 
     QTimer timer;
-    QList<Temperature> temperatureList;
+    SampleBuffer samples;
+    SampleBuffer saving;
+    SampleJournal journal;
+    QString savingJournal;
+    SampleFilter::Policy policy;
+    QHash<QString, SampleFilter> filters;
+    QMutex mutex;
+    QMutex saveMutex;
 };
 
 #endif // TEMPERATURELOGGER_H
@@ -0,0 +1,250 @@
+#include "timeseriescodec.h"
+
+#include <QtAlgorithms>
+#include <cstring>
+
+static quint32 floatToBits(float value)
+{
+    quint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bitsToFloat(quint32 bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+TimeSeriesEncoder::TimeSeriesEncoder()
+{
+    clear();
+}
+
+void TimeSeriesEncoder::clear()
+{
+    data.clear();
+    bitCount = 0;
+    count = 0;
+    firstTime = 0;
+    lastTime = 0;
+    lastDelta = 0;
+    lastValue = 0;
+    lastLeading = -1;
+    lastTrailing = 0;
+}
+
+void TimeSeriesEncoder::append(qint64 time, float value)
+{
+    quint32 bits = floatToBits(value);
+
+    if (count == 0) {
+        writeBits(time, 64);
+        writeBits(bits, 32);
+
+        firstTime = time;
+        lastTime = time;
+        lastValue = bits;
+        count++;
+        return;
+    }
+
+    // Timestamp: delta of delta, 1 bit when the period does not change
+    qint64 delta = time - lastTime;
+    qint64 deltaOfDelta = delta - lastDelta;
+
+    if (deltaOfDelta == 0) {
+        writeBits(0, 1);
+    } else if (deltaOfDelta >= -64 && deltaOfDelta <= 63) {
+        writeBits(0x2, 2);
+        writeBits(deltaOfDelta, 7);
+    } else if (deltaOfDelta >= -256 && deltaOfDelta <= 255) {
+        writeBits(0x6, 3);
+        writeBits(deltaOfDelta, 9);
+    } else if (deltaOfDelta >= -2048 && deltaOfDelta <= 2047) {
+        writeBits(0xE, 4);
+        writeBits(deltaOfDelta, 12);
+    } else {
+        writeBits(0xF, 4);
+        writeBits(deltaOfDelta, 32);
+    }
+
+    // Value: XOR with the previous one, 1 bit when it did not change
+    quint32 xorValue = bits ^ lastValue;
+
+    if (xorValue == 0) {
+        writeBits(0, 1);
+    } else {
+        int leading = qMin(qCountLeadingZeroBits(xorValue), 31u);
+        int trailing = qCountTrailingZeroBits(xorValue);
+
+        writeBits(1, 1);
+
+        if (lastLeading >= 0 && leading >= lastLeading && trailing >= lastTrailing) {
+            // The meaningful bits fit in the previous window
+            writeBits(0, 1);
+            writeBits(xorValue >> lastTrailing, 32 - lastLeading - lastTrailing);
+        } else {
+            int length = 32 - leading - trailing;
+
+            writeBits(1, 1);
+            writeBits(leading, 5);
+            writeBits(length - 1, 5);
+            writeBits(xorValue >> trailing, length);
+
+            lastLeading = leading;
+            lastTrailing = trailing;
+        }
+    }
+
+    lastDelta = delta;
+    lastTime = time;
+    lastValue = bits;
+    count++;
+}
+
+void TimeSeriesEncoder::writeBits(quint64 value, int bits)
+{
+    while (bits > 0) {
+        int used = bitCount % 8;
+
+        if (used == 0) {
+            data.append('\0');
+        }
+
+        int available = 8 - used;
+        int length = qMin(available, bits);
+        quint8 chunk = (value >> (bits - length)) & ((1u << length) - 1);
+
+        data.data()[data.size() - 1] |= chunk << (available - length);
+
+        bits -= length;
+        bitCount += length;
+    }
+}
+
+const QByteArray &TimeSeriesEncoder::getData() const
+{
+    return data;
+}
+
+int TimeSeriesEncoder::getCount() const
+{
+    return count;
+}
+
+qint64 TimeSeriesEncoder::getFirstTime() const
+{
+    return firstTime;
+}
+
+qint64 TimeSeriesEncoder::getLastTime() const
+{
+    return lastTime;
+}
+
+TimeSeriesDecoder::TimeSeriesDecoder(const uchar *data, qint64 size, int count)
+{
+    this->data = data;
+    this->bitSize = size * 8;
+    this->count = count;
+    position = 0;
+    index = 0;
+    error = false;
+    lastTime = 0;
+    lastDelta = 0;
+    lastValue = 0;
+    lastLeading = -1;
+    lastTrailing = 0;
+}
+
+bool TimeSeriesDecoder::next(qint64 *time, float *value)
+{
+    if (index >= count || error) {
+        return false;
+    }
+
+    if (index == 0) {
+        lastTime = readBits(64);
+        lastValue = readBits(32);
+    } else {
+        qint64 deltaOfDelta = 0;
+
+        if (readBits(1) == 1) {
+            if (readBits(1) == 0) {
+                deltaOfDelta = readSigned(7);
+            } else if (readBits(1) == 0) {
+                deltaOfDelta = readSigned(9);
+            } else if (readBits(1) == 0) {
+                deltaOfDelta = readSigned(12);
+            } else {
+                deltaOfDelta = readSigned(32);
+            }
+        }
+
+        lastDelta += deltaOfDelta;
+        lastTime += lastDelta;
+
+        if (readBits(1) == 1) {
+            if (readBits(1) == 1) {
+                lastLeading = readBits(5);
+                int length = readBits(5) + 1;
+                lastTrailing = 32 - lastLeading - length;
+            }
+
+            if (lastLeading < 0 || lastTrailing < 0) {
+                error = true;
+                return false;
+            }
+
+            quint32 meaningful = readBits(32 - lastLeading - lastTrailing);
+            lastValue ^= meaningful << lastTrailing;
+        }
+    }
+
+    if (error) {
+        return false;
+    }
+
+    *time = lastTime;
+    *value = bitsToFloat(lastValue);
+    index++;
+
+    return true;
+}
+
+quint64 TimeSeriesDecoder::readBits(int bits)
+{
+    quint64 value = 0;
+
+    while (bits > 0) {
+        // A truncated block ends the decoding instead of reading past the data
+        if (position >= bitSize) {
+            error = true;
+            return 0;
+        }
+
+        int used = position % 8;
+        int available = 8 - used;
+        int length = qMin(available, bits);
+        quint8 chunk = (data[position / 8] >> (available - length)) & ((1u << length) - 1);
+
+        value = (value << length) | chunk;
+        bits -= length;
+        position += length;
+    }
+
+    return value;
+}
+
+qint64 TimeSeriesDecoder::readSigned(int bits)
+{
+    qint64 value = readBits(bits);
+
+    if (value & (Q_INT64_C(1) << (bits - 1))) {
+        value -= Q_INT64_C(1) << bits;
+    }
+
+    return value;
+}
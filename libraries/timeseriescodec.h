@@ -0,0 +1,64 @@
+#ifndef TIMESERIESCODEC_H
+#define TIMESERIESCODEC_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+/*
+ * Gorilla compression of (time, value) samples: timestamps as
+ * delta-of-delta, values as the XOR with the previous value. Times are in
+ * seconds and values are 32-bit floats; a sensor sampled at a fixed period
+ * with a slowly moving value costs a few bits per sample.
+ */
+class TimeSeriesEncoder
+{
+public:
+    TimeSeriesEncoder();
+
+    void append(qint64 time, float value);
+    void clear();
+
+    const QByteArray &getData() const;
+    int getCount() const;
+    qint64 getFirstTime() const;
+    qint64 getLastTime() const;
+
+protected:
+    void writeBits(quint64 value, int bits);
+
+    QByteArray data;
+    qint64 bitCount;
+    int count;
+    qint64 firstTime;
+    qint64 lastTime;
+    qint64 lastDelta;
+    quint32 lastValue;
+    int lastLeading;
+    int lastTrailing;
+};
+
+class TimeSeriesDecoder
+{
+public:
+    TimeSeriesDecoder(const uchar *data, qint64 size, int count);
+
+    bool next(qint64 *time, float *value);
+
+protected:
+    quint64 readBits(int bits);
+    qint64 readSigned(int bits);
+
+    const uchar *data;
+    qint64 bitSize;
+    qint64 position;
+    int count;
+    int index;
+    bool error;
+    qint64 lastTime;
+    qint64 lastDelta;
+    quint32 lastValue;
+    int lastLeading;
+    int lastTrailing;
+};
+
+#endif // TIMESERIESCODEC_H
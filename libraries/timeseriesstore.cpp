@@ -0,0 +1,599 @@
+#include "timeseriesstore.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStringList>
+#include <QUrl>
+#include <QtEndian>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const char blockMagic[] = "DXTS";
+static const int blockVersion = 1;
+static const int headerSize = 25; // magic, version, count, first time, last time
+static const int headRecordSize = 12; // time, value
+
+// Maps a block file and checks its header: the encoded samples follow it
+static uchar *mapBlock(QFile &file, int *count)
+{
+    if (!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    qint64 size = file.size();
+    uchar *data = file.map(0, size);
+
+    if (data == nullptr || size < headerSize || memcmp(data, blockMagic, 4) != 0 || data[4] != blockVersion) {
+        qWarning() << "Time series block not readable: " << file.fileName();
+        if (data != nullptr) {
+            file.unmap(data);
+        }
+        return nullptr;
+    }
+
+    *count = qFromLittleEndian<quint32>(data + 5);
+    return data;
+}
+
+// Reads one series in time order, block after block and then its head, for the merge of a scan
+class SeriesCursor
+{
+public:
+    SeriesCursor(const QString &id, qint64 start, qint64 end)
+    {
+        this->id = id;
+        this->start = start;
+        this->end = end;
+        this->time = 0;
+        this->value = 0;
+        this->success = true;
+        this->headRead = false;
+        this->data = nullptr;
+        this->decoder = nullptr;
+    }
+
+    ~SeriesCursor()
+    {
+        closeBlock();
+    }
+
+    bool next()
+    {
+        forever {
+            if (decoder != nullptr) {
+                while (decoder->next(&time, &value) && time <= end) {
+                    if (time >= start) {
+                        return true;
+                    }
+                }
+                closeBlock();
+            }
+
+            if (!fileNames.isEmpty()) {
+                int count;
+                file.setFileName(fileNames.takeFirst());
+                data = mapBlock(file, &count);
+
+                if (data == nullptr) {
+                    file.close();
+                    success = false;
+                } else {
+                    decoder = new TimeSeriesDecoder(data + headerSize, file.size() - headerSize, count);
+                }
+            } else if (!headRead) {
+                headRead = true;
+                decoder = new TimeSeriesDecoder((const uchar *) head.getData().constData(),
+                                                head.getData().size(), head.getCount());
+            } else {
+                return false;
+            }
+        }
+    }
+
+    QString id;
+    QStringList fileNames;
+    TimeSeriesEncoder head;
+    qint64 time;
+    float value;
+    bool success;
+
+private:
+    Q_DISABLE_COPY(SeriesCursor)
+
+    void closeBlock()
+    {
+        delete decoder;
+        decoder = nullptr;
+
+        if (data != nullptr) {
+            file.unmap(data);
+            file.close();
+            data = nullptr;
+        }
+    }
+
+    qint64 start;
+    qint64 end;
+    bool headRead;
+    QFile file;
+    uchar *data;
+    TimeSeriesDecoder *decoder;
+};
+
+TimeSeriesStore::TimeSeriesStore()
+{
+    blockSize = 1024;
+    appended = 0;
+}
+
+TimeSeriesStore& TimeSeriesStore::store()
+{
+    static TimeSeriesStore instance;
+    return instance;
+}
+
+bool TimeSeriesStore::open(const QString &path)
+{
+    QMutexLocker locker(&mutex);
+    QDir directory(path);
+
+    if (!directory.exists() && !directory.mkpath(".")) {
+        qCritical() << "Time series directory not created: " << path;
+        return false;
+    }
+
+    this->path = directory.absolutePath();
+
+    foreach (const QString &kind, directory.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        QDir kindDirectory(directory.filePath(kind));
+
+        foreach (const QString &series, kindDirectory.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            loadSeries(kind, kindDirectory.filePath(series));
+        }
+    }
+
+    qDebug() << "Time series store opened with" << seriesList.size() << "series";
+    return true;
+}
+
+bool TimeSeriesStore::isOpen()
+{
+    QMutexLocker locker(&mutex);
+    return !path.isEmpty();
+}
+
+bool TimeSeriesStore::loadSeries(const QString &kind, const QString &directory)
+{
+    QDir dir(directory);
+    Series *series = new Series();
+    series->kind = kind;
+    series->id = decodeName(dir.dirName());
+    series->path = directory;
+
+    // Sealed blocks are named after their time range: <first time>-<last time>.blk
+    foreach (const QFileInfo &info, dir.entryInfoList(QStringList() << "*-*.blk", QDir::Files, QDir::Name)) {
+        QStringList times = info.completeBaseName().split('-');
+        Block block;
+        bool firstValid;
+        bool lastValid;
+
+        block.fileName = info.absoluteFilePath();
+        block.firstTime = times.value(0).toLongLong(&firstValid);
+        block.lastTime = times.value(1).toLongLong(&lastValid);
+        block.size = info.size();
+        block.count = 0;
+
+        if (!firstValid || !lastValid || times.size() != 2) {
+            qWarning() << "Time series block ignored: " << block.fileName;
+            continue;
+        }
+
+        QFile file(block.fileName);
+        if (file.open(QIODevice::ReadOnly)) {
+            QByteArray header = file.read(headerSize);
+            if (header.size() == headerSize) {
+                block.count = qFromLittleEndian<quint32>((const uchar *) header.constData() + 5);
+            }
+        }
+
+        series->blocks.append(block);
+    }
+
+    std::sort(series->blocks.begin(), series->blocks.end(), [](const Block &a, const Block &b) {
+        return a.firstTime < b.firstTime;
+    });
+
+    QString logName = dir.filePath("head.log");
+    QString legacyName = dir.filePath("head.blk");
+
+    // The head used to be rewritten whole to head.blk: it moves to the log once
+    if (QFile::exists(legacyName)) {
+        QList<Sample> samples;
+
+        readBlock(legacyName, LLONG_MIN, LLONG_MAX, [&samples](qint64 time, float value) {
+            samples.append(Sample(time, value));
+        });
+
+        if (QFile::exists(logName) || appendHead(logName, samples)) {
+            QFile::remove(legacyName);
+        }
+    }
+
+    // The head is replayed, except the samples already sealed before a crash
+    qint64 sealedTime = series->blocks.isEmpty() ? LLONG_MIN : series->blocks.last().lastTime;
+    TimeSeriesEncoder &head = series->head;
+
+    readHead(logName, [sealedTime, &head](qint64 time, float value) {
+        if (time > sealedTime) {
+            head.append(time, value);
+        }
+    });
+
+    seriesList.insert(kind + "/" + series->id, series);
+    return true;
+}
+
+bool TimeSeriesStore::append(const QString &kind, const QString &id, const QList<Sample> &samples, QList<Sample> *stored)
+{
+    QMutexLocker locker(&mutex);
+
+    if (path.isEmpty()) {
+        return false;
+    }
+
+    Series *series = getSeries(kind, id, true);
+    if (series == nullptr) {
+        return false;
+    }
+
+    TimeSeriesEncoder &head = series->head;
+    QString logName = QDir(series->path).filePath("head.log");
+    QList<Sample> unlogged;
+    bool success = true;
+
+    foreach (const Sample &sample, samples) {
+        qint64 lastTime = head.getCount() > 0 ? head.getLastTime()
+                          : (series->blocks.isEmpty() ? LLONG_MIN : series->blocks.last().lastTime);
+
+        // Blocks are ordered by time: a late sample cannot be inserted any more,
+        // and a batch saved again after a failure is not stored twice
+        if (sample.first <= lastTime) {
+            qWarning() << "Time series sample out of order ignored: " << kind << id << sample.first;
+            continue;
+        }
+
+        head.append(sample.first, sample.second);
+        unlogged.append(sample);
+        appended++;
+
+        if (stored != nullptr) {
+            stored->append(sample);
+        }
+
+        if (head.getCount() < blockSize) {
+            continue;
+        }
+
+        // The sealed samples are in their block: the log starts again
+        if (seal(series)) {
+            unlogged.clear();
+            QFile::remove(logName);
+        } else {
+            success = false;
+        }
+    }
+
+    if (unlogged.isEmpty()) {
+        return success;
+    }
+
+    return appendHead(logName, unlogged) && success;
+}
+
+bool TimeSeriesStore::seal(Series *series)
+{
+    TimeSeriesEncoder &head = series->head;
+    Block block;
+
+    block.firstTime = head.getFirstTime();
+    block.lastTime = head.getLastTime();
+    block.count = head.getCount();
+    block.size = headerSize + head.getData().size();
+    block.fileName = QDir(series->path).filePath(QString::number(block.firstTime) + "-"
+                                                 + QString::number(block.lastTime) + ".blk");
+
+    if (!writeBlock(block.fileName, head)) {
+        return false;
+    }
+
+    series->blocks.append(block);
+    head.clear();
+
+    return true;
+}
+
+bool TimeSeriesStore::writeBlock(const QString &fileName, const TimeSeriesEncoder &encoder)
+{
+    QByteArray header(headerSize, '\0');
+    uchar *data = (uchar *) header.data();
+
+    memcpy(data, blockMagic, 4);
+    data[4] = blockVersion;
+    qToLittleEndian<quint32>(encoder.getCount(), data + 5);
+    qToLittleEndian<qint64>(encoder.getFirstTime(), data + 9);
+    qToLittleEndian<qint64>(encoder.getLastTime(), data + 17);
+
+    // The file is replaced atomically: a crash leaves the previous version
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "Time series block not written: " << fileName << file.errorString();
+        return false;
+    }
+
+    file.write(header);
+    file.write(encoder.getData());
+
+    if (!file.commit()) {
+        qCritical() << "Time series block not written: " << fileName << file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+bool TimeSeriesStore::readBlock(const QString &fileName, qint64 start, qint64 end, std::function<void(qint64, float)> callback)
+{
+    QFile file(fileName);
+    int count;
+    uchar *data = mapBlock(file, &count);
+
+    if (data == nullptr) {
+        return false;
+    }
+
+    TimeSeriesDecoder decoder(data + headerSize, file.size() - headerSize, count);
+    qint64 time;
+    float value;
+
+    while (decoder.next(&time, &value) && time <= end) {
+        if (time >= start) {
+            callback(time, value);
+        }
+    }
+
+    file.unmap(data);
+    return true;
+}
+
+bool TimeSeriesStore::appendHead(const QString &fileName, const QList<Sample> &samples)
+{
+    QByteArray records(samples.size() * headRecordSize, '\0');
+    uchar *data = (uchar *) records.data();
+
+    foreach (const Sample &sample, samples) {
+        quint32 bits;
+        memcpy(&bits, &sample.second, sizeof(bits));
+
+        qToLittleEndian<qint64>(sample.first, data);
+        qToLittleEndian<quint32>(bits, data + 8);
+        data += headRecordSize;
+    }
+
+    // Appended, not rewritten: one small write and one fsync per batch of a series
+    QFile file(fileName);
+    bool success = file.open(QIODevice::WriteOnly | QIODevice::Append)
+                   && file.write(records) == records.size()
+                   && file.flush();
+
+#ifdef Q_OS_WIN
+    success = success && _commit(file.handle()) == 0;
+#else
+    success = success && fsync(file.handle()) == 0;
+#endif
+
+    if (!success) {
+        qCritical() << "Time series head not written: " << fileName << file.errorString();
+    }
+
+    return success;
+}
+
+bool TimeSeriesStore::readHead(const QString &fileName, std::function<void(qint64, float)> callback)
+{
+    QFile file(fileName);
+
+    if (!file.exists() || !file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    QByteArray records = file.readAll();
+    int count = records.size() / headRecordSize;
+    const uchar *data = (const uchar *) records.constData();
+
+    for (int i = 0; i < count; i++, data += headRecordSize) {
+        quint32 bits = qFromLittleEndian<quint32>(data + 8);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+
+        callback(qFromLittleEndian<qint64>(data), value);
+    }
+
+    // A record cut by a crash is dropped: the next appends stay aligned
+    if (records.size() % headRecordSize != 0) {
+        qWarning() << "Time series head truncated after a torn record: " << fileName;
+        file.resize(count * headRecordSize);
+    }
+
+    return true;
+}
+
+bool TimeSeriesStore::scan(const QString &kind, qint64 start, qint64 end, std::function<void(const QString &, qint64, float)> callback)
+{
+    QList<SeriesCursor *> cursors;
+
+    // Only the block list and a copy of the head (shared data) are taken under the lock
+    mutex.lock();
+    foreach (Series *series, seriesList) {
+        if (series->kind != kind) {
+            continue;
+        }
+
+        SeriesCursor *cursor = new SeriesCursor(series->id, start, end);
+
+        foreach (const Block &block, series->blocks) {
+            if (block.lastTime >= start && block.firstTime <= end) {
+                cursor->fileNames.append(block.fileName);
+            }
+        }
+
+        if (series->head.getCount() > 0 && series->head.getLastTime() >= start && series->head.getFirstTime() <= end) {
+            cursor->head = series->head;
+        }
+
+        cursors.append(cursor);
+    }
+    mutex.unlock();
+
+    // Each series is in time order: a heap on their next sample merges them
+    auto later = [](const SeriesCursor *a, const SeriesCursor *b) {
+        return a->time > b->time;
+    };
+
+    QList<SeriesCursor *> heap;
+    foreach (SeriesCursor *cursor, cursors) {
+        if (cursor->next()) {
+            heap.append(cursor);
+        }
+    }
+    std::make_heap(heap.begin(), heap.end(), later);
+
+    while (!heap.isEmpty()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        SeriesCursor *cursor = heap.last();
+
+        callback(cursor->id, cursor->time, cursor->value);
+
+        if (cursor->next()) {
+            std::push_heap(heap.begin(), heap.end(), later);
+        } else {
+            heap.removeLast();
+        }
+    }
+
+    bool success = true;
+    foreach (SeriesCursor *cursor, cursors) {
+        success = cursor->success && success;
+    }
+
+    qDeleteAll(cursors);
+    return success;
+}
+
+qint64 TimeSeriesStore::getFirstTime(const QString &kind)
+{
+    QMutexLocker locker(&mutex);
+    qint64 result = -1;
+
+    foreach (Series *series, seriesList) {
+        if (series->kind != kind) {
+            continue;
+        }
+
+        qint64 firstTime;
+        if (!series->blocks.isEmpty()) {
+            firstTime = series->blocks.first().firstTime;
+        } else if (series->head.getCount() > 0) {
+            firstTime = series->head.getFirstTime();
+        } else {
+            continue;
+        }
+
+        if (result < 0 || firstTime < result) {
+            result = firstTime;
+        }
+    }
+
+    return result;
+}
+
+TimeSeriesStore::Series *TimeSeriesStore::getSeries(const QString &kind, const QString &id, bool create)
+{
+    QString key = kind + "/" + id;
+
+    if (seriesList.contains(key) || !create) {
+        return seriesList.value(key, nullptr);
+    }
+
+    QDir directory(path);
+    QString seriesPath = directory.filePath(kind + "/" + encodeName(id));
+
+    if (!directory.mkpath(seriesPath)) {
+        qCritical() << "Time series directory not created: " << seriesPath;
+        return nullptr;
+    }
+
+    Series *series = new Series();
+    series->kind = kind;
+    series->id = id;
+    series->path = seriesPath;
+    seriesList.insert(key, series);
+
+    return series;
+}
+
+QJsonObject TimeSeriesStore::getStatistics()
+{
+    QMutexLocker locker(&mutex);
+    QJsonObject result;
+    qint64 samples = 0;
+    qint64 bytes = 0;
+    int blocks = 0;
+
+    foreach (Series *series, seriesList) {
+        foreach (const Block &block, series->blocks) {
+            samples += block.count;
+            bytes += block.size;
+        }
+
+        samples += series->head.getCount();
+        bytes += series->head.getData().size();
+        blocks += series->blocks.size();
+    }
+
+    result.insert("series", seriesList.size());
+    result.insert("blocks", blocks);
+    result.insert("samples", (double) samples);
+    result.insert("bytes", (double) bytes);
+    result.insert("bytes_per_sample", samples > 0 ? (double) bytes / samples : 0.0);
+    result.insert("appended", (double) appended);
+
+    return result;
+}
+
+void TimeSeriesStore::setBlockSize(int value)
+{
+    QMutexLocker locker(&mutex);
+    blockSize = value;
+}
+
+QString TimeSeriesStore::encodeName(const QString &name)
+{
+    return QString::fromLatin1(QUrl::toPercentEncoding(name));
+}
+
+QString TimeSeriesStore::decodeName(const QString &name)
+{
+    return QUrl::fromPercentEncoding(name.toLatin1());
+}
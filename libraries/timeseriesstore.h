@@ -0,0 +1,77 @@
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+#include "timeseriescodec.h"
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+#include <functional>
+
+/*
+ * Append-only store of compressed sensor histories, one directory per kind
+ * ("temperature", ...) and per series (sensor id). The newest samples of a
+ * series are encoded in an in-memory head chunk and appended raw to
+ * head.log; a full head is sealed into an immutable block file named after
+ * its time range, which is memory-mapped when scanned. A scan returns the
+ * samples of all the series of a kind merged in time order.
+ */
+class TimeSeriesStore
+{
+public:
+    typedef QPair<qint64, float> Sample;
+
+    static TimeSeriesStore& store();
+
+    bool open(const QString &path);
+    bool isOpen();
+
+    bool append(const QString &kind, const QString &id, const QList<Sample> &samples, QList<Sample> *stored = nullptr);
+    bool scan(const QString &kind, qint64 start, qint64 end, std::function<void(const QString &, qint64, float)> callback);
+    qint64 getFirstTime(const QString &kind);
+
+    QJsonObject getStatistics();
+    void setBlockSize(int value);
+
+protected:
+    TimeSeriesStore();
+
+    struct Block {
+        QString fileName;
+        qint64 firstTime;
+        qint64 lastTime;
+        qint64 size;
+        int count;
+    };
+
+    struct Series {
+        QString kind;
+        QString id;
+        QString path;
+        QList<Block> blocks;
+        TimeSeriesEncoder head;
+    };
+
+    Series *getSeries(const QString &kind, const QString &id, bool create);
+    bool loadSeries(const QString &kind, const QString &directory);
+    bool writeBlock(const QString &fileName, const TimeSeriesEncoder &encoder);
+    bool seal(Series *series);
+    static bool readBlock(const QString &fileName, qint64 start, qint64 end, std::function<void(qint64, float)> callback);
+    static bool appendHead(const QString &fileName, const QList<Sample> &samples);
+    static bool readHead(const QString &fileName, std::function<void(qint64, float)> callback);
+
+    static QString encodeName(const QString &name);
+    static QString decodeName(const QString &name);
+
+    QString path;
+    QHash<QString, Series*> seriesList;
+    QMutex mutex;
+    int blockSize;
+    qint64 appended;
+};
+
+#endif // TIMESERIESSTORE_H
@@ -1,5 +1,6 @@
 #include "websocketevent.h"
 #include "libraries/authentification.h"
+#include "libraries/modelfeed.h"
 
 #include <QtWebSockets>
 #include <QtCore>
@@ -74,10 +75,227 @@ void WebSocketEvent::enableSsl(QFile &keyFile, QFile &certificateFile, QFile &ch
 
 void WebSocketEvent::sendMessage(QString message)
 {
-    foreach (QWebSocket *client, clients)
-    {
-        client->sendTextMessage(message);
+    QList<QWebSocket *> slowClients;
+    int size = message.toUtf8().size();
+
+    // plain text messages are only for clients not using topics
+    QHash<QWebSocket *, Client>::iterator it;
+    for (it = peers.begin(); it != peers.end(); ++it) {
+        if (!it.value().subscribed && !enqueue(it.value(), message, size)) {
+            slowClients << it.key();
+        }
+    }
+
+    foreach (QWebSocket *socket, slowClients) {
+        dropClient(socket);
+    }
+}
+
+void WebSocketEvent::publish(QString topic, QJsonObject message)
+{
+    QString text;
+    int size = 0;
+    QString key;
+    QList<QWebSocket *> slowClients;
+
+    // a newer value for the same model replaces the queued one; heat and cool
+    // setpoints share their topic, the field keeps them apart
+    if (message.contains("id")) {
+        key = topic + ":" + message.value("id").toString();
+
+        if (message.contains("setpoint")) {
+            key += ":" + message.value("setpoint").toString();
+        }
+    } else if (topic.endsWith(".list")) {
+        key = topic;
+    }
+
+    QHash<QWebSocket *, Client>::iterator it;
+    for (it = peers.begin(); it != peers.end(); ++it) {
+        if (!it.value().subscribed || !ModelFeed::matchTopic(it.value().topics, topic)) {
+            continue;
+        }
+
+        // serialize once, only if someone listens
+        if (text.isEmpty()) {
+            QByteArray json = QJsonDocument(message).toJson(QJsonDocument::Compact);
+            text = QString::fromUtf8(json);
+            size = json.size();
+        }
+
+        if (!enqueue(it.value(), text, size, key)) {
+            slowClients << it.key();
+        }
+    }
+
+    foreach (QWebSocket *socket, slowClients) {
+        dropClient(socket);
+    }
+}
+
+QJsonObject WebSocketEvent::getMetrics() const
+{
+    QJsonObject result;
+    int subscribed = 0;
+    int queueDepth = 0;
+    qint64 queuedBytes = 0;
+    qint64 inFlightBytes = 0;
+
+    foreach (const Client &client, peers) {
+        if (client.subscribed) {
+            subscribed++;
+        }
+        queueDepth += client.queue.size();
+        queuedBytes += client.queuedBytes;
+        inFlightBytes += client.inFlightBytes;
+    }
+
+    result.insert("clients", peers.size());
+    result.insert("subscribed_clients", subscribed);
+    result.insert("queue_depth", queueDepth);
+    result.insert("queued_bytes", queuedBytes);
+    result.insert("in_flight_bytes", inFlightBytes);
+    result.insert("messages_sent", messagesSent);
+    result.insert("bytes_sent", bytesSent);
+    result.insert("messages_coalesced", messagesCoalesced);
+    result.insert("clients_downgraded", clientsDowngraded);
+    result.insert("clients_dropped", clientsDropped);
+
+    return result;
+}
+
+void WebSocketEvent::setMaxQueuedBytes(qint64 value)
+{
+    maxQueuedBytes = value;
+}
+
+void WebSocketEvent::setMaxInFlightBytes(qint64 value)
+{
+    maxInFlightBytes = value;
+}
+
+bool WebSocketEvent::enqueue(Client &client, const QString &message, int size, const QString &key)
+{
+    // sizes in utf-8 bytes, like the in flight ones: both limits compare the same unit
+    if (!key.isEmpty() && client.pending.contains(key)) {
+        int index = client.pending.value(key);
+        client.queuedBytes += size - client.sizes.at(index);
+        client.queue[index] = message;
+        client.sizes[index] = size;
+        messagesCoalesced++;
+    } else {
+        if (!key.isEmpty()) {
+            client.pending.insert(key, client.queue.size());
+        }
+        client.queue.append(message);
+        client.sizes.append(size);
+        client.queuedBytes += size;
     }
+
+    scheduleFlush();
+
+    if (client.queuedBytes <= maxQueuedBytes) {
+        return true;
+    }
+
+    // the client did not catch up since the last downgrade: give up on it
+    if (client.downgraded) {
+        return false;
+    }
+
+    // downgrade: forget the backlog, subscribed clients refetch their state
+    clearQueue(client);
+    client.downgraded = true;
+    clientsDowngraded++;
+
+    if (client.subscribed) {
+        QString resync = QStringLiteral("{\"topic\":\"resync\"}");
+        enqueue(client, resync, resync.size(), "resync");
+    }
+
+    return true;
+}
+
+void WebSocketEvent::clearQueue(Client &client)
+{
+    client.queue.clear();
+    client.sizes.clear();
+    client.pending.clear();
+    client.queuedBytes = 0;
+}
+
+void WebSocketEvent::scheduleFlush()
+{
+    if (!flushScheduled) {
+        flushScheduled = true;
+        QTimer::singleShot(0, this, SLOT(flushQueues()));
+    }
+}
+
+void WebSocketEvent::flushQueues()
+{
+    flushScheduled = false;
+
+    QHash<QWebSocket *, Client>::iterator it;
+    for (it = peers.begin(); it != peers.end(); ++it) {
+        Client &client = it.value();
+        QWebSocket *socket = it.key();
+
+        // backpressure: wait for the socket to drain, updates keep coalescing
+        if (client.queue.isEmpty() || client.inFlightBytes >= maxInFlightBytes) {
+            continue;
+        }
+
+        qint64 sent = 0;
+        if (client.subscribed) {
+            // a whole tick of deltas goes out as one frame
+            if (client.queue.size() == 1) {
+                sent = socket->sendTextMessage(client.queue.first());
+            } else {
+                sent = socket->sendTextMessage("[" + client.queue.join(",") + "]");
+            }
+        } else {
+            foreach (const QString &message, client.queue) {
+                sent += socket->sendTextMessage(message);
+            }
+        }
+
+        messagesSent += client.queue.size();
+        bytesSent += sent;
+        client.inFlightBytes += sent;
+        clearQueue(client);
+    }
+}
+
+void WebSocketEvent::socketBytesWritten(qint64 bytes)
+{
+    QWebSocket *socket = qobject_cast<QWebSocket *>(sender());
+
+    if (!peers.contains(socket)) {
+        return;
+    }
+
+    Client &client = peers[socket];
+    client.inFlightBytes = qMax(Q_INT64_C(0), client.inFlightBytes - bytes);
+
+    if (client.inFlightBytes == 0) {
+        client.downgraded = false;
+    }
+
+    if (!client.queue.isEmpty()) {
+        scheduleFlush();
+    }
+}
+
+void WebSocketEvent::dropClient(QWebSocket *socket)
+{
+    qWarning() << "websocket client too slow, dropped:" << getIdentifier(socket);
+
+    clientsDropped++;
+    clients.removeAll(socket);
+    peers.remove(socket);
+    socket->abort();
+    socket->deleteLater();
 }
 
 void WebSocketEvent::onError(QWebSocketProtocol::CloseCode closeCode)
@@ -105,17 +323,58 @@ void WebSocketEvent::onNewConnection()
 
     connect(socket, &QWebSocket::textMessageReceived, this, &WebSocketEvent::processMessage);
     connect(socket, &QWebSocket::disconnected, this, &WebSocketEvent::socketDisconnected);
+    connect(socket, &QWebSocket::bytesWritten, this, &WebSocketEvent::socketBytesWritten);
 
     clients << socket;
+    peers.insert(socket, Client());
 }
 
 void WebSocketEvent::processMessage(const QString &message)
 {
     QWebSocket *pSender = qobject_cast<QWebSocket *>(sender());
 
+    if (processSubscription(pSender, message)) {
+        return;
+    }
+
     emit newMessage(getIdentifier(pSender), message);
 }
 
+bool WebSocketEvent::processSubscription(QWebSocket *client, const QString &message)
+{
+    // {"subscribe": ["sensor.value", "switch.*"], "unsubscribe": [...]}
+    if (client == nullptr || !message.startsWith('{')) {
+        return false;
+    }
+
+    QJsonObject request = QJsonDocument::fromJson(message.toUtf8()).object();
+    if (!request.contains("subscribe") && !request.contains("unsubscribe")) {
+        return false;
+    }
+
+    if (!peers.contains(client)) {
+        return true;
+    }
+
+    Client &peer = peers[client];
+
+    // queued plain text messages cannot be mixed with json deltas
+    if (!peer.subscribed) {
+        peer.subscribed = true;
+        clearQueue(peer);
+    }
+
+    foreach (const QJsonValue &topic, request.value("subscribe").toArray()) {
+        peer.topics.insert(topic.toString());
+    }
+
+    foreach (const QJsonValue &topic, request.value("unsubscribe").toArray()) {
+        peer.topics.remove(topic.toString());
+    }
+
+    return true;
+}
+
 void WebSocketEvent::onPeerVerifyError(const QSslError &error)
 {
     qWarning() << "Ssl errors occurred: " << error.errorString();
@@ -136,6 +395,7 @@ void WebSocketEvent::socketDisconnected()
     if (client)
     {
         clients.removeAll(client);
+        peers.remove(client);
         client->deleteLater();
     }
 }
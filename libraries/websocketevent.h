@@ -2,7 +2,10 @@
 #define WEBSOCKETEVENT_H
 
 #include <QFile>
+#include <QHash>
+#include <QJsonObject>
 #include <QObject>
+#include <QSet>
 #include <QSslError>
 #include <QWebSocketProtocol>
 #include <QtCore/QList>
@@ -22,6 +25,13 @@ public:
     bool start(quint16 port);
     void enableSsl(QFile &keyFile, QFile &certificateFile, QFile &chainFile);
     void sendMessage(QString message);
+    QJsonObject getMetrics() const;
+
+    void setMaxQueuedBytes(qint64 value);
+    void setMaxInFlightBytes(qint64 value);
+
+public slots:
+    void publish(QString topic, QJsonObject message);
 
 signals:
     void newMessage(QString sender, QString message);
@@ -33,10 +43,41 @@ private slots:
     void onPeerVerifyError(const QSslError &error);
     void onSslErrors(const QList<QSslError> &errors);
     void socketDisconnected();
+    void socketBytesWritten(qint64 bytes);
+    void flushQueues();
 
 private:
+    // Outbound state of a connected client
+    struct Client {
+        QSet<QString> topics;
+        bool subscribed = false;
+        QList<QString> queue;
+        QList<int> sizes; // utf-8 bytes of each queued message, as counted in flight
+        QHash<QString, int> pending; // coalescing key -> index in queue
+        qint64 queuedBytes = 0;
+        qint64 inFlightBytes = 0;
+        bool downgraded = false;
+    };
+
     QWebSocketServer *server = nullptr;
     QList<QWebSocket *> clients;
+    QHash<QWebSocket *, Client> peers;
+    bool flushScheduled = false;
+
+    qint64 maxQueuedBytes = 256 * 1024;
+    qint64 maxInFlightBytes = 64 * 1024;
+
+    qint64 messagesSent = 0;
+    qint64 bytesSent = 0;
+    qint64 messagesCoalesced = 0;
+    int clientsDowngraded = 0;
+    int clientsDropped = 0;
+
+    bool enqueue(Client &client, const QString &message, int size, const QString &key = QString());
+    void clearQueue(Client &client);
+    void scheduleFlush();
+    void dropClient(QWebSocket *socket);
+    bool processSubscription(QWebSocket *client, const QString &message);
 };
 
 #endif // WEBSOCKETEVENT_H
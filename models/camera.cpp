@@ -6,6 +6,7 @@
 #include <QSqlError>
 
 QMap<int, Camera*> Camera::cameraList;
+Event Camera::event;
 
 Camera::Camera()
 {
@@ -24,8 +25,8 @@ int Camera::getId() const
 
 void Camera::update()
 {
-    QSqlQuery query = Database::getQuery();
-    query.prepare("SELECT id, name, url, order_by, visibility FROM camera");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("SELECT id, name, url, order_by, visibility FROM camera");
 
     if(Database::exec(query))
     {
@@ -43,7 +44,7 @@ void Camera::update()
         }
     }
 
-    Database::release();
+    emit Camera::event.dataChanged();
 }
 
 bool Camera::isIdValid(int id)
@@ -73,6 +74,11 @@ QMap<int, Camera*> Camera::getCameraList()
 {
     return cameraList;
 }
+
+Event *Camera::getEvent()
+{
+    return &event;
+}
 QString Camera::getName() const
 {
     return name;
@@ -114,13 +120,14 @@ void Camera::setVisibility(const QString &value)
 
 bool Camera::flush()
 {
-    QSqlQuery query = Database::getQuery();
+    Database::Lease lease;
+    QSqlQuery query;
 
     if (cameraList.contains(id)) {
-        query.prepare("UPDATE camera SET name=?, url=?, order_by=?, visibility=? WHERE id=?");
+        query = lease.prepare("UPDATE camera SET name=?, url=?, order_by=?, visibility=? WHERE id=?");
     } else {
-        query.prepare("INSERT INTO camera (name, url, order_by, visibility) "
-                      "VALUES (?, ?, ?, ?)");
+        query = lease.prepare("INSERT INTO camera (name, url, order_by, visibility) "
+                              "VALUES (?, ?, ?, ?)");
     }
     query.addBindValue(name);
     query.addBindValue(url);
@@ -133,33 +140,27 @@ bool Camera::flush()
 
     if (Database::exec(query)) {
         if (!cameraList.contains(id)) {
-            query.prepare("SELECT id FROM camera WHERE id = LAST_INSERT_ID();");
-            Database::exec(query);
-            query.next();
-            id = query.value("id").toInt();
+            id = query.lastInsertId().toInt();
             cameraList.insert(id, this);
         }
-        Database::release();
+        emit Camera::event.dataChanged();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
 
 bool Camera::remove()
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("DELETE FROM camera WHERE id=?");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("DELETE FROM camera WHERE id=?");
     query.addBindValue(id);
 
     if (Database::exec(query)) {
-        Database::release();
         cameraList.remove(id);
+        emit Camera::event.dataChanged();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
@@ -1,6 +1,8 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
+#include "core/event.h"
+
 #include <QString>
 #include <QMap>
 #include <QJsonObject>
@@ -21,6 +23,7 @@ public:
     static bool isIdValid(int id);
     static Camera *get(int id);
     static QMap<int, Camera*> getCameraList();
+    static Event* getEvent();
 
     QString getName() const;
     void setName(const QString &value);
@@ -42,6 +45,7 @@ protected:
     QString visibility;
 
     static QMap<int, Camera*> cameraList;
+    static Event event;
 };
 
 #endif // CAMERA_H
@@ -25,8 +25,8 @@ QJsonObject Command::toJson() const
 
 void Command::update()
 {
-    QSqlQuery query = Database::getQuery();
-    query.prepare("SELECT id, cmd FROM command ORDER BY id ASC");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("SELECT id, cmd FROM command ORDER BY id ASC");
 
     if(Database::exec(query))
     {
@@ -43,18 +43,18 @@ void Command::update()
         }
     }
 
-    Database::release();
 }
 
 bool Command::flush()
 {
-    QSqlQuery query = Database::getQuery();
+    Database::Lease lease;
+    QSqlQuery query;
 
     if (id > 0) {
-        query.prepare("UPDATE command SET cmd=? WHERE id=?");
+        query = lease.prepare("UPDATE command SET cmd=? WHERE id=?");
     } else {
-        query.prepare("INSERT INTO command (cmd) "
-                      "VALUES (?)");
+        query = lease.prepare("INSERT INTO command (cmd) "
+                              "VALUES (?)");
     }
     query.addBindValue(cmd);
 
@@ -65,15 +65,10 @@ bool Command::flush()
     if (Database::exec(query)) {
 
         if (id < 1) {
-            query.prepare("SELECT id FROM command WHERE id = LAST_INSERT_ID();");
-            Database::exec(query);
-            query.next();
-            id = query.value("id").toInt();
+            id = query.lastInsertId().toInt();
         }
-        Database::release();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
@@ -91,16 +86,13 @@ void Command::addCommand(Command *cmd) {
 
 bool Command::removeCommand(QString cmd)
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("DELETE FROM command WHERE cmd=?");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("DELETE FROM command WHERE cmd=?");
     query.addBindValue(cmd);
 
     if (Database::exec(query)) {
-        Database::release();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
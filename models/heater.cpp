@@ -83,8 +83,8 @@ void Heater::sendCommand()
 
 void Heater::fillFromBdd()
 {
-    QSqlQuery query = Database::getQuery();
-    query.prepare("SELECT id, name, power_on_cmd, power_off_cmd, mode, cool_setpoint, heat_setpoint, sensor FROM heater ORDER BY id ASC");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("SELECT id, name, power_on_cmd, power_off_cmd, mode, cool_setpoint, heat_setpoint, sensor FROM heater ORDER BY id ASC");
 
     if(Database::exec(query))
     {
@@ -108,7 +108,6 @@ void Heater::fillFromBdd()
         }
     }
 
-    Database::release();
 }
 
 float Heater::getHeatSetpoint() const
@@ -287,13 +286,14 @@ void Heater::changeStatus(Heater::Status status)
 
 bool Heater::flush()
 {
-    QSqlQuery query = Database::getQuery();
+    Database::Lease lease;
+    QSqlQuery query;
 
     if (heaterList->contains(id)) {
-        query.prepare("UPDATE heater SET name=?, power_on_cmd=?, power_off_cmd=?, mode=?, cool_setpoint=?, heat_setpoint=?, sensor=? WHERE id=?");
+        query = lease.prepare("UPDATE heater SET name=?, power_on_cmd=?, power_off_cmd=?, mode=?, cool_setpoint=?, heat_setpoint=?, sensor=? WHERE id=?");
     } else {
-        query.prepare("INSERT INTO heater (name, power_on_cmd, power_off_cmd, mode, cool_setpoint, heat_setpoint, sensor) "
-                      "VALUES (?, ?, ?, ?, ?, ?, ?)");
+        query = lease.prepare("INSERT INTO heater (name, power_on_cmd, power_off_cmd, mode, cool_setpoint, heat_setpoint, sensor) "
+                              "VALUES (?, ?, ?, ?, ?, ?, ?)");
     }
     query.addBindValue(name);
     query.addBindValue(powerOnCmd);
@@ -314,27 +314,24 @@ bool Heater::flush()
             heaterList->insert(id, this);
         }
 
-        Database::release();
+        emit Heater::event.dataChanged();
         return true;
     }
 
-    Database::release();
     return false;
 }
 
 bool Heater::remove()
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("DELETE FROM heater WHERE id=?");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("DELETE FROM heater WHERE id=?");
     query.addBindValue(id);
 
     if (Database::exec(query)) {
-        Database::release();
         heaterList->remove(id);
+        emit Heater::event.dataChanged();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
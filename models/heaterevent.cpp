@@ -14,14 +14,13 @@ HeaterEvent::HeaterEvent()
 QHash<int, HeaterEvent> HeaterEvent::getEvents(QDateTime start, QDateTime end)
 {
     QHash<int, HeaterEvent> result;
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("SELECT o.id as id, event_id, start_date, end_date, recurrent_date, heater_id, setpoint "
-                  "FROM schedule_event e "
-                  "INNER JOIN schedule_occurrence o "
-                  "ON  o.event_id = e.id "
-                  "WHERE end_date >= ? AND start_date <= ? "
-                  "ORDER BY start_date");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("SELECT o.id as id, event_id, start_date, end_date, recurrent_date, heater_id, setpoint "
+                                    "FROM schedule_event e "
+                                    "INNER JOIN schedule_occurrence o "
+                                    "ON  o.event_id = e.id "
+                                    "WHERE end_date >= ? AND start_date <= ? "
+                                    "ORDER BY start_date");
     query.addBindValue(start);
     query.addBindValue(end);
 
@@ -42,7 +41,6 @@ QHash<int, HeaterEvent> HeaterEvent::getEvents(QDateTime start, QDateTime end)
         }
     }
 
-    Database::release();
     return result;
 }
 
@@ -72,24 +70,26 @@ QList<HeaterEvent::Action> HeaterEvent::convertToAction(const QHash<int,HeaterEv
 
 bool HeaterEvent::changeEventTime(int id, QTime start, QTime end, bool forAllOccurrences)
 {
-    QSqlQuery query = Database::getQuery();
+    Database::Lease lease;
+    QSqlQuery query;
 
     if (forAllOccurrences) {
-        query.prepare("UPDATE schedule_occurrence SET start_date=concat(date(start_date), ?), end_date=concat(date(end_date), ?) WHERE recurrent_date=? AND event_id=?");
-        query.addBindValue(" " + start.toString("HH:mm:ss"));
-        query.addBindValue(" " + end.toString("HH:mm:ss"));
+        query = lease.prepare("UPDATE schedule_occurrence SET start_date=" + Database::dateWithTime("start_date") + ", "
+                              "end_date=" + Database::dateWithTime("end_date") + " WHERE recurrent_date=? AND event_id=?");
+        query.addBindValue(start.toString("HH:mm:ss"));
+        query.addBindValue(end.toString("HH:mm:ss"));
         query.addBindValue(true);
         query.addBindValue(id);
     } else {
-        query.prepare("UPDATE schedule_occurrence SET start_date=concat(date(start_date), ?), end_date=concat(date(end_date), ?), recurrent_date=? WHERE id=?");
-        query.addBindValue(" " + start.toString("HH:mm:ss"));
-        query.addBindValue(" " + end.toString("HH:mm:ss"));
+        query = lease.prepare("UPDATE schedule_occurrence SET start_date=" + Database::dateWithTime("start_date") + ", "
+                              "end_date=" + Database::dateWithTime("end_date") + ", recurrent_date=? WHERE id=?");
+        query.addBindValue(start.toString("HH:mm:ss"));
+        query.addBindValue(end.toString("HH:mm:ss"));
         query.addBindValue(false);
         query.addBindValue(id);
     }
 
     bool success = Database::exec(query);
-    Database::release();
 
     return success;
 }
@@ -160,10 +160,9 @@ QJsonObject HeaterEvent::toJson() const
 bool HeaterEvent::create(int occurrenceNumber)
 {
     bool success = true;
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("INSERT INTO schedule_event (heater_id, setpoint) "
-                  "VALUES (?, ?)");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("INSERT INTO schedule_event (heater_id, setpoint) "
+                                    "VALUES (?, ?)");
     query.addBindValue(heaterId);
     query.addBindValue(setpoint);
 
@@ -173,8 +172,8 @@ bool HeaterEvent::create(int occurrenceNumber)
         eventId = query.lastInsertId().toInt();
         recurrentDate = (occurrenceNumber > 1) ? true : false;
 
-        query.prepare("INSERT INTO schedule_occurrence (event_id, start_date, end_date, recurrent_date) "
-                      "VALUES (?, ?, ?, ?)");
+        query = lease.prepare("INSERT INTO schedule_occurrence (event_id, start_date, end_date, recurrent_date) "
+                              "VALUES (?, ?, ?, ?)");
 
         QVariantList eventidList;
         QVariantList startDateList;
@@ -199,21 +198,18 @@ bool HeaterEvent::create(int occurrenceNumber)
         success = query.execBatch();
     }
 
-    Database::release();
-
     return success;
 }
 
 HeaterEvent HeaterEvent::getEvent(int occurrenceId)
 {
     HeaterEvent result;
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("SELECT o.id as id, event_id, start_date, end_date, recurrent_date, heater_id, setpoint "
-                  "FROM schedule_event e "
-                  "INNER JOIN schedule_occurrence o "
-                  "ON  o.event_id = e.id "
-                  "WHERE o.id = ?");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("SELECT o.id as id, event_id, start_date, end_date, recurrent_date, heater_id, setpoint "
+                                    "FROM schedule_event e "
+                                    "INNER JOIN schedule_occurrence o "
+                                    "ON  o.event_id = e.id "
+                                    "WHERE o.id = ?");
     query.addBindValue(occurrenceId);
 
     if (Database::exec(query)) {
@@ -229,38 +225,31 @@ HeaterEvent HeaterEvent::getEvent(int occurrenceId)
         }
     }
 
-    Database::release();
     return result;
 }
 
 bool HeaterEvent::removeOne(int occurrenceId)
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("DELETE FROM schedule_occurrence WHERE id=?");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("DELETE FROM schedule_occurrence WHERE id=?");
     query.addBindValue(occurrenceId);
 
     if (Database::exec(query)) {
-        Database::release();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
 
 bool HeaterEvent::removeAll(int eventId)
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("DELETE FROM schedule_event WHERE id=?");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("DELETE FROM schedule_event WHERE id=?");
     query.addBindValue(eventId);
 
     if (Database::exec(query)) {
-        Database::release();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
@@ -46,10 +46,9 @@ bool HeaterIndicator::isValide()
 
 bool HeaterIndicator::insert(QList<HeaterIndicator> heaterIndicatorList)
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("INSERT INTO heater_indicator (heater_id, duration, start_date, end_date) "
-                  "VALUES (?, ?, ?, ?)");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("INSERT INTO heater_indicator (heater_id, duration, start_date, end_date) "
+                                    "VALUES (?, ?, ?, ?)");
 
     QVariantList heaterIdList;
     QVariantList durationList;
@@ -70,23 +69,34 @@ bool HeaterIndicator::insert(QList<HeaterIndicator> heaterIndicatorList)
 
     bool success = query.execBatch();
 
-    Database::release();
-
     return success;
 }
 
 QList<HeaterIndicator> HeaterIndicator::get(QDateTime start, QDateTime end)
 {
     QList<HeaterIndicator> result;
-    QSqlQuery query = Database::getQuery();
 
-    query.prepare("SELECT heater_id, duration, start_date, end_date FROM heater_indicator "
-                  "WHERE start_date >= ? AND start_date <= ? "
-                  "ORDER BY start_date ASC");
+    get(start, end, [&result](const HeaterIndicator &indicator) {
+        result.append(indicator);
+    });
+
+    return result;
+}
+
+bool HeaterIndicator::get(QDateTime start, QDateTime end, std::function<void(const HeaterIndicator &)> callback)
+{
+    Database::Lease lease;
+    // Forward only: rows are read one by one, the driver does not keep the whole result
+    QSqlQuery query = lease.prepare("SELECT heater_id, duration, start_date, end_date FROM heater_indicator "
+                                    "WHERE start_date >= ? AND start_date <= ? "
+                                    "ORDER BY start_date ASC", true);
+
     query.addBindValue(start);
     query.addBindValue(end);
 
-    if(Database::exec(query))
+    bool success = Database::exec(query);
+
+    if(success)
     {
         while(query.next())
         {
@@ -96,12 +106,11 @@ QList<HeaterIndicator> HeaterIndicator::get(QDateTime start, QDateTime end)
             heaterIndic.startDate = query.value(2).toDateTime();
             heaterIndic.endDate = query.value(3).toDateTime();
 
-            result.append(heaterIndic);
+            callback(heaterIndic);
         }
     }
 
-    Database::release();
-    return result;
+    return success;
 }
 int HeaterIndicator::getHeaterId() const
 {
@@ -3,6 +3,8 @@
 
 #include <QDateTime>
 
+#include <functional>
+
 class HeaterIndicator
 {
 public:
@@ -20,6 +22,7 @@ public:
 
     static bool insert(QList<HeaterIndicator> indicatorList);
     static QList<HeaterIndicator> get(QDateTime start, QDateTime end);
+    static bool get(QDateTime start, QDateTime end, std::function<void(const HeaterIndicator &)> callback);
 
 protected:
     int id;
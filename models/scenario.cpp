@@ -7,6 +7,7 @@
 #include <QSqlError>
 
 QMap<QString, Scenario*> Scenario::scenarioList;
+Event Scenario::event;
 
 Scenario::Scenario()
 {
@@ -37,8 +38,8 @@ QString Scenario::getId() const
 
 void Scenario::update()
 {
-    QSqlQuery query = Database::getQuery();
-    query.prepare("SELECT id, name, description, content, status, order_by, hide FROM scenario");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("SELECT id, name, description, content, status, order_by, hide FROM scenario");
 
     if(Database::exec(query))
     {
@@ -58,7 +59,7 @@ void Scenario::update()
         }
     }
 
-    Database::release();
+    emit Scenario::event.dataChanged();
 }
 
 bool Scenario::isIdValid(QString id)
@@ -91,6 +92,11 @@ QMap<QString, Scenario*> Scenario::getScenarioList()
     return scenarioList;
 }
 
+Event *Scenario::getEvent()
+{
+    return &event;
+}
+
 QString Scenario::getName() const
 {
     return name;
@@ -154,13 +160,14 @@ void Scenario::setOrder(int value)
 
 bool Scenario::flush()
 {
-    QSqlQuery query = Database::getQuery();
+    Database::Lease lease;
+    QSqlQuery query;
 
     if (scenarioList.contains(id)) {
-        query.prepare("UPDATE scenario SET name=?, description=?, content=?, status=?, order_by=?, hide=? WHERE id=?");
+        query = lease.prepare("UPDATE scenario SET name=?, description=?, content=?, status=?, order_by=?, hide=? WHERE id=?");
     } else {
-        query.prepare("INSERT INTO scenario (name, description, content, status, order_by, hide, id) "
-                      "VALUES (?, ?, ?, ?, ?, ?, ?)");
+        query = lease.prepare("INSERT INTO scenario (name, description, content, status, order_by, hide, id) "
+                              "VALUES (?, ?, ?, ?, ?, ?, ?)");
     }
     query.addBindValue(name);
     query.addBindValue(description);
@@ -171,31 +178,28 @@ bool Scenario::flush()
     query.addBindValue(id);
 
     if (Database::exec(query)) {
-        Database::release();
 
         if (!scenarioList.contains(id)) {
             scenarioList.insert(id, this);
         }
+        emit Scenario::event.dataChanged();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
 
 bool Scenario::remove()
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("DELETE FROM scenario WHERE id=?");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("DELETE FROM scenario WHERE id=?");
     query.addBindValue(id);
 
     if (Database::exec(query)) {
-        Database::release();
         scenarioList.remove(id);
+        emit Scenario::event.dataChanged();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
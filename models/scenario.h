@@ -1,6 +1,8 @@
 #ifndef Scenario_H
 #define Scenario_H
 
+#include "core/event.h"
+
 #include <QString>
 #include <QMap>
 #include <QJsonObject>
@@ -21,6 +23,7 @@ public:
     static bool isIdValid(QString id);
     static Scenario* get(QString id);
     static QMap<QString, Scenario*> getScenarioList();
+    static Event* getEvent();
 
     QString getName() const;
     void setName(const QString &value);
@@ -51,6 +54,7 @@ protected:
     bool hide;
 
     static QMap<QString, Scenario*> scenarioList;
+    static Event event;
 };
 
 #endif // Scenario_H
@@ -7,6 +7,7 @@
 #include <QSqlError>
 
 QMap<int, Script*> Script::scriptList;
+Event Script::event;
 
 Script::Script()
 {
@@ -25,8 +26,8 @@ int Script::getId() const
 
 void Script::update()
 {
-    QSqlQuery query = Database::getQuery();
-    query.prepare("SELECT id, status, name, description, visibility, content FROM script");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("SELECT id, status, name, description, visibility, content FROM script");
 
     if(Database::exec(query))
     {
@@ -45,7 +46,7 @@ void Script::update()
         }
     }
 
-    Database::release();
+    emit Script::event.dataChanged();
 }
 
 bool Script::isIdValid(int id)
@@ -76,6 +77,11 @@ QMap<int, Script*> Script::getScriptList()
 {
     return scriptList;
 }
+
+Event *Script::getEvent()
+{
+    return &event;
+}
 QString Script::getName() const
 {
     return name;
@@ -127,13 +133,14 @@ void Script::setVisibility(const QString &value)
 
 bool Script::flush()
 {
-    QSqlQuery query = Database::getQuery();
+    Database::Lease lease;
+    QSqlQuery query;
 
     if (scriptList.contains(id)) {
-        query.prepare("UPDATE script SET name=?, description=?, visibility=?, content=?, status=? WHERE id=?");
+        query = lease.prepare("UPDATE script SET name=?, description=?, visibility=?, content=?, status=? WHERE id=?");
     } else {
-        query.prepare("INSERT INTO script (name, description, visibility, content, status) "
-                      "VALUES (?, ?, ?, ?, ?)");
+        query = lease.prepare("INSERT INTO script (name, description, visibility, content, status) "
+                              "VALUES (?, ?, ?, ?, ?)");
     }
     query.addBindValue(name);
     query.addBindValue(description);
@@ -148,33 +155,27 @@ bool Script::flush()
     if (Database::exec(query)) {
 
         if (!scriptList.contains(id)) {
-            query.prepare("SELECT id FROM script WHERE id = LAST_INSERT_ID();");
-            Database::exec(query);
-            query.next();
-            id = query.value("id").toInt();
+            id = query.lastInsertId().toInt();
             scriptList.insert(id, this);
         }
-        Database::release();
+        emit Script::event.dataChanged();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
 
 bool Script::remove()
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("DELETE FROM script WHERE id=?");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("DELETE FROM script WHERE id=?");
     query.addBindValue(id);
 
     if (Database::exec(query)) {
-        Database::release();
         scriptList.remove(id);
+        emit Script::event.dataChanged();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
@@ -1,6 +1,8 @@
 #ifndef SCRIPT_H
 #define SCRIPT_H
 
+#include "core/event.h"
+
 #include <QString>
 #include <QMap>
 #include <QJsonObject>
@@ -21,6 +23,7 @@ public:
     static bool isIdValid(int id);
     static Script *get(int id);
     static QMap<int, Script*> getScriptList();
+    static Event* getEvent();
 
     QString getName() const;
     void setName(const QString &value);
@@ -47,6 +50,7 @@ protected:
     QString content;
 
     static QMap<int, Script*> scriptList;
+    static Event event;
 };
 
 #endif // SCRIPT_H
@@ -1,5 +1,6 @@
 #include "sensor.h"
 #include "core/database.h"
+#include "core/writebehind.h"
 #include "libraries/device.h"
 
 #include <QDebug>
@@ -120,9 +121,9 @@ Sensor *Sensor::get(QString id)
 
 void Sensor::update()
 {
-    QSqlQuery query = Database::getQuery();
-    query.prepare("SELECT id, cmd, name, full_name, category, order_by, visibility, invert_binary, "
-                  "battery_level, version, type FROM sensor");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("SELECT id, cmd, name, full_name, category, order_by, visibility, invert_binary, "
+                                    "battery_level, version, type FROM sensor");
 
     if(Database::exec(query))
     {
@@ -148,7 +149,6 @@ void Sensor::update()
         }
     }
 
-    Database::release();
     emit Sensor::event.dataChanged();
 }
 
@@ -173,16 +173,17 @@ Sensor *Sensor::getSensorByCommand(QString cmd)
 
 bool Sensor::flush()
 {
-    QSqlQuery query = Database::getQuery();
+    Database::Lease lease;
+    QSqlQuery query;
 
     if (sensorList.contains(id)) {
-        query.prepare(
+        query = lease.prepare(
             "UPDATE sensor SET cmd=?, name=?, full_name=?, category=?, order_by=?, visibility=?, "
             "invert_binary=?, battery_level=?, version=?, type=? WHERE id=?");
     } else {
-        query.prepare("INSERT INTO sensor (cmd, name, full_name, category, order_by, visibility, "
-                      "invert_binary, battery_level, version, type, id) "
-                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+        query = lease.prepare("INSERT INTO sensor (cmd, name, full_name, category, order_by, visibility, "
+                              "invert_binary, battery_level, version, type, id) "
+                              "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
     }
 
     query.addBindValue(cmd);
@@ -198,7 +199,6 @@ bool Sensor::flush()
     query.addBindValue(id);
 
     if (Database::exec(query)) {
-        Database::release();
 
         if (!sensorList.contains(id)) {
             sensorList.insert(id, this);
@@ -206,25 +206,21 @@ bool Sensor::flush()
         }
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
 
 bool Sensor::remove()
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("DELETE FROM sensor WHERE id=?");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("DELETE FROM sensor WHERE id=?");
     query.addBindValue(id);
 
     if (Database::exec(query)) {
-        Database::release();
         sensorList.remove(id);
         emit Sensor::event.dataChanged();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
@@ -387,6 +383,10 @@ void Sensor::updateBatteryLevel(int level)
 {
     batteryLevel = level;
     batteryLevelUpdate = QDateTime::currentDateTime();
-    flush();
+
+    // Only the battery level changed: no need to write the whole row now
+    WriteBehind::enqueue("sensor_battery_" + id,
+                         "UPDATE sensor SET battery_level=? WHERE id=?",
+                         QList<QVariant>() << batteryLevel << id);
     emit Sensor::event.valueUpdated(id, "battery", QString::number(batteryLevel));
 }
@@ -24,13 +24,14 @@ Session::Session(QString id)
 
 bool Session::flush()
 {
-    QSqlQuery query = Database::getQuery();
+    Database::Lease lease;
+    QSqlQuery query;
 
     if (sessionList.contains(id)) {
-        query.prepare("UPDATE session SET user=?, password=? WHERE id=?");
+        query = lease.prepare("UPDATE session SET user=?, password=? WHERE id=?");
     } else {
-        query.prepare("INSERT INTO session (user, password, id) "
-                      "VALUES (?, ?, ?)");
+        query = lease.prepare("INSERT INTO session (user, password, id) "
+                              "VALUES (?, ?, ?)");
     }
 
     query.addBindValue(user);
@@ -38,7 +39,6 @@ bool Session::flush()
     query.addBindValue(id);
 
     if (Database::exec(query)) {
-        Database::release();
 
         if (!sessionList.contains(id)) {
             sessionList.insert(id, this);
@@ -46,32 +46,28 @@ bool Session::flush()
 
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
 
 bool Session::remove()
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("DELETE FROM session WHERE id=?");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("DELETE FROM session WHERE id=?");
     query.addBindValue(id);
 
     if (Database::exec(query)) {
-        Database::release();
         sessionList.remove(id);
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
 
 void Session::update()
 {
-    QSqlQuery query = Database::getQuery();
-    query.prepare("SELECT id, user, password FROM session");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("SELECT id, user, password FROM session");
 
     if(Database::exec(query))
     {
@@ -87,7 +83,6 @@ void Session::update()
         }
     }
 
-    Database::release();
 }
 
 Session *Session::get(QString id)
@@ -1,5 +1,6 @@
 #include "setting.h"
 #include "core/database.h"
+#include "core/writebehind.h"
 #include <QSqlQuery>
 #include <QVariant>
 #include <QDebug>
@@ -24,54 +25,39 @@ Setting::Setting(QString id)
 
 bool Setting::flush()
 {
-    QSqlQuery query = Database::getQuery();
+    QList<QVariant> values = QList<QVariant>() << group << value << id;
 
+    // Settings are read from memory: an existing row is written behind, a failure is
+    // reported by the write-behind statistics
     if (settingList.contains(id)) {
-        query.prepare("UPDATE setting SET group1=?, value=? WHERE id=?");
-    } else {
-        query.prepare("INSERT INTO setting (group1, value, id) "
-                      "VALUES (?, ?, ?)");
+        WriteBehind::enqueue("setting_" + id, "UPDATE setting SET group1=?, value=? WHERE id=?", values);
+        return true;
     }
 
-    query.addBindValue(group);
-    query.addBindValue(value);
-    query.addBindValue(id);
-
-    if (Database::exec(query)) {
-        Database::release();
-
-        if (!settingList.contains(id)) {
-            settingList.insert(id, this);
-        }
-
-        return true;
-    } else {
-        Database::release();
+    // A new setting is listed once its row exists
+    if (!WriteBehind::writeNow("setting_" + id, "INSERT INTO setting (group1, value, id) VALUES (?, ?, ?)", values)) {
         return false;
     }
+
+    settingList.insert(id, this);
+    return true;
 }
 
 bool Setting::remove()
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("DELETE FROM setting WHERE id=?");
-    query.addBindValue(id);
-
-    if (Database::exec(query)) {
-        Database::release();
-        settingList.remove(id);
-        return true;
-    } else {
-        Database::release();
+    // After the pending writes of the row, which would bring it back otherwise
+    if (!WriteBehind::writeNow("setting_" + id, "DELETE FROM setting WHERE id=?", QList<QVariant>() << id)) {
         return false;
     }
+
+    settingList.remove(id);
+    return true;
 }
 
 void Setting::update()
 {
-    QSqlQuery query = Database::getQuery();
-    query.prepare("SELECT id, group1, value FROM setting");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("SELECT id, group1, value FROM setting");
 
     if(Database::exec(query))
     {
@@ -87,7 +73,6 @@ void Setting::update()
         }
     }
 
-    Database::release();
     emit Setting::event.dataChanged();
 }
 
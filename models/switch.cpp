@@ -1,5 +1,6 @@
 #include "switch.h"
 #include "core/database.h"
+#include "core/writebehind.h"
 #include "libraries/device.h"
 #include "models/sensor.h"
 #include <QSqlQuery>
@@ -52,14 +53,10 @@ void Switch::updateStatus(QString status)
     this->lastUpdate.prepend(QDateTime::currentDateTime());
     this->lastUpdate.removeLast();
 
-    // Update database
-    QSqlQuery query = Database::getQuery();
-    query.prepare("UPDATE switch SET status=? WHERE id=?");
-    query.addBindValue(status);
-    query.addBindValue(this->id);
-
-    Database::exec(query);
-    Database::release();
+    // Update database, off the event loop
+    WriteBehind::enqueue("switch_status_" + id,
+                         "UPDATE switch SET status=? WHERE id=?",
+                         QList<QVariant>() << status << id);
 }
 
 QString Switch::getId() const
@@ -127,8 +124,8 @@ void Switch::powerOff()
 
 void Switch::update()
 {
-    QSqlQuery query = Database::getQuery();
-    query.prepare("SELECT id, status, name, category, order_by, power_on_cmd, power_off_cmd, sensor, is_visible FROM switch");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("SELECT id, status, name, category, order_by, power_on_cmd, power_off_cmd, sensor, is_visible FROM switch");
 
     if(Database::exec(query))
     {
@@ -152,7 +149,6 @@ void Switch::update()
         }
     }
 
-    Database::release();
     emit Switch::event.dataChanged();
 }
 
@@ -250,13 +246,14 @@ void Switch::setPowerOffCmd(const QString &value)
 
 bool Switch::flush()
 {
-    QSqlQuery query = Database::getQuery();
+    Database::Lease lease;
+    QSqlQuery query;
 
     if (switchList.contains(id)) {
-        query.prepare("UPDATE switch SET name=?, category=?, order_by=?, power_on_cmd=?, power_off_cmd=?, status=?, sensor=?, is_visible=? WHERE id=?");
+        query = lease.prepare("UPDATE switch SET name=?, category=?, order_by=?, power_on_cmd=?, power_off_cmd=?, status=?, sensor=?, is_visible=? WHERE id=?");
     } else {
-        query.prepare("INSERT INTO switch (name, category, order_by, power_on_cmd, power_off_cmd, status, sensor, is_visible, id) "
-                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+        query = lease.prepare("INSERT INTO switch (name, category, order_by, power_on_cmd, power_off_cmd, status, sensor, is_visible, id) "
+                              "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
     }
     query.addBindValue(name);
     query.addBindValue(category);
@@ -269,7 +266,6 @@ bool Switch::flush()
     query.addBindValue(id);
 
     if (Database::exec(query)) {
-        Database::release();
 
         if (!switchList.contains(id)) {
             switchList.insert(id, this);
@@ -277,26 +273,22 @@ bool Switch::flush()
         }
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
 
 bool Switch::remove()
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("DELETE FROM switch WHERE id=?");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("DELETE FROM switch WHERE id=?");
     query.addBindValue(id);
 
     if (Database::exec(query)) {
-        Database::release();
 
         switchList.remove(id);
         emit Switch::event.dataChanged();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
@@ -1,11 +1,19 @@
 #include "temperature.h"
+#include "temperaturerollup.h"
 #include "core/database.h"
+#include "libraries/timeseriesstore.h"
 
+#include <QHash>
+#include <QSqlError>
 #include <QSqlQuery>
 #include <QVariant>
 #include <QVariantList>
 #include <QDebug>
 
+#include <climits>
+
+bool Temperature::timeSeries = false;
+
 Temperature::Temperature(QString id)
 {
     this->id = id;
@@ -19,30 +27,165 @@ Temperature::Temperature(QString id, float temperature)
     this->temp = temperature;
 }
 
+Temperature::Temperature(QString id, QDateTime date, float temperature)
+{
+    this->id = id;
+    this->date = date;
+    this->temp = temperature;
+}
+
 bool Temperature::save(QList<Temperature> tempList)
 {
-    QSqlQuery query = Database::getQuery();
+    if (!timeSeries) {
+        return saveToDatabase(tempList);
+    }
+
+    // Samples go to the compressed store, their rollups stay in the database
+    QHash<QString, QList<TimeSeriesStore::Sample> > samples;
+    foreach (const Temperature &temp, tempList) {
+        samples[temp.id].append(TimeSeriesStore::Sample(temp.date.toMSecsSinceEpoch() / 1000, temp.temp));
+    }
 
-    query.prepare("INSERT INTO temperature (id, date, temperature) "
-                  "VALUES (?, ?, ?)");
+    QHash<QString, QList<TimeSeriesStore::Sample> > appended;
+    bool success = true;
+
+    foreach (const QString &id, samples.keys()) {
+        success = TimeSeriesStore::store().append("temperature", id, samples.value(id), &appended[id]) && success;
+    }
+
+    Database::Lease lease;
+    QSqlDatabase db = lease.database();
+    db.transaction();
+
+    // The rollups follow the store from the last sample rolled up per sensor, saved with them:
+    // a batch saved again is not counted twice, and the samples of a batch whose rollups failed
+    // are rolled up with the next one
+    QHash<QString, qint64> marks;
+    QSqlQuery query = lease.query();
+
+    if (!query.exec("SELECT id, last_time FROM temperature_rollup_mark")) {
+        qCritical() << "Temperature rollup marks not read: " << query.lastError();
+        db.rollback();
+        return false;
+    }
+
+    while (query.next()) {
+        marks.insert(query.value(0).toString(), query.value(1).toLongLong());
+    }
+
+    QList<Temperature> stored;
+    qint64 start = LLONG_MAX;
+    qint64 end = LLONG_MIN;
+
+    foreach (const QString &id, samples.keys()) {
+        // No mark yet: a new sensor, or the first batch since the marks, whose appended samples are new
+        if (!marks.contains(id)) {
+            foreach (const TimeSeriesStore::Sample &sample, appended.value(id)) {
+                stored.append(Temperature(id, QDateTime::fromMSecsSinceEpoch(sample.first * 1000), sample.second));
+            }
+            continue;
+        }
+
+        start = qMin(start, marks.value(id) + 1);
+        foreach (const TimeSeriesStore::Sample &sample, samples.value(id)) {
+            end = qMax(end, sample.first);
+        }
+    }
+
+    if (start <= end) {
+        bool scanned = TimeSeriesStore::store().scan("temperature", start, end,
+                                                     [&marks, &samples, &stored](const QString &id, qint64 time, float value) {
+            if (samples.contains(id) && marks.contains(id) && time > marks.value(id)) {
+                stored.append(Temperature(id, QDateTime::fromMSecsSinceEpoch(time * 1000), value));
+            }
+        });
+
+        if (!scanned) {
+            qCritical() << "Temperature rollups not saved: time series not readable";
+            db.rollback();
+            return false;
+        }
+    }
+
+    foreach (const Temperature &temp, stored) {
+        qint64 time = temp.date.toMSecsSinceEpoch() / 1000;
+        marks.insert(temp.id, marks.contains(temp.id) ? qMax(marks.value(temp.id), time) : time);
+    }
+
+    QString sql = "INSERT INTO temperature_rollup_mark (id, last_time) VALUES (?, ?) ";
+    if (Database::isSqlite()) {
+        sql += "ON CONFLICT (id) DO UPDATE SET last_time=excluded.last_time";
+    } else {
+        sql += "ON DUPLICATE KEY UPDATE last_time=VALUES(last_time)";
+    }
 
     QVariantList idList;
-    QVariantList dateList;
-    QVariantList tempertureList;
+    QVariantList timeList;
 
-    foreach(const Temperature &temp, tempList) {
-        idList << temp.id;
-        dateList << temp.date;
-        tempertureList << temp.temp;
+    foreach (const QString &id, samples.keys()) {
+        if (marks.contains(id)) {
+            idList << id;
+            timeList << marks.value(id);
+        }
     }
 
+    query = lease.prepare(sql);
     query.addBindValue(idList);
-    query.addBindValue(dateList);
-    query.addBindValue(tempertureList);
+    query.addBindValue(timeList);
+
+    if (!TemperatureRollup::save(stored) || (!idList.isEmpty() && !query.execBatch())) {
+        qCritical() << "Temperature rollups not saved: " << query.lastError();
+        db.rollback();
+        return false;
+    }
 
-    bool success = query.execBatch();
+    return db.commit() && success;
+}
+
+bool Temperature::saveToDatabase(const QList<Temperature> &tempList)
+{
+    // A sample stored already (unique id and date) is ignored: the batch of a journal
+    // replayed after a crash between the commit and the truncation is not written twice
+    QString sql = "INSERT INTO temperature (id, date, temperature) VALUES (?, ?, ?) ON CONFLICT DO NOTHING";
+    if (!Database::isSqlite()) {
+        sql = "INSERT IGNORE INTO temperature (id, date, temperature) VALUES (?, ?, ?)";
+    }
 
-    Database::release();
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare(sql);
+    QList<Temperature> inserted;
+
+    // Samples and their hourly/daily rollups are written together, or not at all
+    QSqlDatabase db = lease.database();
+    db.transaction();
+
+    // Row by row, as execBatch does with the SQLite and MySQL drivers: the rows
+    // actually inserted are known, and only they are added to the rollups
+    bool success = true;
+
+    foreach (const Temperature &temp, tempList) {
+        query.addBindValue(temp.id);
+        query.addBindValue(temp.date);
+        query.addBindValue(temp.temp);
+
+        if (!query.exec()) {
+            success = false;
+            break;
+        }
+
+        if (query.numRowsAffected() > 0) {
+            inserted.append(temp);
+        }
+    }
+
+    success = success && TemperatureRollup::save(inserted);
+
+    if (success) {
+        success = db.commit();
+    } else {
+        qCritical() << "Temperatures not saved: " << query.lastError();
+        db.rollback();
+    }
 
     return success;
 }
@@ -50,28 +193,80 @@ bool Temperature::save(QList<Temperature> tempList)
 QList<Temperature> Temperature::get(QDateTime start, QDateTime end)
 {
     QList<Temperature> result;
-    QSqlQuery query = Database::getQuery();
 
-    query.prepare("SELECT id, date, temperature FROM temperature "
-                  "WHERE date >= ? AND date <= ? "
-                  "ORDER BY date ASC");
+    get(start, end, [&result](const Temperature &temp) {
+        result.append(temp);
+    });
+
+    return result;
+}
+
+bool Temperature::get(QDateTime start, QDateTime end, std::function<void(const Temperature &)> callback)
+{
+    if (!timeSeries) {
+        return getFromDatabase(start, end, callback);
+    }
+
+    // The history older than the store is still read from the database
+    qint64 firstTime = TimeSeriesStore::store().getFirstTime("temperature");
+    bool success = true;
+
+    if (firstTime < 0) {
+        return getFromDatabase(start, end, callback);
+    }
+
+    if (start.toMSecsSinceEpoch() / 1000 < firstTime) {
+        QDateTime storeStart = QDateTime::fromMSecsSinceEpoch(firstTime * 1000);
+        success = getFromDatabase(start, qMin(end, storeStart.addSecs(-1)), callback);
+    }
+
+    Temperature temp("");
+
+    success = TimeSeriesStore::store().scan("temperature", start.toMSecsSinceEpoch() / 1000, end.toMSecsSinceEpoch() / 1000,
+                                            [&temp, &callback](const QString &id, qint64 time, float value) {
+        temp.id = id;
+        temp.date = QDateTime::fromMSecsSinceEpoch(time * 1000);
+        temp.temp = value;
+
+        callback(temp);
+    }) && success;
+
+    return success;
+}
+
+void Temperature::setTimeSeries(bool enabled)
+{
+    timeSeries = enabled;
+}
+
+bool Temperature::getFromDatabase(QDateTime start, QDateTime end, std::function<void(const Temperature &)> callback)
+{
+    Database::Lease lease;
+    // Forward only: rows are read one by one, the driver does not keep the whole result
+    QSqlQuery query = lease.prepare("SELECT id, date, temperature FROM temperature "
+                                    "WHERE date >= ? AND date <= ? "
+                                    "ORDER BY date ASC", true);
+
     query.addBindValue(start);
     query.addBindValue(end);
 
-    if(Database::exec(query))
+    bool success = Database::exec(query);
+
+    if (success)
     {
+        Temperature temp("");
+
         while(query.next())
         {
-            Temperature temp(query.value(0).toString());
+            temp.id = query.value(0).toString();
             temp.date = query.value(1).toDateTime();
             temp.temp = query.value(2).toFloat();
 
-            result.append(temp);
+            callback(temp);
         }
     }
 
-    Database::release();
-    return result;
+    return success;
 }
 
 QString Temperature::getId() const
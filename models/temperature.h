@@ -4,11 +4,14 @@
 #include <QDateTime>
 #include <QString>
 
+#include <functional>
+
 class Temperature
 {
 public:
     Temperature(QString id);
     Temperature(QString id, float temperature);
+    Temperature(QString id, QDateTime date, float temperature);
 
     QDateTime getDate() const;
     float getTemperature() const;
@@ -17,8 +20,16 @@ public:
     static bool save(QList<Temperature> tempList);
     static Temperature currentTemp(bool *success, int cacheInSeconds = 30);
     static QList<Temperature> get(QDateTime start, QDateTime end);
+    static bool get(QDateTime start, QDateTime end, std::function<void(const Temperature &)> callback);
+
+    static void setTimeSeries(bool enabled);
 
 protected:
+    static bool saveToDatabase(const QList<Temperature> &tempList);
+    static bool getFromDatabase(QDateTime start, QDateTime end, std::function<void(const Temperature &)> callback);
+
+    static bool timeSeries;
+
     QString id;
     QDateTime date;
     float temp;
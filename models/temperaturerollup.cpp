@@ -0,0 +1,327 @@
+#include "temperaturerollup.h"
+#include "core/database.h"
+
+#include <QMap>
+#include <QPair>
+#include <QSqlQuery>
+#include <QVariant>
+#include <QVariantList>
+
+#include <climits>
+
+int TemperatureRollup::maxGap = 15 * 60;
+
+TemperatureRollup::TemperatureRollup()
+{
+    this->min = 0;
+    this->max = 0;
+    this->sum = 0;
+    this->count = 0;
+    this->area = 0;
+    this->duration = 0;
+}
+
+TemperatureRollup::Resolution TemperatureRollup::getResolution(QDateTime start, QDateTime end)
+{
+    qint64 days = start.daysTo(end);
+
+    // A few thousand points per sensor at most: the chart is not wider than that
+    if (days <= 31) {
+        return Raw;
+    } else if (days <= 400) {
+        return Hour;
+    }
+
+    return Day;
+}
+
+TemperatureRollup::Resolution TemperatureRollup::getResolution(const QString &name, Resolution defaultValue)
+{
+    if (name == "raw") {
+        return Raw;
+    } else if (name == "hour") {
+        return Hour;
+    } else if (name == "day") {
+        return Day;
+    }
+
+    return defaultValue;
+}
+
+QDateTime TemperatureRollup::getPeriod(const QDateTime &date, Resolution resolution)
+{
+    // Hours are in UTC: a DST change neither merges two hours nor splits one. Days are the
+    // local days of the charts, kept as the UTC time of their midnight.
+    QDateTime utc = date.toUTC();
+
+    if (resolution == Day) {
+        return QDateTime(date.toLocalTime().date(), QTime(0, 0)).toUTC();
+    } else if (resolution == Hour) {
+        return QDateTime(utc.date(), QTime(utc.time().hour(), 0), Qt::UTC);
+    }
+
+    return date;
+}
+
+QDateTime TemperatureRollup::getPeriodEnd(const QDateTime &period, Resolution resolution)
+{
+    // A local day lasts 23 or 25 hours on a DST change
+    if (resolution == Day) {
+        return QDateTime(period.toLocalTime().date().addDays(1), QTime(0, 0)).toUTC();
+    }
+
+    return period.addSecs(resolution);
+}
+
+QString TemperatureRollup::getTable(Resolution resolution)
+{
+    return resolution == Day ? "temperature_daily" : "temperature_hourly";
+}
+
+bool TemperatureRollup::save(const QList<Temperature> &tempList)
+{
+    QHash<QString, QMap<qint64, float> > series = getSeries(tempList);
+
+    return save(tempList, series, Hour) && save(tempList, series, Day);
+}
+
+QHash<QString, QMap<qint64, float> > TemperatureRollup::getSeries(const QList<Temperature> &tempList)
+{
+    QHash<QString, QMap<qint64, float> > result;
+    QHash<QString, qint64> firstTimes;
+    qint64 start = LLONG_MAX;
+    qint64 end = LLONG_MIN;
+
+    foreach (const Temperature &temp, tempList) {
+        qint64 time = temp.getDate().toMSecsSinceEpoch() / 1000;
+        result[temp.getId()].insert(time, temp.getTemperature());
+    }
+
+    if (result.isEmpty()) {
+        return result;
+    }
+
+    foreach (const QString &id, result.keys()) {
+        qint64 time = result.value(id).firstKey();
+        firstTimes.insert(id, time);
+        start = qMin(start, time);
+        end = qMax(end, time);
+    }
+
+    // The line of a sensor starts at its last sample stored before the batch
+    QHash<QString, QPair<qint64, float> > previous;
+    Temperature::get(QDateTime::fromMSecsSinceEpoch((start - maxGap) * 1000),
+                     QDateTime::fromMSecsSinceEpoch((end - 1) * 1000),
+                     [&firstTimes, &previous](const Temperature &temp) {
+        qint64 time = temp.getDate().toMSecsSinceEpoch() / 1000;
+
+        // In date order: the last one before the first sample of the batch is kept
+        if (firstTimes.contains(temp.getId()) && time < firstTimes.value(temp.getId())) {
+            previous.insert(temp.getId(), QPair<qint64, float>(time, temp.getTemperature()));
+        }
+    });
+
+    foreach (const QString &id, previous.keys()) {
+        result[id].insert(previous.value(id).first, previous.value(id).second);
+    }
+
+    return result;
+}
+
+bool TemperatureRollup::save(const QList<Temperature> &tempList, const QHash<QString, QMap<qint64, float> > &series, Resolution resolution)
+{
+    QMap<QPair<QString, QDateTime>, TemperatureRollup> rollups;
+
+    // The batch is aggregated first: one upsert per sensor and period
+    foreach (const Temperature &temp, tempList) {
+        QPair<QString, QDateTime> key(temp.getId(), getPeriod(temp.getDate(), resolution));
+        bool exists = rollups.contains(key);
+        TemperatureRollup &rollup = rollups[key];
+
+        if (!exists) {
+            rollup.id = key.first;
+            rollup.date = key.second;
+            rollup.min = temp.getTemperature();
+            rollup.max = temp.getTemperature();
+        }
+
+        rollup.min = qMin(rollup.min, temp.getTemperature());
+        rollup.max = qMax(rollup.max, temp.getTemperature());
+        rollup.sum += temp.getTemperature();
+        rollup.count++;
+    }
+
+    // Each line segment between two samples is split at the period boundaries; a longer one is a gap
+    foreach (const QString &id, series.keys()) {
+        const QMap<qint64, float> samples = series.value(id);
+
+        for (auto it = samples.constBegin(); it != samples.constEnd() && it + 1 != samples.constEnd(); ++it) {
+            qint64 startTime = it.key();
+            qint64 endTime = (it + 1).key();
+
+            if (endTime - startTime > maxGap) {
+                continue;
+            }
+
+            double slope = (double) ((it + 1).value() - it.value()) / (endTime - startTime);
+            qint64 from = startTime;
+
+            while (from < endTime) {
+                QDateTime period = getPeriod(QDateTime::fromMSecsSinceEpoch(from * 1000, Qt::UTC), resolution);
+                qint64 to = qMin(endTime, getPeriodEnd(period, resolution).toMSecsSinceEpoch() / 1000);
+                float first = it.value() + slope * (from - startTime);
+                float last = it.value() + slope * (to - startTime);
+
+                QPair<QString, QDateTime> key(id, period);
+                bool exists = rollups.contains(key);
+                TemperatureRollup &rollup = rollups[key];
+
+                // A period crossed by the line without a sample of its own: min and max of the line
+                if (!exists) {
+                    rollup.id = key.first;
+                    rollup.date = key.second;
+                    rollup.min = qMin(first, last);
+                    rollup.max = qMax(first, last);
+                } else if (rollup.count == 0) {
+                    rollup.min = qMin(rollup.min, qMin(first, last));
+                    rollup.max = qMax(rollup.max, qMax(first, last));
+                }
+
+                rollup.area += (first + last) / 2.0 * (to - from);
+                rollup.duration += to - from;
+                from = to;
+            }
+        }
+    }
+
+    if (rollups.isEmpty()) {
+        return true;
+    }
+
+    QString table = getTable(resolution);
+    QString sql = "INSERT INTO " + table + " (id, period, temp_min, temp_max, temp_sum, sample_count, temp_area, duration) "
+                  "VALUES (?, ?, ?, ?, ?, ?, ?, ?) ";
+
+    if (Database::isSqlite()) {
+        sql += "ON CONFLICT (period, id) DO UPDATE SET "
+               "temp_min=MIN(temp_min, excluded.temp_min), temp_max=MAX(temp_max, excluded.temp_max), "
+               "temp_sum=temp_sum+excluded.temp_sum, sample_count=sample_count+excluded.sample_count, "
+               "temp_area=temp_area+excluded.temp_area, duration=duration+excluded.duration";
+    } else {
+        sql += "ON DUPLICATE KEY UPDATE "
+               "temp_min=LEAST(temp_min, VALUES(temp_min)), temp_max=GREATEST(temp_max, VALUES(temp_max)), "
+               "temp_sum=temp_sum+VALUES(temp_sum), sample_count=sample_count+VALUES(sample_count), "
+               "temp_area=temp_area+VALUES(temp_area), duration=duration+VALUES(duration)";
+    }
+
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare(sql);
+
+    QVariantList idList;
+    QVariantList periodList;
+    QVariantList minList;
+    QVariantList maxList;
+    QVariantList sumList;
+    QVariantList countList;
+    QVariantList areaList;
+    QVariantList durationList;
+
+    foreach (const TemperatureRollup &rollup, rollups) {
+        idList << rollup.id;
+        periodList << rollup.date;
+        minList << rollup.min;
+        maxList << rollup.max;
+        sumList << rollup.sum;
+        countList << rollup.count;
+        areaList << rollup.area;
+        durationList << rollup.duration;
+    }
+
+    query.addBindValue(idList);
+    query.addBindValue(periodList);
+    query.addBindValue(minList);
+    query.addBindValue(maxList);
+    query.addBindValue(sumList);
+    query.addBindValue(countList);
+    query.addBindValue(areaList);
+    query.addBindValue(durationList);
+
+    return query.execBatch();
+}
+
+bool TemperatureRollup::get(QDateTime start, QDateTime end, Resolution resolution, std::function<void(const TemperatureRollup &)> callback)
+{
+    Database::Lease lease;
+    // Forward only: rows are read one by one, the driver does not keep the whole result
+    QSqlQuery query = lease.prepare("SELECT id, period, temp_min, temp_max, temp_sum, sample_count, temp_area, duration FROM " + getTable(resolution) + " "
+                                    "WHERE period >= ? AND period <= ? "
+                                    "ORDER BY period ASC", true);
+
+    // The period containing the start date is included
+    query.addBindValue(getPeriod(start, resolution));
+    query.addBindValue(end.toUTC());
+
+    bool success = Database::exec(query);
+
+    if (success)
+    {
+        TemperatureRollup rollup;
+
+        while(query.next())
+        {
+            rollup.id = query.value(0).toString();
+            rollup.date = query.value(1).toDateTime();
+            rollup.date.setTimeSpec(Qt::UTC);
+            rollup.min = query.value(2).toFloat();
+            rollup.max = query.value(3).toFloat();
+            rollup.sum = query.value(4).toDouble();
+            rollup.count = query.value(5).toInt();
+            rollup.area = query.value(6).toDouble();
+            rollup.duration = query.value(7).toDouble();
+
+            callback(rollup);
+        }
+    }
+
+    return success;
+}
+
+void TemperatureRollup::setMaxGap(int seconds)
+{
+    maxGap = seconds;
+}
+
+QString TemperatureRollup::getId() const
+{
+    return id;
+}
+
+QDateTime TemperatureRollup::getDate() const
+{
+    return date;
+}
+
+float TemperatureRollup::getMin() const
+{
+    return min;
+}
+
+float TemperatureRollup::getMax() const
+{
+    return max;
+}
+
+float TemperatureRollup::getMean() const
+{
+    // Periods rolled up before the time weighting, or with a sample and no line: by count
+    if (duration > 0) {
+        return area / duration;
+    }
+
+    return count > 0 ? sum / count : 0;
+}
+
+int TemperatureRollup::getCount() const
+{
+    return count;
+}
@@ -0,0 +1,69 @@
+#ifndef TEMPERATUREROLLUP_H
+#define TEMPERATUREROLLUP_H
+
+#include "temperature.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+#include <functional>
+
+/*
+ * Hourly and daily aggregates (min, max, mean, count) of the temperature
+ * table, per sensor. They are updated with each batch of Temperature::save,
+ * so a long range is read from a few rows per sensor and day. Hours are UTC
+ * hours; days are local days, stored as the UTC time of their midnight, so
+ * the offset of each day is kept. getDate() is the start of the period, in
+ * UTC. The mean is weighted by time: the line between two samples of a
+ * sensor, up to the max gap apart, is integrated over the periods it
+ * crosses, so samples kept at irregular intervals by the deadband filter are
+ * not averaged by count.
+ */
+class TemperatureRollup
+{
+public:
+    enum Resolution {
+        Raw = 0,
+        Hour = 3600,
+        Day = 86400
+    };
+
+    TemperatureRollup();
+
+    QString getId() const;
+    QDateTime getDate() const;
+    float getMin() const;
+    float getMax() const;
+    float getMean() const;
+    int getCount() const;
+
+    static Resolution getResolution(QDateTime start, QDateTime end);
+    static Resolution getResolution(const QString &name, Resolution defaultValue);
+    static QDateTime getPeriod(const QDateTime &date, Resolution resolution);
+    static QDateTime getPeriodEnd(const QDateTime &period, Resolution resolution);
+
+    static bool save(const QList<Temperature> &tempList);
+    static bool get(QDateTime start, QDateTime end, Resolution resolution, std::function<void(const TemperatureRollup &)> callback);
+    static void setMaxGap(int seconds);
+
+protected:
+    static QString getTable(Resolution resolution);
+    static QHash<QString, QMap<qint64, float> > getSeries(const QList<Temperature> &tempList);
+    static bool save(const QList<Temperature> &tempList, const QHash<QString, QMap<qint64, float> > &series, Resolution resolution);
+
+    QString id;
+    QDateTime date;
+    float min;
+    float max;
+    double sum;
+    int count;
+    double area;
+    double duration;
+
+    static int maxGap;
+};
+
+#endif // TEMPERATUREROLLUP_H
@@ -17,8 +17,8 @@ User::User()
 
 void User::fillFromBdd()
 {
-    QSqlQuery query = Database::getQuery();
-    query.prepare("SELECT id, username, password, salt FROM user");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("SELECT id, username, password, salt FROM user");
 
     if(Database::exec(query))
     {
@@ -35,7 +35,6 @@ void User::fillFromBdd()
         }
     }
 
-    Database::release();
 }
 QDateTime User::getLastAttempt() const
 {
@@ -50,13 +49,14 @@ int User::getLoginAttempts() const
 
 bool User::flush()
 {
-    QSqlQuery query = Database::getQuery();
+    Database::Lease lease;
+    QSqlQuery query;
 
     if (id != 0) {
-        query.prepare("UPDATE user SET username=?, password=?, salt=? WHERE id=?");
+        query = lease.prepare("UPDATE user SET username=?, password=?, salt=? WHERE id=?");
     } else {
-        query.prepare("INSERT INTO user (username, password, salt) "
-                      "VALUES (?, ?, ?)");
+        query = lease.prepare("INSERT INTO user (username, password, salt) "
+                              "VALUES (?, ?, ?)");
     }
     query.addBindValue(username);
     query.addBindValue(password);
@@ -72,26 +72,21 @@ bool User::flush()
             userList.insert(username, *this);
         }
 
-        Database::release();
         return true;
     }
 
-    Database::release();
     return false;
 }
 
 bool User::remove()
 {
-    QSqlQuery query = Database::getQuery();
-
-    query.prepare("DELETE FROM user WHERE id=?");
+    Database::Lease lease;
+    QSqlQuery query = lease.prepare("DELETE FROM user WHERE id=?");
     query.addBindValue(id);
 
     if (Database::exec(query)) {
-        Database::release();
         return true;
     } else {
-        Database::release();
         return false;
     }
 }
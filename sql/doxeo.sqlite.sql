@@ -0,0 +1,120 @@
+--
+-- Embedded database (SQLite): same tables and columns as doxeo.sql
+-- Loaded by Database::bootstrap() when the database file is empty
+--
+
+CREATE TABLE IF NOT EXISTS camera (
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  name VARCHAR(50) NOT NULL,
+  url VARCHAR(255) NOT NULL,
+  order_by INTEGER NOT NULL DEFAULT 0,
+  visibility TINYINT(1) NOT NULL DEFAULT 1
+);
+
+CREATE TABLE IF NOT EXISTS command (
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  cmd VARCHAR(100) NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS heater (
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  name VARCHAR(20) NOT NULL,
+  power_on_cmd VARCHAR(150) NOT NULL,
+  power_off_cmd VARCHAR(150) NOT NULL,
+  mode TINYINT(1) NOT NULL,
+  cool_setpoint FLOAT NOT NULL,
+  heat_setpoint FLOAT NOT NULL,
+  sensor VARCHAR(25) NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS heater_indicator (
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  heater_id INTEGER NOT NULL,
+  duration INTEGER NOT NULL,
+  start_date DATETIME NOT NULL,
+  end_date DATETIME NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS scenario (
+  id VARCHAR(25) NOT NULL PRIMARY KEY,
+  name VARCHAR(50) NOT NULL,
+  description VARCHAR(255) NOT NULL DEFAULT '',
+  content TEXT NOT NULL,
+  status VARCHAR(4) NOT NULL,
+  order_by INTEGER NOT NULL DEFAULT 0,
+  hide TINYINT(1) NOT NULL DEFAULT 0
+);
+
+CREATE TABLE IF NOT EXISTS schedule_event (
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  heater_id INTEGER NOT NULL REFERENCES heater (id) ON DELETE CASCADE ON UPDATE CASCADE,
+  setpoint VARCHAR(5) NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS schedule_occurrence (
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  event_id INTEGER NOT NULL REFERENCES schedule_event (id) ON DELETE CASCADE ON UPDATE CASCADE,
+  start_date DATETIME NOT NULL,
+  end_date DATETIME NOT NULL,
+  recurrent_date TINYINT(1) NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS script (
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  name VARCHAR(20) NOT NULL,
+  status VARCHAR(4) NOT NULL,
+  description VARCHAR(50) NOT NULL,
+  visibility TINYINT(1) NOT NULL DEFAULT 1,
+  content TEXT NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS sensor (
+  id VARCHAR(20) NOT NULL PRIMARY KEY,
+  cmd VARCHAR(20) NOT NULL,
+  name VARCHAR(20) NOT NULL,
+  full_name VARCHAR(50) NOT NULL DEFAULT '',
+  category VARCHAR(20) NOT NULL,
+  order_by INTEGER NOT NULL DEFAULT 0,
+  visibility TINYINT(1) NOT NULL DEFAULT 1,
+  invert_binary TINYINT(1) NOT NULL DEFAULT 0,
+  battery_level INTEGER NOT NULL DEFAULT 0,
+  version VARCHAR(20) NOT NULL DEFAULT '',
+  type VARCHAR(20) NOT NULL DEFAULT ''
+);
+
+CREATE TABLE IF NOT EXISTS session (
+  id VARCHAR(100) NOT NULL PRIMARY KEY,
+  user VARCHAR(100) NOT NULL,
+  password VARCHAR(255) NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS setting (
+  id VARCHAR(50) NOT NULL PRIMARY KEY,
+  group1 VARCHAR(50) NOT NULL,
+  value TEXT NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS switch (
+  id VARCHAR(25) NOT NULL PRIMARY KEY,
+  name VARCHAR(20) NOT NULL,
+  category VARCHAR(20) NOT NULL,
+  order_by INTEGER NOT NULL,
+  status VARCHAR(4) NOT NULL,
+  power_on_cmd VARCHAR(150) NOT NULL,
+  power_off_cmd VARCHAR(150) NOT NULL,
+  sensor VARCHAR(25) NOT NULL DEFAULT '',
+  is_visible TINYINT(1) NOT NULL DEFAULT 1
+);
+
+CREATE TABLE IF NOT EXISTS temperature (
+  id VARCHAR(20) NOT NULL,
+  date TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  temperature FLOAT NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS user (
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  username VARCHAR(100) NOT NULL UNIQUE,
+  password VARCHAR(255) NOT NULL,
+  salt VARCHAR(255) DEFAULT NULL
+);
@@ -0,0 +1,15 @@
+include(../tests.pri)
+
+LIBS += -lz
+
+TARGET = tst_compression
+
+# The vendored libraries, compressed as served by the asset cache
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+SOURCES += \
+    tst_compression.cpp \
+    ../../core/compression.cpp
+
+HEADERS += \
+    ../../core/compression.h
@@ -0,0 +1,109 @@
+#include "core/compression.h"
+#include "tests/synthetichistory.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtTest>
+
+#include <ctime>
+
+class TestCompression : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanupTestCase();
+    void benchmarkGzip_data();
+    void benchmarkGzip();
+
+private:
+    static QByteArray temperatureLogs(int days);
+};
+
+void TestCompression::cleanupTestCase()
+{
+    Compression::setLevel(6);
+}
+
+void TestCompression::benchmarkGzip_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<int>("level");
+
+    QList<QPair<QString, QByteArray> > bodies;
+
+    foreach (const QString &asset, QStringList() << "highstock/highstock.js" << "ace/mode-javascript.js") {
+        QFile file(SRCDIR "../../assets/" + asset);
+
+        if (file.open(QIODevice::ReadOnly)) {
+            bodies.append(qMakePair(QFileInfo(asset).fileName(), file.readAll()));
+        }
+    }
+    bodies.append(qMakePair(QString("temperature_logs.js 30 days"), temperatureLogs(30)));
+
+    for (const QPair<QString, QByteArray> &body : bodies) {
+        foreach (int level, QList<int>() << 1 << 6 << 9) {
+            QTest::newRow(qPrintable(QString("%1 level %2").arg(body.first).arg(level))) << body.second << level;
+        }
+    }
+}
+
+void TestCompression::benchmarkGzip()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(int, level);
+
+    Compression::setLevel(level);
+
+    QByteArray compressed;
+    int iterations = 0;
+    std::clock_t start = std::clock();
+
+    QBENCHMARK {
+        compressed = Compression::gzip(data);
+        iterations++;
+    }
+
+    double cpu = (double) (std::clock() - start) * 1000 / CLOCKS_PER_SEC / qMax(iterations, 1);
+
+    QVERIFY(!compressed.isEmpty());
+    QVERIFY(compressed.size() < data.size());
+
+    qInfo("level %d: %d -> %d bytes (%.1f%%), %.2f ms of CPU per response",
+          level, data.size(), compressed.size(), compressed.size() * 100.0 / data.size(), cpu);
+}
+
+QByteArray TestCompression::temperatureLogs(int days)
+{
+    // The body of temperature_logs.js, as in the streamed JSON benchmark
+    QJsonArray array;
+
+    for (int i = 0; i < days * SyntheticHistory::samplesPerDay; i++) {
+        QDateTime date = SyntheticHistory::sampleDate(i);
+
+        for (int sensor = 0; sensor < SyntheticHistory::sensorCount; sensor++) {
+            QJsonObject object;
+            object.insert("id", SyntheticHistory::sensorId(sensor));
+            object.insert("date", date.toString("yyyy-MM-dd HH:mm:ss"));
+            object.insert("temp", SyntheticHistory::sampleValue(sensor, i));
+            array.append(object);
+        }
+    }
+
+    QJsonObject result;
+    result.insert("success", true);
+    result.insert("records", array);
+    result.insert("min", 16.0);
+    result.insert("max", 23.0);
+
+    return QJsonDocument(result).toJson(QJsonDocument::Compact);
+}
+
+QTEST_APPLESS_MAIN(TestCompression)
+
+#include "tst_compression.moc"
@@ -0,0 +1,15 @@
+include(../tests.pri)
+
+QT += sql
+
+TARGET = tst_database
+
+# The embedded schema, for the statements of the benchmark
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+SOURCES += \
+    tst_database.cpp \
+    ../../core/database.cpp
+
+HEADERS += \
+    ../../core/database.h
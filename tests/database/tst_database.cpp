@@ -0,0 +1,238 @@
+#include "core/database.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QJsonArray>
+#include <QSqlError>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtTest>
+
+// Gives the tests the size of the statement caches
+class DatabaseSettings : public Database
+{
+public:
+    using Database::maxStatements;
+};
+
+// Prepares a statement in a thread of its own, like a worker
+class Worker : public QThread
+{
+public:
+    QString getConnectionName() const
+    {
+        return connectionName;
+    }
+
+protected:
+    void run()
+    {
+        Database::Lease lease;
+        QSqlQuery query = lease.prepare("SELECT COUNT(*) FROM numbers");
+
+        if (Database::exec(query) && query.next()) {
+            connectionName = lease.database().connectionName();
+        }
+    }
+
+    QString connectionName;
+};
+
+class TestDatabase : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void leastRecentlyUsed();
+    void nestedStatement();
+    void threadConnection();
+    void benchmarkStatements_data();
+    void benchmarkStatements();
+
+private:
+    static QPair<int, int> statementCounts(const QString &connection);
+    static void prepare(const QString &sql);
+    static bool exec(const Database::Lease &lease, QSqlQuery &query, const QString &sql, bool cached, int iteration);
+
+    QTemporaryDir directory;
+};
+
+void TestDatabase::initTestCase()
+{
+    QVERIFY(directory.isValid());
+
+    // A fresh embedded database in a temporary folder, away from the settings of an installation
+    QCoreApplication::setOrganizationName("doxeo_test");
+    QDir::setCurrent(directory.path());
+
+    // Small caches: eviction is reached by a few statements
+    DatabaseSettings::maxStatements = 4;
+
+    Database::initialize("QSQLITE");
+    QVERIFY(Database::open());
+    QVERIFY(Database::bootstrap(SRCDIR "../../sql/doxeo.sqlite.sql"));
+
+    Database::Lease lease;
+    QSqlQuery query = lease.query();
+    QVERIFY(query.exec("CREATE TABLE numbers (id INTEGER NOT NULL)"));
+    QVERIFY(query.exec("INSERT INTO numbers (id) VALUES (1), (2), (3)"));
+}
+
+void TestDatabase::leastRecentlyUsed()
+{
+    QPair<int, int> before = statementCounts(QSqlDatabase::defaultConnection);
+
+    for (int i = 1; i <= 4; i++) {
+        prepare(QString("SELECT %1").arg(i));
+    }
+
+    // 1 is used again, 2 is the least recently used one when 5 comes
+    prepare("SELECT 1");
+    prepare("SELECT 5");
+    prepare("SELECT 1");
+    prepare("SELECT 2");
+
+    QPair<int, int> after = statementCounts(QSqlDatabase::defaultConnection);
+    QCOMPARE(after.first - before.first, 2);
+    QCOMPARE(after.second - before.second, 6);
+}
+
+void TestDatabase::nestedStatement()
+{
+    QString sql = "SELECT id FROM numbers ORDER BY id";
+    Database::Lease outer;
+    QSqlQuery query = outer.prepare(sql, true);
+
+    QVERIFY(Database::exec(query));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 1);
+
+    // The same statement while its results are read, as a callback could do
+    {
+        Database::Lease inner;
+        QSqlQuery nested = inner.prepare(sql, true);
+        int rows = 0;
+
+        QVERIFY(Database::exec(nested));
+        while (nested.next()) {
+            rows++;
+        }
+        QCOMPARE(rows, 3);
+    }
+
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 2);
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 3);
+    QVERIFY(!query.next());
+}
+
+void TestDatabase::threadConnection()
+{
+    Worker worker;
+    worker.start();
+    QVERIFY(worker.wait(30000));
+
+    // The connection and its statements went away with the thread
+    QVERIFY(!worker.getConnectionName().isEmpty());
+    QVERIFY(!QSqlDatabase::contains(worker.getConnectionName()));
+    QCOMPARE(statementCounts(worker.getConnectionName()), qMakePair(-1, -1));
+}
+
+void TestDatabase::benchmarkStatements_data()
+{
+    QTest::addColumn<QStringList>("sql");
+    QTest::addColumn<bool>("cached");
+
+    // The statements of change_switch_status (written behind) and set_setpoint (HeaterEvent::create)
+    QStringList status = QStringList() << "UPDATE switch SET status=? WHERE id=?";
+    QStringList setpoint = QStringList() << "INSERT INTO schedule_event (heater_id, setpoint) VALUES (?, ?)"
+                                         << "INSERT INTO schedule_occurrence (event_id, start_date, end_date, recurrent_date) "
+                                            "VALUES (?, ?, ?, ?)";
+
+    QTest::newRow("change_switch_status prepared each time") << status << false;
+    QTest::newRow("change_switch_status cached") << status << true;
+    QTest::newRow("set_setpoint prepared each time") << setpoint << false;
+    QTest::newRow("set_setpoint cached") << setpoint << true;
+}
+
+void TestDatabase::benchmarkStatements()
+{
+    QFETCH(QStringList, sql);
+    QFETCH(bool, cached);
+
+    Database::Lease setup;
+    QSqlQuery query = setup.query();
+    QVERIFY(query.exec("INSERT OR IGNORE INTO switch (id, name, category, order_by, status, power_on_cmd, power_off_cmd) "
+                       "VALUES ('lamp', 'Lamp', 'light', 1, 'off', '', '')"));
+    QVERIFY(query.exec("INSERT OR IGNORE INTO heater (id, name, power_on_cmd, power_off_cmd, mode, cool_setpoint, heat_setpoint, sensor) "
+                       "VALUES (1, 'Salon', '', '', 1, 17, 20, '')"));
+
+    int count = 0;
+
+    // One lease per request, as in the handlers
+    QBENCHMARK {
+        Database::Lease lease;
+        QSqlQuery statement;
+
+        foreach (const QString &text, sql) {
+            QVERIFY(exec(lease, statement, text, cached, count));
+        }
+        count++;
+    }
+
+    qInfo("%s: %d requests", cached ? "cached" : "prepared each time", count);
+}
+
+QPair<int, int> TestDatabase::statementCounts(const QString &connection)
+{
+    foreach (const QJsonValue &value, Database::getStatistics().value("connections").toArray()) {
+        QJsonObject stats = value.toObject();
+
+        if (stats.value("name").toString() == connection) {
+            return qMakePair(stats.value("statement_hits").toInt(), stats.value("statement_misses").toInt());
+        }
+    }
+
+    return qMakePair(-1, -1);
+}
+
+void TestDatabase::prepare(const QString &sql)
+{
+    Database::Lease lease;
+    lease.prepare(sql);
+}
+
+bool TestDatabase::exec(const Database::Lease &lease, QSqlQuery &query, const QString &sql, bool cached, int iteration)
+{
+    // The occurrence refers to the event inserted just before
+    QVariant eventId = query.lastInsertId();
+
+    if (cached) {
+        query = lease.prepare(sql);
+    } else {
+        // What the models did before the cache
+        query = lease.query();
+        query.prepare(sql);
+    }
+
+    if (sql.startsWith("UPDATE")) {
+        query.addBindValue(QString(iteration % 2 ? "on" : "off"));
+        query.addBindValue(QString("lamp"));
+    } else if (sql.contains("schedule_event")) {
+        query.addBindValue(1);
+        query.addBindValue(QString("heat"));
+    } else {
+        query.addBindValue(eventId);
+        query.addBindValue(QDateTime(QDate(2019, 1, 7), QTime(6, 0)));
+        query.addBindValue(QDateTime(QDate(2019, 1, 7), QTime(8, 0)));
+        query.addBindValue(false);
+    }
+
+    return Database::exec(query);
+}
+
+QTEST_GUILESS_MAIN(TestDatabase)
+
+#include "tst_database.moc"
@@ -0,0 +1,10 @@
+include(../tests.pri)
+
+TARGET = tst_httpheader
+
+SOURCES += \
+    tst_httpheader.cpp \
+    ../../core/httpheader.cpp
+
+HEADERS += \
+    ../../core/httpheader.h
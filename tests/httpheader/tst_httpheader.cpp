@@ -0,0 +1,229 @@
+#include "core/httpheader.h"
+
+#include <QBuffer>
+#include <QHash>
+#include <QRegExp>
+#include <QStringList>
+#include <QtTest>
+
+// Requests captured from the web interface and the Android application
+static const char *captured[] = {
+    "GET /thermostat/temperature_logs.js?start=2019-01-01%2000:00:00&end=2019-01-31%2023:59:59 HTTP/1.1\r\n"
+    "Host: 192.168.1.20:8080\r\n"
+    "Connection: keep-alive\r\n"
+    "Accept: application/json, text/javascript, */*; q=0.01\r\n"
+    "X-Requested-With: XMLHttpRequest\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/71.0.3578.98 Safari/537.36\r\n"
+    "Referer: http://192.168.1.20:8080/thermostat/logs\r\n"
+    "Accept-Encoding: gzip, deflate\r\n"
+    "Accept-Language: fr-FR,fr;q=0.9,en-US;q=0.8,en;q=0.7\r\n"
+    "Cookie: _ga=GA1.1.1803925337.1546343511; session_id=8f9c7d3e2b1a4f6e9d8c7b6a5f4e3d2c\r\n"
+    "\r\n",
+
+    "POST /switch/change_switch_status HTTP/1.1\r\n"
+    "Host: doxeo.example.org:8085\r\n"
+    "Connection: keep-alive\r\n"
+    "Content-Length: 28\r\n"
+    "Accept: */*\r\n"
+    "Origin: https://doxeo.example.org:8085\r\n"
+    "Content-Type: application/x-www-form-urlencoded; charset=UTF-8\r\n"
+    "Cookie: session_id=0a1b2c3d4e5f60718293a4b5c6d7e8f9\r\n"
+    "\r\n"
+    "id=switch_garden&status=true",
+
+    "GET /sensor/list.js HTTP/1.1\r\n"
+    "Host: 192.168.1.20:8080\r\n"
+    "User-Agent: okhttp/3.12.1\r\n"
+    "Accept-Encoding: gzip\r\n"
+    "Cookie: session_id=ffeeddccbbaa99887766554433221100\r\n"
+    "\r\n",
+};
+
+static const int capturedCount = sizeof(captured) / sizeof(captured[0]);
+
+// The parser replaced by the incremental one, kept as the reference of the benchmark
+class LegacyHttpHeader
+{
+public:
+    LegacyHttpHeader(QIODevice *request)
+    {
+        QStringList firstHeader = QString(request->readLine()).split(QRegExp("[ \r\n][ \r\n]*"));
+
+        if (firstHeader.size() > 1) {
+            method = firstHeader[0];
+            url = firstHeader[1];
+        }
+
+        foreach (QByteArray line, request->readAll().split('\n')) {
+            int colon = line.indexOf(':');
+            if (colon > 0) {
+                headers.insertMulti(line.left(colon).trimmed(), line.mid(colon + 1).trimmed());
+            }
+        }
+    }
+
+    QString getCookie(QString name)
+    {
+        QStringList list = QString(headers.value("Cookie")).split("; ");
+
+        foreach (QString element, list) {
+            QStringList cookie = element.split("=");
+            if (cookie.length() == 2 && cookie.at(0) == name) {
+                return cookie.at(1);
+            }
+        }
+
+        return "";
+    }
+
+    QString method;
+    QString url;
+    QHash<QByteArray, QByteArray> headers;
+};
+
+class TestHttpHeader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseComplete();
+    void parseSplit();
+    void parsePipelined();
+    void headerLimit();
+    void bodyLimit();
+    void headerOutlivesParser();
+    void benchmarkParse_data();
+    void benchmarkParse();
+};
+
+void TestHttpHeader::parseComplete()
+{
+    QByteArray buffer = captured[1];
+    HttpHeader header;
+
+    QCOMPARE(header.parse(buffer), HttpHeader::Complete);
+    QCOMPARE(header.getMethod(), QString("POST"));
+    QCOMPARE(header.getUrl(), QString("/switch/change_switch_status"));
+    QCOMPARE(header.getVersion(), QString("HTTP/1.1"));
+    QCOMPARE(header.getHeader("content-type"), QByteArray("application/x-www-form-urlencoded; charset=UTF-8"));
+    QCOMPARE(header.getBody(), QByteArray("id=switch_garden&status=true"));
+    QCOMPARE(header.getCookie("session_id"), QString("0a1b2c3d4e5f60718293a4b5c6d7e8f9"));
+    QVERIFY(header.isKeepAlive());
+    QVERIFY(buffer.isEmpty());
+}
+
+void TestHttpHeader::parseSplit()
+{
+    // Every split point of every request gives the same result as one read
+    for (int i = 0; i < capturedCount; i++) {
+        QByteArray request = captured[i];
+        HttpHeader reference;
+        QByteArray whole = request;
+        QCOMPARE(reference.parse(whole), HttpHeader::Complete);
+
+        for (int split = 1; split < request.size(); split++) {
+            HttpHeader header;
+            QByteArray buffer = request.left(split);
+
+            header.parse(buffer);
+            buffer.append(request.mid(split));
+
+            QCOMPARE(header.parse(buffer), HttpHeader::Complete);
+            QCOMPARE(header.getUrl(), reference.getUrl());
+            QCOMPARE(header.getCookie("session_id"), reference.getCookie("session_id"));
+            QCOMPARE(header.getBody(), reference.getBody());
+        }
+    }
+}
+
+void TestHttpHeader::parsePipelined()
+{
+    QByteArray buffer = QByteArray(captured[1]) + captured[2];
+    HttpHeader first;
+    HttpHeader second;
+
+    QCOMPARE(first.parse(buffer), HttpHeader::Complete);
+    QCOMPARE(second.parse(buffer), HttpHeader::Complete);
+    QCOMPARE(first.getBody(), QByteArray("id=switch_garden&status=true"));
+    QCOMPARE(second.getUrl(), QString("/sensor/list.js"));
+    QVERIFY(buffer.isEmpty());
+}
+
+void TestHttpHeader::headerLimit()
+{
+    QByteArray buffer = "GET / HTTP/1.1\r\nX-Padding: " + QByteArray(HttpHeader::maxHeaderSize, 'a');
+    HttpHeader header;
+
+    QCOMPARE(header.parse(buffer), HttpHeader::Error);
+    QVERIFY(header.getErrorStatus().startsWith("431"));
+}
+
+void TestHttpHeader::bodyLimit()
+{
+    QByteArray buffer = "POST / HTTP/1.1\r\nContent-Length: "
+                        + QByteArray::number(HttpHeader::maxBodySize + 1) + "\r\n\r\n";
+    HttpHeader header;
+
+    QCOMPARE(header.parse(buffer), HttpHeader::Error);
+    QVERIFY(header.getErrorStatus().startsWith("413"));
+}
+
+void TestHttpHeader::headerOutlivesParser()
+{
+    QByteArray value;
+
+    {
+        QByteArray buffer = captured[0];
+        HttpHeader header;
+        header.parse(buffer);
+        value = header.getHeader("Accept-Encoding");
+    }
+
+    QCOMPARE(value, QByteArray("gzip, deflate"));
+}
+
+void TestHttpHeader::benchmarkParse_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::addColumn<int>("request");
+
+    for (int i = 0; i < capturedCount; i++) {
+        QTest::newRow(qPrintable(QString("legacy %1").arg(i))) << true << i;
+        QTest::newRow(qPrintable(QString("incremental %1").arg(i))) << false << i;
+    }
+}
+
+void TestHttpHeader::benchmarkParse()
+{
+    QFETCH(bool, legacy);
+    QFETCH(int, request);
+
+    const QByteArray data = captured[request];
+    QString cookie;
+
+    // Both parsers answer what every handler asks: the url and the session cookie
+    if (legacy) {
+        QBENCHMARK {
+            QBuffer device;
+            device.setData(data);
+            device.open(QIODevice::ReadOnly);
+
+            LegacyHttpHeader header(&device);
+            cookie = header.getCookie("session_id");
+        }
+    } else {
+        QBENCHMARK {
+            QByteArray buffer = data;
+            HttpHeader header;
+
+            header.parse(buffer);
+            cookie = header.getCookie("session_id");
+        }
+    }
+
+    QVERIFY(!cookie.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(TestHttpHeader)
+
+#include "tst_httpheader.moc"
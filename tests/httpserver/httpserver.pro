@@ -0,0 +1,34 @@
+include(../tests.pri)
+
+QT += network
+
+LIBS += -lz
+
+TARGET = tst_httpserver
+
+SOURCES += \
+    tst_httpserver.cpp \
+    ../../controllers/assetcontroller.cpp \
+    ../../core/abstractcontroller.cpp \
+    ../../core/assetcache.cpp \
+    ../../core/compression.cpp \
+    ../../core/httpheader.cpp \
+    ../../core/httpserver.cpp \
+    ../../core/httpworker.cpp \
+    ../../core/requestcontext.cpp \
+    ../../core/router.cpp \
+    ../../core/urlquery.cpp \
+    ../../core/viewtemplate.cpp
+
+HEADERS += \
+    ../../controllers/assetcontroller.h \
+    ../../core/abstractcontroller.h \
+    ../../core/assetcache.h \
+    ../../core/compression.h \
+    ../../core/httpheader.h \
+    ../../core/httpserver.h \
+    ../../core/httpworker.h \
+    ../../core/requestcontext.h \
+    ../../core/router.h \
+    ../../core/urlquery.h \
+    ../../core/viewtemplate.h
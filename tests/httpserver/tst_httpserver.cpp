@@ -0,0 +1,460 @@
+#include "controllers/assetcontroller.h"
+#include "core/httpserver.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <QtTest>
+
+#include <algorithm>
+
+// Time of a slow database query, such as a long temperature_logs.js range
+static const int slowHandlerTime = 50;
+
+// Period of the main thread timer which stands for the serial port and the thermostat
+static const int tickInterval = 10;
+
+class SlowController : public AbstractController
+{
+public:
+    SlowController()
+    {
+        addRoute("slow", &SlowController::slow, true);
+    }
+
+    void defaultAction(RequestContext *context)
+    {
+        notFound(context, "");
+    }
+
+    void stop()
+    {
+
+    }
+
+    void slow(RequestContext *context)
+    {
+        QThread::msleep(slowHandlerTime);
+        context->sendResponse("200 OK", "Content-Type: text/plain\r\n", "done");
+    }
+};
+
+// Reads one response framed by Content-Length, with blocking calls
+static bool readResponse(QTcpSocket &socket, QByteArray &body)
+{
+    QByteArray data;
+    int headerEnd;
+
+    while ((headerEnd = data.indexOf("\r\n\r\n")) < 0) {
+        if (!socket.waitForReadyRead(10000)) {
+            return false;
+        }
+
+        data += socket.readAll();
+    }
+
+    QByteArray head = data.left(headerEnd).toLower();
+    int position = head.indexOf("content-length:");
+
+    if (position < 0) {
+        return false;
+    }
+
+    int lineEnd = head.indexOf("\r\n", position);
+    int length = head.mid(position + 15, lineEnd < 0 ? -1 : lineEnd - position - 15).trimmed().toInt();
+    body = data.mid(headerEnd + 4);
+
+    while (body.size() < length) {
+        if (!socket.waitForReadyRead(10000)) {
+            return false;
+        }
+
+        body += socket.readAll();
+    }
+
+    return body.size() == length;
+}
+
+// Sends keep-alive requests with blocking calls, alternating a slow handler and a cached asset
+class LoadClient : public QThread
+{
+public:
+    LoadClient(quint16 port, int requests, const QByteArray &asset)
+    {
+        this->port = port;
+        this->requests = requests;
+        this->asset = asset;
+        this->completed = 0;
+        this->errors = 0;
+    }
+
+    int getCompleted() const
+    {
+        return completed;
+    }
+
+    int getErrors() const
+    {
+        return errors;
+    }
+
+protected:
+    void run()
+    {
+        QTcpSocket socket;
+        socket.connectToHost(QHostAddress::LocalHost, port);
+
+        if (!socket.waitForConnected(5000)) {
+            errors = requests;
+            return;
+        }
+
+        for (int i = 0; i < requests; i++) {
+            bool slow = i % 2 == 0;
+            QByteArray body;
+
+            socket.write(slow ? "GET /test/slow HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                              : "GET /assets/test.js HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+            if (!readResponse(socket, body)) {
+                errors += requests - i;
+                return;
+            }
+
+            if (body == (slow ? QByteArray("done") : asset)) {
+                completed++;
+            } else {
+                errors++;
+            }
+        }
+    }
+
+    quint16 port;
+    int requests;
+    QByteArray asset;
+    int completed;
+    int errors;
+};
+
+// Loads the dashboard again and again: nine requests, on one connection or one each
+class PageClient : public QThread
+{
+public:
+    static const int pageRequests = 9;
+    static const int pageLoads = 50;
+
+    PageClient(quint16 port, bool keepAlive, const QByteArray &asset)
+    {
+        this->port = port;
+        this->keepAlive = keepAlive;
+        this->asset = asset;
+        this->elapsed = 0;
+    }
+
+    QVector<qint64> getLatencies() const
+    {
+        return latencies;
+    }
+
+    qint64 getElapsed() const
+    {
+        return elapsed;
+    }
+
+protected:
+    void run()
+    {
+        QByteArray request = "GET /assets/test.js HTTP/1.1\r\nHost: localhost\r\n";
+        request += keepAlive ? "\r\n" : "Connection: close\r\n\r\n";
+
+        QElapsedTimer total;
+        total.start();
+
+        for (int load = 0; load < pageLoads; load++) {
+            QTcpSocket socket;
+
+            for (int i = 0; i < pageRequests; i++) {
+                QElapsedTimer timer;
+                timer.start();
+
+                // Without keep-alive the time of a request includes its connection
+                if (socket.state() != QAbstractSocket::ConnectedState) {
+                    socket.abort();
+                    socket.connectToHost(QHostAddress::LocalHost, port);
+
+                    if (!socket.waitForConnected(5000)) {
+                        return;
+                    }
+                }
+
+                QByteArray body;
+                socket.write(request);
+
+                if (!readResponse(socket, body) || body != asset) {
+                    return;
+                }
+
+                if (!keepAlive) {
+                    socket.waitForDisconnected(5000);
+                }
+
+                latencies.append(timer.nsecsElapsed() / 1000);
+            }
+        }
+
+        elapsed = total.elapsed();
+    }
+
+    quint16 port;
+    bool keepAlive;
+    QByteArray asset;
+    QVector<qint64> latencies;
+    qint64 elapsed;
+};
+
+class TestHttpServer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void pipelined();
+    void connectionClose();
+    void benchmarkKeepAlive_data();
+    void benchmarkKeepAlive();
+    void load_data();
+    void load();
+
+private:
+    QTemporaryDir directory;
+    QString previousDirectory;
+    QByteArray asset;
+};
+
+void TestHttpServer::initTestCase()
+{
+    QVERIFY(directory.isValid());
+    QVERIFY(QDir(directory.path()).mkpath("assets"));
+
+    // Larger than a socket read: the responses reach the clients in pieces
+    for (int i = 0; i < 2000; i++) {
+        asset += "console.log('line " + QByteArray::number(i) + "');\n";
+    }
+
+    QFile file(directory.path() + "/assets/test.js");
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(asset);
+    file.close();
+
+    // The asset controller serves the files of the current directory
+    previousDirectory = QDir::currentPath();
+    QVERIFY(QDir::setCurrent(directory.path()));
+}
+
+void TestHttpServer::cleanupTestCase()
+{
+    QDir::setCurrent(previousDirectory);
+}
+
+void TestHttpServer::pipelined()
+{
+    SlowController slowController;
+    AssetController assetController;
+    HttpServer server;
+
+    server.addController(&slowController, "test");
+    server.addController(&assetController, "assets");
+    server.setWorkerCount(2);
+    QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+
+    QTcpSocket socket;
+    socket.connectToHost(QHostAddress::LocalHost, server.serverPort());
+    QVERIFY(socket.waitForConnected(5000));
+
+    // Three requests in one write: the slow one is answered first, on the same connection
+    socket.write("GET /test/slow HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                 "GET /assets/test.js HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                 "GET /test/missing HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+    QByteArray data;
+    QElapsedTimer timer;
+    timer.start();
+
+    // The last response has no body: it ends with its header block
+    while (!data.contains("HTTP/1.1 404") || !data.endsWith("\r\n\r\n")) {
+        QVERIFY(timer.elapsed() < 10000);
+        QTest::qWait(10);
+        data += socket.readAll();
+    }
+
+    int first = data.indexOf("HTTP/1.1 200 OK");
+    int second = data.indexOf("HTTP/1.1 200 OK", first + 1);
+    int third = data.indexOf("HTTP/1.1 404");
+
+    QVERIFY(first == 0);
+    QVERIFY(data.indexOf("done") < second);
+    QVERIFY(second < third);
+    QVERIFY(data.contains(asset));
+    QCOMPARE(socket.state(), QAbstractSocket::ConnectedState);
+}
+
+void TestHttpServer::connectionClose()
+{
+    AssetController assetController;
+    HttpServer server;
+
+    server.addController(&assetController, "assets");
+    server.setWorkerCount(1);
+    QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+
+    QTcpSocket socket;
+    socket.connectToHost(QHostAddress::LocalHost, server.serverPort());
+    QVERIFY(socket.waitForConnected(5000));
+
+    socket.write("GET /assets/test.js HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+
+    // The server closes the connection once the response is sent
+    QTRY_COMPARE_WITH_TIMEOUT(socket.state(), QAbstractSocket::UnconnectedState, 10000);
+
+    QByteArray data = socket.readAll();
+    QVERIFY(data.startsWith("HTTP/1.1 200 OK"));
+    QVERIFY(data.contains("Connection: close"));
+    QVERIFY(data.endsWith(asset));
+}
+
+void TestHttpServer::benchmarkKeepAlive_data()
+{
+    QTest::addColumn<bool>("keepAlive");
+
+    QTest::newRow("connection per request") << false;
+    QTest::newRow("keep-alive") << true;
+}
+
+void TestHttpServer::benchmarkKeepAlive()
+{
+    QFETCH(bool, keepAlive);
+
+    AssetController assetController;
+    HttpServer server;
+
+    server.addController(&assetController, "assets");
+    server.setWorkerCount(2);
+    QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+
+    // The client blocks in its thread, connections are accepted by the event loop of this one
+    PageClient client(server.serverPort(), keepAlive, asset);
+    QEventLoop loop;
+    connect(&client, &QThread::finished, &loop, &QEventLoop::quit);
+    client.start();
+    loop.exec();
+    client.wait();
+
+    QVector<qint64> latencies = client.getLatencies();
+    QCOMPARE(latencies.size(), PageClient::pageLoads * PageClient::pageRequests);
+    std::sort(latencies.begin(), latencies.end());
+
+    qInfo("%s: %.0f requests/s, median %lld us, p99 %lld us",
+          keepAlive ? "keep-alive" : "connection per request",
+          latencies.size() * 1000.0 / qMax<qint64>(client.getElapsed(), 1),
+          latencies.at(latencies.size() / 2),
+          latencies.at(latencies.size() * 99 / 100));
+}
+
+void TestHttpServer::load_data()
+{
+    QTest::addColumn<int>("workers");
+
+    QTest::newRow("main thread") << 0;
+    QTest::newRow("1 worker") << 1;
+    QTest::newRow("4 workers") << 4;
+}
+
+void TestHttpServer::load()
+{
+    QFETCH(int, workers);
+
+    const int clientCount = 8;
+    const int requestsPerClient = 40;
+
+    // Declared last, the server and its workers are destroyed before the controllers they call
+    SlowController slowController;
+    AssetController assetController;
+    HttpServer server;
+
+    server.addController(&slowController, "test");
+    server.addController(&assetController, "assets");
+    server.setWorkerCount(workers);
+    QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+
+    // Lateness of a main thread timer while the server is saturated
+    QElapsedTimer clock;
+    qint64 lastTick = 0;
+    qint64 maxLatency = 0;
+    QTimer ticker;
+    ticker.setInterval(tickInterval);
+    connect(&ticker, &QTimer::timeout, this, [&clock, &lastTick, &maxLatency]() {
+        qint64 now = clock.elapsed();
+        maxLatency = qMax(maxLatency, now - lastTick - tickInterval);
+        lastTick = now;
+    });
+
+    QList<LoadClient *> clients;
+    QEventLoop loop;
+    int running = clientCount;
+
+    for (int i = 0; i < clientCount; i++) {
+        LoadClient *client = new LoadClient(server.serverPort(), requestsPerClient, asset);
+        connect(client, &QThread::finished, &loop, [&loop, &running]() {
+            if (--running == 0) {
+                loop.quit();
+            }
+        });
+        clients.append(client);
+    }
+
+    clock.start();
+    ticker.start();
+
+    foreach (LoadClient *client, clients) {
+        client->start();
+    }
+
+    loop.exec();
+    ticker.stop();
+
+    qint64 elapsed = clock.elapsed();
+    int completed = 0;
+    int errors = 0;
+
+    foreach (LoadClient *client, clients) {
+        client->wait();
+        completed += client->getCompleted();
+        errors += client->getErrors();
+        delete client;
+    }
+
+    qInfo("%d workers: %d requests in %lld ms, %.0f requests/s, main thread latency up to %lld ms",
+          workers, completed, elapsed, completed * 1000.0 / qMax<qint64>(elapsed, 1), maxLatency);
+
+    server.close();
+
+    // Every asset response is complete and intact while the workers share the cache
+    QCOMPARE(errors, 0);
+    QCOMPARE(completed, clientCount * requestsPerClient);
+
+    // Slow handlers no longer hold the main thread once they run off the main thread
+    if (workers > 0) {
+        QVERIFY2(maxLatency < slowHandlerTime,
+                 qPrintable(QString("main thread latency %1 ms").arg(maxLatency)));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestHttpServer)
+
+#include "tst_httpserver.moc"
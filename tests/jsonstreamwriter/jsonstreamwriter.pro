@@ -0,0 +1,22 @@
+include(../tests.pri)
+
+QT += network
+
+LIBS += -lz
+
+TARGET = tst_jsonstreamwriter
+
+SOURCES += \
+    tst_jsonstreamwriter.cpp \
+    ../../core/compression.cpp \
+    ../../core/httpheader.cpp \
+    ../../core/jsonstreamwriter.cpp \
+    ../../core/requestcontext.cpp \
+    ../../core/urlquery.cpp
+
+HEADERS += \
+    ../../core/compression.h \
+    ../../core/httpheader.h \
+    ../../core/jsonstreamwriter.h \
+    ../../core/requestcontext.h \
+    ../../core/urlquery.h
@@ -0,0 +1,377 @@
+#include "core/jsonstreamwriter.h"
+#include "tests/synthetichistory.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QtTest>
+
+// Reads a response like a browser: the time of the first byte is kept, the body is not
+class Reader : public QThread
+{
+public:
+    Reader(quint16 port, const QElapsedTimer *clock, bool keepBody)
+    {
+        this->port = port;
+        this->clock = clock;
+        this->keepBody = keepBody;
+        this->firstByte = -1;
+        this->bodySize = 0;
+        this->success = false;
+    }
+
+    qint64 getFirstByte() const
+    {
+        return firstByte;
+    }
+
+    qint64 getBodySize() const
+    {
+        return bodySize;
+    }
+
+    QByteArray getBody() const
+    {
+        return body;
+    }
+
+    bool isSuccess() const
+    {
+        return success;
+    }
+
+protected:
+    void run()
+    {
+        QTcpSocket socket;
+        socket.connectToHost(QHostAddress::LocalHost, port);
+
+        if (!socket.waitForConnected(5000)) {
+            return;
+        }
+
+        socket.write("GET /thermostat/temperature_logs.js HTTP/1.1\r\nHost: localhost\r\n\r\n");
+        socket.flush();
+
+        QByteArray line;
+        qint64 contentLength = -1;
+        bool chunked = false;
+
+        // Header block
+        while (readLine(socket, line) && line != "\r\n") {
+            QByteArray lower = line.toLower();
+
+            if (lower.startsWith("content-length:")) {
+                contentLength = lower.mid(15).trimmed().toLongLong();
+            } else if (lower.startsWith("transfer-encoding:") && lower.contains("chunked")) {
+                chunked = true;
+            }
+        }
+
+        if (!chunked) {
+            success = contentLength >= 0 && readBody(socket, contentLength);
+            return;
+        }
+
+        // Chunks until the empty one
+        while (readLine(socket, line)) {
+            bool ok;
+            qint64 size = line.trimmed().toLongLong(&ok, 16);
+
+            if (!ok || !readBody(socket, size) || !readLine(socket, line)) {
+                return;
+            }
+
+            if (size == 0) {
+                success = true;
+                return;
+            }
+        }
+    }
+
+    bool waitForData(QTcpSocket &socket)
+    {
+        if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(30000)) {
+            return false;
+        }
+
+        if (firstByte < 0) {
+            firstByte = clock->elapsed();
+        }
+
+        return true;
+    }
+
+    bool readLine(QTcpSocket &socket, QByteArray &line)
+    {
+        line.clear();
+
+        while (!line.endsWith('\n')) {
+            if (!waitForData(socket)) {
+                return false;
+            }
+
+            line += socket.readLine();
+        }
+
+        return true;
+    }
+
+    bool readBody(QTcpSocket &socket, qint64 size)
+    {
+        while (size > 0) {
+            if (!waitForData(socket)) {
+                return false;
+            }
+
+            QByteArray data = socket.read(size);
+            size -= data.size();
+            bodySize += data.size();
+
+            if (keepBody) {
+                body += data;
+            }
+        }
+
+        return true;
+    }
+
+    quint16 port;
+    const QElapsedTimer *clock;
+    bool keepBody;
+    qint64 firstByte;
+    qint64 bodySize;
+    QByteArray body;
+    bool success;
+};
+
+class TestJsonStreamWriter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void nonFiniteValues();
+    void benchmarkLogs_data();
+    void benchmarkLogs();
+
+private:
+    static void writeStreamed(RequestContext *context, int days);
+    static void writeDocument(RequestContext *context, int days);
+    static qint64 readStatus(const QByteArray &field);
+    static void resetPeakMemory();
+};
+
+void TestJsonStreamWriter::nonFiniteValues()
+{
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+
+    QElapsedTimer clock;
+    clock.start();
+    Reader reader(server.serverPort(), &clock, true);
+    reader.start();
+
+    QVERIFY(server.waitForNewConnection(5000));
+    QTcpSocket *socket = server.nextPendingConnection();
+    QVERIFY(socket->waitForReadyRead(5000));
+
+    QByteArray request = socket->readAll();
+    HttpHeader header;
+    QCOMPARE(header.parse(request), HttpHeader::Complete);
+
+    {
+        RequestContext context(socket, header, false);
+        JsonStreamWriter writer(&context);
+
+        writer.beginArray();
+        writer.writeValue(qQNaN());
+        writer.writeValue(qInf());
+        writer.writeValue((float) -qInf());
+        writer.writeValue(21.5f);
+        writer.endArray();
+        writer.finish();
+
+        while (socket->bytesToWrite() > 0 && socket->waitForBytesWritten(30000)) {
+        }
+    }
+
+    QVERIFY(reader.wait(30000));
+    QVERIFY(reader.isSuccess());
+    QCOMPARE(reader.getBody(), QByteArray("[null,null,null,21.5]"));
+}
+
+void TestJsonStreamWriter::benchmarkLogs_data()
+{
+    QTest::addColumn<bool>("streamed");
+    QTest::addColumn<int>("days");
+
+    foreach (int days, QList<int>() << 1 << 30 << 365) {
+        QTest::newRow(qPrintable(QString("document %1 days").arg(days))) << false << days;
+        QTest::newRow(qPrintable(QString("streamed %1 days").arg(days))) << true << days;
+    }
+}
+
+void TestJsonStreamWriter::benchmarkLogs()
+{
+    QFETCH(bool, streamed);
+    QFETCH(int, days);
+
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+
+    QElapsedTimer clock;
+    clock.start();
+    Reader reader(server.serverPort(), &clock, days == 1);
+    reader.start();
+
+    QVERIFY(server.waitForNewConnection(5000));
+    QTcpSocket *socket = server.nextPendingConnection();
+    QVERIFY(socket->waitForReadyRead(5000));
+
+    QByteArray request = socket->readAll();
+    HttpHeader header;
+    QCOMPARE(header.parse(request), HttpHeader::Complete);
+
+    // Peak memory of the handler: the reader thread only keeps the body of the small range
+    resetPeakMemory();
+    qint64 residentBefore = readStatus("VmRSS");
+    qint64 start = clock.elapsed();
+
+    {
+        RequestContext context(socket, header, false);
+        QEventLoop loop;
+        connect(&context, &RequestContext::finished, &loop, &QEventLoop::quit);
+
+        // The handler runs in another thread, as concurrent routes do: this one sends what it writes
+        QThread *handler = QThread::create([&context, streamed, days]() {
+            if (streamed) {
+                writeStreamed(&context, days);
+            } else {
+                writeDocument(&context, days);
+            }
+
+            QMetaObject::invokeMethod(&context, "handlerReturned", Qt::QueuedConnection);
+        });
+
+        handler->start();
+        loop.exec();
+        handler->wait();
+        delete handler;
+
+        // The rest of the response leaves the socket buffer while the reader drains it
+        while (socket->bytesToWrite() > 0 && socket->waitForBytesWritten(30000)) {
+        }
+    }
+
+    qint64 peak = readStatus("VmHWM");
+
+    QVERIFY(reader.wait(60000));
+    QVERIFY(reader.isSuccess());
+
+    qint64 total = clock.elapsed() - start;
+    qInfo("%s, %d days: first byte after %lld ms, complete after %lld ms, %lld bytes, peak memory +%lld kB",
+          streamed ? "streamed" : "document", days, reader.getFirstByte() - start, total,
+          reader.getBodySize(), peak >= 0 && residentBefore >= 0 ? peak - residentBefore : -1);
+
+    if (days == 1) {
+        QJsonParseError error;
+        QJsonDocument document = QJsonDocument::fromJson(reader.getBody(), &error);
+
+        QCOMPARE(error.error, QJsonParseError::NoError);
+        QCOMPARE(document.object().value("records").toArray().size(), SyntheticHistory::sensorCount * SyntheticHistory::samplesPerDay);
+    }
+}
+
+void TestJsonStreamWriter::writeStreamed(RequestContext *context, int days)
+{
+    JsonStreamWriter writer(context);
+
+    writer.beginObject();
+    writer.write("success", true);
+    writer.writeName("records");
+    writer.beginArray();
+
+    for (int i = 0; i < days * SyntheticHistory::samplesPerDay; i++) {
+        QDateTime date = SyntheticHistory::sampleDate(i);
+
+        for (int sensor = 0; sensor < SyntheticHistory::sensorCount; sensor++) {
+            writer.beginObject();
+            writer.write("id", SyntheticHistory::sensorId(sensor));
+            writer.write("date", date);
+            writer.write("temp", SyntheticHistory::sampleValue(sensor, i));
+            writer.endObject();
+        }
+    }
+
+    writer.endArray();
+    writer.write("min", 16.0f);
+    writer.write("max", 23.0f);
+    writer.endObject();
+    writer.finish();
+}
+
+void TestJsonStreamWriter::writeDocument(RequestContext *context, int days)
+{
+    // What temperature_logs.js did before the streaming writer
+    QJsonArray array;
+
+    for (int i = 0; i < days * SyntheticHistory::samplesPerDay; i++) {
+        QDateTime date = SyntheticHistory::sampleDate(i);
+
+        for (int sensor = 0; sensor < SyntheticHistory::sensorCount; sensor++) {
+            QJsonObject object;
+            object.insert("id", SyntheticHistory::sensorId(sensor));
+            object.insert("date", date.toString("yyyy-MM-dd HH:mm:ss"));
+            object.insert("temp", SyntheticHistory::sampleValue(sensor, i));
+            array.append(object);
+        }
+    }
+
+    QJsonObject result;
+    result.insert("success", true);
+    result.insert("records", array);
+    result.insert("min", 16.0);
+    result.insert("max", 23.0);
+
+    context->sendResponse("200 OK",
+                          "Content-Type: application/json; charset=\"utf-8\"\r\n",
+                          QJsonDocument(result).toJson(QJsonDocument::Compact));
+}
+
+qint64 TestJsonStreamWriter::readStatus(const QByteArray &field)
+{
+    // Linux only: sizes in kB, -1 elsewhere
+    QFile file("/proc/self/status");
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+
+    foreach (const QByteArray &line, file.readAll().split('\n')) {
+        if (line.startsWith(field + ":")) {
+            return line.mid(field.size() + 1).trimmed().split(' ').first().toLongLong();
+        }
+    }
+
+    return -1;
+}
+
+void TestJsonStreamWriter::resetPeakMemory()
+{
+    // Writing 5 resets VmHWM to the current resident size (Linux 4.0 and later)
+    QFile file("/proc/self/clear_refs");
+
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write("5");
+    }
+}
+
+QTEST_GUILESS_MAIN(TestJsonStreamWriter)
+
+#include "tst_jsonstreamwriter.moc"
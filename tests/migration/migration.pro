@@ -0,0 +1,17 @@
+include(../tests.pri)
+
+QT += sql
+
+TARGET = tst_migration
+
+# The embedded schema installed before the migrations, as on a first start
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+SOURCES += \
+    tst_migration.cpp \
+    ../../core/database.cpp \
+    ../../core/migration.cpp
+
+HEADERS += \
+    ../../core/database.h \
+    ../../core/migration.h
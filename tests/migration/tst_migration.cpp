@@ -0,0 +1,333 @@
+#include "core/database.h"
+#include "core/migration.h"
+#include "tests/synthetichistory.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QSqlError>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <time.h>
+
+// Years of the synthetic history in the range benchmarks
+static const int years = 3;
+
+// Gives the tests the steps and the index check of the runner
+class MigrationSteps : public Migration
+{
+public:
+    using Migration::Step;
+    using Migration::steps;
+    using Migration::hasIndex;
+    using Migration::apply;
+};
+
+class TestMigration : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void firstRun();
+    void secondRun();
+    void missingIndex();
+    void backfill();
+    void uniqueSamples();
+    void benchmarkRange_data();
+    void benchmarkRange();
+
+private:
+    static int count(const QString &sql);
+    static bool exec(const QString &sql);
+    static bool replay(int first, int last);
+    static bool fillDataset();
+
+    QTemporaryDir directory;
+};
+
+void TestMigration::initTestCase()
+{
+    QVERIFY(directory.isValid());
+
+    // Samples are in local time, hourly periods in UTC, daily ones local days: a zone with DST and a known offset
+    qputenv("TZ", "Europe/Paris");
+    tzset();
+
+    // A fresh embedded database in a temporary folder, away from the settings of an installation
+    QCoreApplication::setOrganizationName("doxeo_test");
+    QDir::setCurrent(directory.path());
+
+    Database::initialize("QSQLITE");
+    QVERIFY(Database::open());
+    QVERIFY(Database::bootstrap(SRCDIR "../../sql/doxeo.sqlite.sql"));
+}
+
+void TestMigration::firstRun()
+{
+    QList<MigrationSteps::Step> steps = MigrationSteps::steps();
+
+    QVERIFY(Migration::run());
+    QCOMPARE(Migration::getVersion(), steps.last().version);
+    QCOMPARE(count("SELECT COUNT(*) FROM schema_version"), steps.size());
+
+    Database::Lease lease;
+    foreach (const MigrationSteps::Step &step, steps) {
+        if (!step.index.isEmpty()) {
+            QVERIFY2(MigrationSteps::hasIndex(lease.database(), step.table, step.index), qPrintable(step.index));
+        }
+    }
+}
+
+void TestMigration::secondRun()
+{
+    int version = Migration::getVersion();
+    int applied = count("SELECT COUNT(*) FROM schema_version");
+
+    QVERIFY(Migration::run());
+    QCOMPARE(Migration::getVersion(), version);
+    QCOMPARE(count("SELECT COUNT(*) FROM schema_version"), applied);
+}
+
+void TestMigration::missingIndex()
+{
+    int version = Migration::getVersion();
+
+    QVERIFY(exec("DROP INDEX temperature_date_id"));
+    QVERIFY(Migration::run());
+
+    Database::Lease lease;
+    QVERIFY(MigrationSteps::hasIndex(lease.database(), "temperature", "temperature_date_id"));
+    QCOMPARE(Migration::getVersion(), version);
+}
+
+void TestMigration::backfill()
+{
+    QVERIFY(exec("INSERT INTO temperature (id, date, temperature) VALUES "
+                 "('salon', '2019-01-01T10:00:00.000', 19), "
+                 "('salon', '2019-01-01T10:10:00.000', 20), "
+                 "('salon', '2019-01-01T10:50:00.000', 21), "
+                 "('salon', '2019-01-01T11:00:00.000', 22)"));
+
+    // Replays the backfill (version 5) and the rebuild of version 6
+    QVERIFY(replay(5, 6));
+
+    Database::Lease lease;
+    QSqlQuery query = lease.query();
+
+    QVERIFY(query.exec("SELECT period, temp_min, temp_max, temp_sum, sample_count FROM temperature_hourly "
+                       "WHERE id = 'salon' ORDER BY period"));
+
+    // 10:00 in Paris is 09:00 UTC in winter
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toDateTime(), QDateTime(QDate(2019, 1, 1), QTime(9, 0), Qt::UTC));
+    QCOMPARE(query.value(1).toFloat(), 19.0f);
+    QCOMPARE(query.value(2).toFloat(), 21.0f);
+    QCOMPARE(query.value(3).toDouble(), 60.0);
+    QCOMPARE(query.value(4).toInt(), 3);
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toDateTime(), QDateTime(QDate(2019, 1, 1), QTime(10, 0), Qt::UTC));
+    QCOMPARE(query.value(4).toInt(), 1);
+    QVERIFY(!query.next());
+
+    QVERIFY(query.exec("SELECT period, temp_sum, sample_count FROM temperature_daily WHERE id = 'salon'"));
+    // The local day, which started at 23:00 UTC the day before
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toDateTime(), QDateTime(QDate(2018, 12, 31), QTime(23, 0), Qt::UTC));
+    QCOMPARE(query.value(1).toDouble(), 82.0);
+    QCOMPARE(query.value(2).toInt(), 4);
+    QVERIFY(!query.next());
+
+    QVERIFY(exec("DELETE FROM temperature"));
+    QVERIFY(exec("DELETE FROM temperature_hourly"));
+    QVERIFY(exec("DELETE FROM temperature_daily"));
+}
+
+void TestMigration::uniqueSamples()
+{
+    // Duplicates written before the unique index, as a replayed journal did
+    QVERIFY(exec("DROP INDEX temperature_id_date"));
+    QVERIFY(exec("INSERT INTO temperature (id, date, temperature) VALUES "
+                 "('salon', '2019-01-01T10:00:00.000', 19), "
+                 "('salon', '2019-01-01T10:00:00.000', 19), "
+                 "('salon', '2019-01-01T10:10:00.000', 20), "
+                 "('cuisine', '2019-01-01T10:00:00.000', 18)"));
+
+    QVERIFY(replay(6, 6));
+
+    QCOMPARE(count("SELECT COUNT(*) FROM temperature"), 3);
+    QCOMPARE(count("SELECT sample_count FROM temperature_hourly WHERE id = 'salon'"), 2);
+    QCOMPARE(count("SELECT sample_count FROM temperature_daily WHERE id = 'salon'"), 2);
+
+    Database::Lease lease;
+    QVERIFY(MigrationSteps::hasIndex(lease.database(), "temperature", "temperature_id_date"));
+
+    // A sample stored already is rejected
+    QVERIFY(!exec("INSERT INTO temperature (id, date, temperature) VALUES ('salon', '2019-01-01T10:00:00.000', 19)"));
+
+    QVERIFY(exec("DELETE FROM temperature"));
+    QVERIFY(exec("DELETE FROM temperature_hourly"));
+    QVERIFY(exec("DELETE FROM temperature_daily"));
+}
+
+void TestMigration::benchmarkRange_data()
+{
+    QTest::addColumn<bool>("indexed");
+    QTest::addColumn<int>("days");
+
+    // Indexed rows first: the index is dropped once for the others
+    foreach (bool indexed, QList<bool>() << true << false) {
+        foreach (int days, QList<int>() << 1 << 30 << 365) {
+            QTest::newRow(qPrintable(QString("%1 %2 days").arg(indexed ? "index" : "no index").arg(days)))
+                    << indexed << days;
+        }
+    }
+}
+
+void TestMigration::benchmarkRange()
+{
+    QFETCH(bool, indexed);
+    QFETCH(int, days);
+
+    QVERIFY(fillDataset());
+
+    if (indexed) {
+        // The runner rebuilds a missing index step
+        QVERIFY(Migration::run());
+    } else {
+        QVERIFY(exec("DROP INDEX IF EXISTS temperature_date_id"));
+    }
+
+    // A range in the middle of the history, as asked by temperature_logs.js
+    QDateTime start = SyntheticHistory::sampleDate(500 * SyntheticHistory::samplesPerDay, Qt::UTC);
+    QDateTime end = start.addDays(days);
+    QString sql = "SELECT id, date, temperature FROM temperature "
+                  "WHERE date >= ? AND date <= ? "
+                  "ORDER BY date ASC";
+
+    Database::Lease lease;
+    QSqlQuery plan = lease.query();
+    plan.prepare("EXPLAIN QUERY PLAN " + sql);
+    plan.addBindValue(start);
+    plan.addBindValue(end);
+    QVERIFY(plan.exec());
+
+    QStringList details;
+    while (plan.next()) {
+        details << plan.value(3).toString();
+    }
+
+    QSqlQuery query = lease.prepare(sql, true);
+    query.addBindValue(start);
+    query.addBindValue(end);
+    int rows = 0;
+
+    QBENCHMARK {
+        QVERIFY(Database::exec(query));
+
+        rows = 0;
+        while (query.next()) {
+            rows++;
+        }
+    }
+
+    // Both bounds are included
+    QCOMPARE(rows, (days * SyntheticHistory::samplesPerDay + 1) * SyntheticHistory::sensorCount);
+    qInfo("%s, %d days: %d rows, plan: %s", indexed ? "index" : "no index", days, rows, qPrintable(details.join("; ")));
+}
+
+int TestMigration::count(const QString &sql)
+{
+    Database::Lease lease;
+    QSqlQuery query = lease.query();
+
+    if (!query.exec(sql) || !query.next()) {
+        qWarning() << query.lastError() << sql;
+        return -1;
+    }
+
+    return query.value(0).toInt();
+}
+
+bool TestMigration::exec(const QString &sql)
+{
+    Database::Lease lease;
+    QSqlQuery query = lease.query();
+
+    if (!query.exec(sql)) {
+        qWarning() << query.lastError() << sql;
+        return false;
+    }
+
+    return true;
+}
+
+bool TestMigration::replay(int first, int last)
+{
+    Database::Lease lease;
+    QSqlQuery query = lease.query();
+
+    // Steps in the middle of the history: run() only applies the versions after the last one
+    query.prepare("DELETE FROM schema_version WHERE version >= ? AND version <= ?");
+    query.addBindValue(first);
+    query.addBindValue(last);
+
+    if (!query.exec()) {
+        qWarning() << query.lastError();
+        return false;
+    }
+
+    foreach (const MigrationSteps::Step &step, MigrationSteps::steps()) {
+        if (step.version >= first && step.version <= last && !MigrationSteps::apply(lease.database(), step)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool TestMigration::fillDataset()
+{
+    static bool filled = false;
+
+    if (filled) {
+        return true;
+    }
+
+    Database::Lease lease;
+    QSqlDatabase db = lease.database();
+    QSqlQuery query = lease.prepare("INSERT INTO temperature (id, date, temperature) VALUES (?, ?, ?)");
+
+    int samples = 365 * years * SyntheticHistory::samplesPerDay;
+
+    QElapsedTimer timer;
+    timer.start();
+    db.transaction();
+
+    for (int i = 0; i < samples; i++) {
+        // UTC: no hour is repeated or skipped by a DST change, the row counts stay exact
+        QDateTime date = SyntheticHistory::sampleDate(i, Qt::UTC);
+
+        for (int sensor = 0; sensor < SyntheticHistory::sensorCount; sensor++) {
+            query.addBindValue(SyntheticHistory::sensorId(sensor));
+            query.addBindValue(date);
+            query.addBindValue(SyntheticHistory::sampleValue(sensor, i));
+
+            if (!query.exec()) {
+                qWarning() << query.lastError();
+                db.rollback();
+                return false;
+            }
+        }
+    }
+
+    filled = db.commit();
+    qInfo("%d rows inserted in %lld ms", samples * SyntheticHistory::sensorCount, timer.elapsed());
+
+    return filled;
+}
+
+QTEST_GUILESS_MAIN(TestMigration)
+
+#include "tst_migration.moc"
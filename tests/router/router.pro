@@ -0,0 +1,10 @@
+include(../tests.pri)
+
+TARGET = tst_router
+
+SOURCES += \
+    tst_router.cpp \
+    ../../core/router.cpp
+
+HEADERS += \
+    ../../core/router.h
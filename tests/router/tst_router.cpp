@@ -0,0 +1,218 @@
+#include "core/router.h"
+#include "core/tools.h"
+
+#include <QtTest>
+
+// The dispatch replaced by the route tree: a copied table of slot names and invokeMethod
+class LegacyController : public QObject
+{
+    Q_OBJECT
+
+public:
+    QHash<QString, QString> getRouter() const
+    {
+        return router;
+    }
+
+    QHash<QString, QString> router;
+
+public slots:
+    void action(QObject *)
+    {
+
+    }
+};
+
+class TestRouter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void exactMatch();
+    void parameters();
+    void deepestRoute();
+    void methods();
+    void notFound();
+    void benchmarkMatch_data();
+    void benchmarkMatch();
+
+private:
+    static Router::Handler handler(QString *called, const QString &name);
+    static bool call(const Router &router, const QByteArray &method, const QString &path,
+                     QHash<QString, QString> *parameters = nullptr);
+};
+
+Router::Handler TestRouter::handler(QString *called, const QString &name)
+{
+    return [called, name](RequestContext *) {
+        *called = name;
+    };
+}
+
+bool TestRouter::call(const Router &router, const QByteArray &method, const QString &path,
+                      QHash<QString, QString> *parameters)
+{
+    const Router::Route *route = nullptr;
+    QHash<QString, QString> values;
+
+    if (router.match(method, path.split('/', SKIP_EMPTY_PARTS), &route, &values) != Router::Found) {
+        return false;
+    }
+
+    if (parameters != nullptr) {
+        *parameters = values;
+    }
+
+    route->handler(nullptr);
+    return true;
+}
+
+void TestRouter::exactMatch()
+{
+    Router router;
+    QString called;
+
+    router.addRoute("*", "list.js", handler(&called, "list"));
+    router.addRoute("*", "script/edit", handler(&called, "edit"));
+
+    QVERIFY(call(router, "GET", "list.js"));
+    QCOMPARE(called, QString("list"));
+
+    QVERIFY(call(router, "POST", "script/edit"));
+    QCOMPARE(called, QString("edit"));
+}
+
+void TestRouter::parameters()
+{
+    Router router;
+    QString called;
+    QHash<QString, QString> parameters;
+
+    router.addRoute("GET", "sensor/:id/history", handler(&called, "history"));
+    router.addRoute("GET", "sensor/list.js", handler(&called, "list"));
+
+    QVERIFY(call(router, "GET", "sensor/temp_salon/history", &parameters));
+    QCOMPARE(called, QString("history"));
+    QCOMPARE(parameters.value("id"), QString("temp_salon"));
+
+    // A literal segment is preferred over a parameter
+    QVERIFY(call(router, "GET", "sensor/list.js", &parameters));
+    QCOMPARE(called, QString("list"));
+    QVERIFY(parameters.isEmpty());
+}
+
+void TestRouter::deepestRoute()
+{
+    Router router;
+    QString called;
+
+    router.addRoute("*", "camera", handler(&called, "camera"));
+    router.addRoute("*", "camera/snapshot", handler(&called, "snapshot"));
+
+    // Handlers read the remaining segments themselves
+    QVERIFY(call(router, "GET", "camera/snapshot/3/large"));
+    QCOMPARE(called, QString("snapshot"));
+
+    QVERIFY(call(router, "GET", "camera/stream"));
+    QCOMPARE(called, QString("camera"));
+}
+
+void TestRouter::methods()
+{
+    Router router;
+    QString called;
+    const Router::Route *route = nullptr;
+
+    router.addRoute("get", "setting", handler(&called, "get"));
+    router.addRoute("POST", "setting", handler(&called, "post"));
+
+    QVERIFY(call(router, "GET", "setting"));
+    QCOMPARE(called, QString("get"));
+
+    QVERIFY(call(router, "POST", "setting"));
+    QCOMPARE(called, QString("post"));
+
+    QCOMPARE(router.match("DELETE", QStringList() << "setting", &route, nullptr), Router::MethodNotAllowed);
+    QCOMPARE(router.getAllowedMethods(QStringList() << "setting"), QByteArray("GET, POST"));
+}
+
+void TestRouter::notFound()
+{
+    Router router;
+    QString called;
+    const Router::Route *route = nullptr;
+
+    router.addRoute("*", "heaters", handler(&called, "heaters"));
+
+    QCOMPARE(router.match("GET", QStringList() << "missing", &route, nullptr), Router::NotFound);
+    QCOMPARE(router.match("GET", QStringList(), &route, nullptr), Router::NotFound);
+    QCOMPARE(router.getAllowedMethods(QStringList() << "missing"), QByteArray(""));
+}
+
+void TestRouter::benchmarkMatch_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::addColumn<int>("routes");
+
+    foreach (int routes, QList<int>() << 10 << 100 << 1000) {
+        QTest::newRow(qPrintable(QString("legacy %1 routes").arg(routes))) << true << routes;
+        QTest::newRow(qPrintable(QString("route tree %1 routes").arg(routes))) << false << routes;
+    }
+}
+
+void TestRouter::benchmarkMatch()
+{
+    QFETCH(bool, legacy);
+    QFETCH(int, routes);
+
+    QStringList action = QStringList() << "group5" << QString("action%1").arg(routes - 5);
+    int found = 0;
+
+    if (legacy) {
+        LegacyController controller;
+
+        for (int i = 0; i < routes; i++) {
+            controller.router.insert(QString("action%1").arg(i), "action");
+        }
+
+        // As HttpServer did: two copies of the table and a lookup of the slot by name
+        QBENCHMARK {
+            if (controller.getRouter().contains(action.at(1))) {
+                QString slot = controller.getRouter().value(action.at(1));
+                found += QMetaObject::invokeMethod(&controller,
+                                                   slot.toStdString().c_str(),
+                                                   Qt::DirectConnection,
+                                                   Q_ARG(QObject *, nullptr));
+            }
+        }
+
+        QVERIFY(found > 0);
+        return;
+    }
+
+    // Routes spread over controllers like the real ones: action names under a few prefixes
+    Router router;
+    QString called;
+
+    for (int i = 0; i < routes; i++) {
+        router.addRoute("*", QString("group%1/action%2").arg(i % 10).arg(i), handler(&called, "action"));
+        router.addRoute("GET", QString("group%1/item%2/:id").arg(i % 10).arg(i), handler(&called, "item"));
+    }
+
+    const Router::Route *route = nullptr;
+    QHash<QString, QString> parameters;
+
+    QBENCHMARK {
+        if (router.match("GET", action, &route, &parameters) == Router::Found) {
+            route->handler(nullptr);
+            found++;
+        }
+    }
+
+    QVERIFY(found > 0);
+    QCOMPARE(called, QString("action"));
+}
+
+QTEST_APPLESS_MAIN(TestRouter)
+
+#include "tst_router.moc"
@@ -0,0 +1,26 @@
+include(../tests.pri)
+
+# SampleFilter::getPolicy reads the settings, which are stored in the database
+QT += sql
+
+TARGET = tst_samplefilter
+
+# The recorded readings replayed through the filter
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+SOURCES += \
+    tst_samplefilter.cpp \
+    ../../core/database.cpp \
+    ../../core/event.cpp \
+    ../../core/writebehind.cpp \
+    ../../libraries/samplefilter.cpp \
+    ../../libraries/settings.cpp \
+    ../../models/setting.cpp
+
+HEADERS += \
+    ../../core/database.h \
+    ../../core/event.h \
+    ../../core/writebehind.h \
+    ../../libraries/samplefilter.h \
+    ../../libraries/settings.h \
+    ../../models/setting.h
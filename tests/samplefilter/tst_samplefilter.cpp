@@ -0,0 +1,237 @@
+#include "libraries/samplefilter.h"
+#include "tests/synthetichistory.h"
+
+#include <QFile>
+#include <QtTest>
+
+#include <cmath>
+#include <random>
+
+// The synthetic signal: a week of readings every minute, as sent by a sensor reporting its changes
+static const int readingInterval = 60;
+static const int days = 7;
+
+class TestSampleFilter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void everySample();
+    void maxInterval();
+    void flush();
+    void replay_data();
+    void replay();
+
+private:
+    static QList<SampleFilter::Sample> readings();
+    static QList<SampleFilter::Sample> readings(const QString &fileName);
+    static float lineAt(const QList<SampleFilter::Sample> &stored, int *segment, qint64 time);
+};
+
+void TestSampleFilter::everySample()
+{
+    SampleFilter filter;
+
+    QCOMPARE(filter.add(100, 20.0f).size(), 1);
+    QCOMPARE(filter.add(160, 20.0f).size(), 1);
+    QCOMPARE(filter.add(220, 20.1f).size(), 1);
+    QVERIFY(filter.flush().isEmpty());
+    QCOMPARE(filter.getLastTime(), Q_INT64_C(220));
+}
+
+void TestSampleFilter::maxInterval()
+{
+    SampleFilter::Policy policy;
+    policy.deadband = 0.5f;
+    policy.maxInterval = 600;
+    SampleFilter filter(policy);
+    int stored = 0;
+
+    // A flat signal: only the first reading and one every max interval
+    for (qint64 time = 0; time <= 3600; time += 60) {
+        stored += filter.add(time, 20.0f).size();
+    }
+
+    QCOMPARE(stored, 7);
+}
+
+void TestSampleFilter::flush()
+{
+    SampleFilter::Policy policy;
+    policy.deadband = 0.5f;
+    SampleFilter filter(policy);
+
+    QCOMPARE(filter.getLastTime(), Q_INT64_C(-1));
+    QCOMPARE(filter.add(0, 20.0f).size(), 1);
+    QVERIFY(filter.add(60, 20.1f).isEmpty());
+    QVERIFY(filter.add(120, 20.2f).isEmpty());
+    QCOMPARE(filter.getLastTime(), Q_INT64_C(120));
+
+    // The open door ends at the last reading, on the line within the deadband
+    QList<SampleFilter::Sample> kept = filter.flush();
+    QCOMPARE(kept.size(), 1);
+    QCOMPARE(kept.first().first, Q_INT64_C(120));
+    QVERIFY(qAbs(kept.first().second - 20.2f) <= 0.5f);
+
+    QVERIFY(filter.flush().isEmpty());
+    QCOMPARE(filter.getLastTime(), Q_INT64_C(120));
+
+    // The next reading starts a new door from the flushed sample
+    QVERIFY(filter.add(180, 20.3f).isEmpty());
+    QCOMPARE(filter.flush().size(), 1);
+}
+
+void TestSampleFilter::replay_data()
+{
+    QTest::addColumn<QString>("fixture");
+    QTest::addColumn<float>("deadband");
+
+    // The synthetic week, and a living room week in the format of a capture: heating cycles,
+    // night setback, irregular reports and lost readings
+    foreach (const QString &fixture, QStringList() << "" << "salon_week.csv") {
+        foreach (float deadband, QList<float>() << 0.1f << 0.2f << 0.3f) {
+            QTest::newRow(qPrintable(QString("%1 deadband %2").arg(fixture.isEmpty() ? "synthetic" : fixture).arg(deadband)))
+                    << fixture << deadband;
+        }
+    }
+}
+
+void TestSampleFilter::replay()
+{
+    QFETCH(QString, fixture);
+    QFETCH(float, deadband);
+
+    SampleFilter::Policy policy;
+    policy.deadband = deadband;
+    policy.maxInterval = 6 * 3600;
+    SampleFilter filter(policy);
+
+    QList<SampleFilter::Sample> input = fixture.isEmpty() ? readings() : readings(SRCDIR + fixture);
+    QList<SampleFilter::Sample> stored;
+
+    QVERIFY(!input.isEmpty());
+
+    foreach (const SampleFilter::Sample &reading, input) {
+        stored.append(filter.add(reading.first, reading.second));
+    }
+    stored.append(filter.flush());
+
+    QCOMPARE(stored.last().first, input.last().first);
+
+    // Every reading is within the deadband of the chart line
+    double maxError = 0;
+    int segment = 0;
+
+    foreach (const SampleFilter::Sample &reading, input) {
+        maxError = qMax(maxError, (double) qAbs(lineAt(stored, &segment, reading.first) - reading.second));
+    }
+
+    QVERIFY2(maxError <= deadband + 0.001, qPrintable(QString::number(maxError)));
+
+    // Hourly means of the readings, of the line (by time) and of the stored samples (by count)
+    QHash<qint64, double> readingSums;
+    QHash<qint64, double> lineSums;
+    QHash<qint64, int> readingCounts;
+    QHash<qint64, double> storedSums;
+    QHash<qint64, int> storedCounts;
+    segment = 0;
+
+    foreach (const SampleFilter::Sample &reading, input) {
+        qint64 hour = reading.first / 3600;
+        readingSums[hour] += reading.second;
+        lineSums[hour] += lineAt(stored, &segment, reading.first);
+        readingCounts[hour]++;
+    }
+
+    foreach (const SampleFilter::Sample &sample, stored) {
+        storedSums[sample.first / 3600] += sample.second;
+        storedCounts[sample.first / 3600]++;
+    }
+
+    double timeError = 0;
+    double countError = 0;
+
+    foreach (qint64 hour, readingCounts.keys()) {
+        double mean = readingSums.value(hour) / readingCounts.value(hour);
+        timeError = qMax(timeError, qAbs(lineSums.value(hour) / readingCounts.value(hour) - mean));
+
+        if (storedCounts.contains(hour)) {
+            countError = qMax(countError, qAbs(storedSums.value(hour) / storedCounts.value(hour) - mean));
+        }
+    }
+
+    QVERIFY(timeError <= deadband + 0.001);
+
+    // What the 10-minute ticks stored before the filter
+    int ticks = (input.last().first - input.first().first) / 600;
+
+    qInfo("%s, deadband %.1f: %d rows vs %d ticks (%.1fx fewer), max error %.3f, "
+          "hourly mean error %.3f by time, %.3f by count",
+          fixture.isEmpty() ? "synthetic" : qPrintable(fixture), deadband, stored.size(), ticks,
+          (double) ticks / stored.size(), maxError, timeError, countError);
+}
+
+QList<SampleFilter::Sample> TestSampleFilter::readings()
+{
+    QList<SampleFilter::Sample> result;
+    std::mt19937 random(20190101);
+    std::normal_distribution<double> noise(0, 0.03);
+
+    for (qint64 time = SyntheticHistory::firstTime; time < SyntheticHistory::firstTime + days * 86400; time += readingInterval) {
+        // A 2-degree daily swing, and the heating on for 2 hours on the third day
+        double value = 20 + std::sin((time - SyntheticHistory::firstTime) * 2 * M_PI / 86400) + noise(random);
+        if (time >= SyntheticHistory::firstTime + 2 * 86400 + 10 * 3600 && time < SyntheticHistory::firstTime + 2 * 86400 + 12 * 3600) {
+            value += 1.5;
+        }
+
+        // Reported in 0.1 degree steps
+        result.append(SampleFilter::Sample(time, qRound(value * 10) / 10.0f));
+    }
+
+    return result;
+}
+
+QList<SampleFilter::Sample> TestSampleFilter::readings(const QString &fileName)
+{
+    QList<SampleFilter::Sample> result;
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Fixture not readable: " << fileName;
+        return result;
+    }
+
+    // One "time,temperature" line per reading, in epoch seconds, after the header
+    file.readLine();
+
+    while (!file.atEnd()) {
+        QList<QByteArray> fields = file.readLine().trimmed().split(',');
+
+        if (fields.size() == 2) {
+            result.append(SampleFilter::Sample(fields.at(0).toLongLong(), fields.at(1).toFloat()));
+        }
+    }
+
+    return result;
+}
+
+float TestSampleFilter::lineAt(const QList<SampleFilter::Sample> &stored, int *segment, qint64 time)
+{
+    // Times are read in order: the segment only moves forward
+    while (*segment + 1 < stored.size() - 1 && stored.at(*segment + 1).first < time) {
+        (*segment)++;
+    }
+
+    const SampleFilter::Sample &start = stored.at(*segment);
+    const SampleFilter::Sample &end = stored.at(qMin(*segment + 1, stored.size() - 1));
+
+    if (end.first == start.first) {
+        return start.second;
+    }
+
+    return start.second + (double) (end.second - start.second) * (time - start.first) / (end.first - start.first);
+}
+
+QTEST_APPLESS_MAIN(TestSampleFilter)
+
+#include "tst_samplefilter.moc"
@@ -0,0 +1,10 @@
+include(../tests.pri)
+
+TARGET = tst_samplejournal
+
+SOURCES += \
+    tst_samplejournal.cpp \
+    ../../libraries/samplejournal.cpp
+
+HEADERS += \
+    ../../libraries/samplejournal.h
@@ -0,0 +1,83 @@
+#include "libraries/samplejournal.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QtTest>
+
+class TestSampleJournal : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void replayWithoutSync();
+    void tornRecord();
+
+private:
+    static QStringList replay(const QString &fileName);
+
+    QTemporaryDir directory;
+};
+
+void TestSampleJournal::initTestCase()
+{
+    QVERIFY(directory.isValid());
+}
+
+void TestSampleJournal::replayWithoutSync()
+{
+    QString fileName = directory.filePath("unsynced.wal");
+    SampleJournal journal;
+
+    QVERIFY(journal.open(fileName, [](const QString &, qint64, float) {}));
+    QVERIFY(journal.append("salon", 1546300800, 19.5f));
+    QVERIFY(journal.append("cuisine", 1546300860, 18.25f));
+    QVERIFY(journal.append("salon", 1546300920, 19.625f));
+
+    // Read back while the journal is still open, as after a crash of the process before the tick
+    QCOMPARE(replay(fileName), QStringList() << "salon 1546300800 19.5"
+                                             << "cuisine 1546300860 18.25"
+                                             << "salon 1546300920 19.625");
+}
+
+void TestSampleJournal::tornRecord()
+{
+    QString fileName = directory.filePath("torn.wal");
+    qint64 size;
+
+    {
+        SampleJournal journal;
+        QVERIFY(journal.open(fileName, [](const QString &, qint64, float) {}));
+        QVERIFY(journal.append("salon", 1546300800, 19.5f));
+        QVERIFY(journal.append("salon", 1546300860, 19.75f));
+        QVERIFY(journal.sync());
+        size = QFileInfo(fileName).size();
+    }
+
+    // The start of a record, cut by a crash
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    QVERIFY(file.write("\x05sal", 4) == 4);
+    file.close();
+
+    QCOMPARE(replay(fileName), QStringList() << "salon 1546300800 19.5" << "salon 1546300860 19.75");
+    QCOMPARE(QFileInfo(fileName).size(), size);
+}
+
+QStringList TestSampleJournal::replay(const QString &fileName)
+{
+    QStringList result;
+    SampleJournal journal;
+
+    journal.open(fileName, [&result](const QString &id, qint64 time, float value) {
+        result << QString("%1 %2 %3").arg(id).arg(time).arg(value);
+    });
+
+    return result;
+}
+
+QTEST_APPLESS_MAIN(TestSampleJournal)
+
+#include "tst_samplejournal.moc"
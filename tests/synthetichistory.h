@@ -0,0 +1,42 @@
+#ifndef SYNTHETICHISTORY_H
+#define SYNTHETICHISTORY_H
+
+#include <QDateTime>
+#include <QString>
+#include <QtMath>
+
+/*
+ * The sensor history of the benchmarks: a dozen sensors sampled every 10
+ * minutes from 2019-01-01, as written by the temperature logger, with a daily
+ * swing in 1/16 degree steps, as reported by the sensors.
+ */
+class SyntheticHistory
+{
+public:
+    static const int sensorCount = 12;
+    static const int samplesPerDay = 144;
+    static const int interval = 600;
+    static const qint64 firstTime = 1546300800; // 2019-01-01 00:00 UTC
+
+    static QString sensorId(int sensor)
+    {
+        return QString("sensor_%1").arg(sensor);
+    }
+
+    static qint64 sampleTime(int index)
+    {
+        return firstTime + (qint64) index * interval;
+    }
+
+    static QDateTime sampleDate(int index, Qt::TimeSpec spec = Qt::LocalTime)
+    {
+        return QDateTime::fromMSecsSinceEpoch(sampleTime(index) * 1000, spec);
+    }
+
+    static float sampleValue(int sensor, int index)
+    {
+        return 18 + sensor % 4 + qRound(qSin(index * 2 * M_PI / samplesPerDay) * 32) / 16.0f;
+    }
+};
+
+#endif // SYNTHETICHISTORY_H
@@ -0,0 +1,12 @@
+# Settings shared by every test: sources of the application are built with each test
+QT       += testlib
+QT       -= gui
+
+CONFIG   += console testcase warn_on
+CONFIG   -= app_bundle
+
+INCLUDEPATH += $$PWD/..
+DEPENDPATH += $$PWD/..
+
+# The synthetic sensor history of the benchmarks
+HEADERS += $$PWD/synthetichistory.h
@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Unit tests and benchmarks: qmake tests.pro && make && make check
+# Benchmarks only: ./<test>/tst_<test> -callgrind or -tickcounter, or plain for walltime
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    compression \
+    database \
+    httpheader \
+    httpserver \
+    jsonstreamwriter \
+    migration \
+    router \
+    samplefilter \
+    samplejournal \
+    timeseriesstore \
+    urlquery
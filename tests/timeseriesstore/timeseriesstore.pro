@@ -0,0 +1,19 @@
+include(../tests.pri)
+
+QT += sql
+
+TARGET = tst_timeseriesstore
+
+# The embedded schema, for the database side of the benchmarks
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+SOURCES += \
+    tst_timeseriesstore.cpp \
+    ../../core/database.cpp \
+    ../../libraries/timeseriescodec.cpp \
+    ../../libraries/timeseriesstore.cpp
+
+HEADERS += \
+    ../../core/database.h \
+    ../../libraries/timeseriescodec.h \
+    ../../libraries/timeseriesstore.h
@@ -0,0 +1,301 @@
+#include "core/database.h"
+#include "libraries/timeseriesstore.h"
+#include "tests/synthetichistory.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSqlError>
+#include <QTemporaryDir>
+#include <QVariantList>
+#include <QtTest>
+
+// Days of the synthetic history in the benchmarks
+static const int days = 90;
+
+class TestTimeSeriesStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void mergedScan();
+    void headLog();
+    void benchmarkIngest_data();
+    void benchmarkIngest();
+    void benchmarkScan_data();
+    void benchmarkScan();
+
+private:
+    static qint64 ingest(bool store);
+    static qint64 databaseBytes();
+
+    QTemporaryDir directory;
+};
+
+void TestTimeSeriesStore::initTestCase()
+{
+    QVERIFY(directory.isValid());
+
+    // The database side runs on SQLite; DOXEO_TEST_DRIVER=QMYSQL compares with the
+    // server configured in the doxeo_test system settings, schema installed
+    QCoreApplication::setOrganizationName("doxeo_test");
+    QDir::setCurrent(directory.path());
+
+    Database::initialize(qEnvironmentVariable("DOXEO_TEST_DRIVER", "QSQLITE"));
+    QVERIFY(Database::open());
+    QVERIFY(Database::bootstrap(SRCDIR "../../sql/doxeo.sqlite.sql"));
+
+    Database::Lease lease;
+    QSqlQuery query = lease.query();
+    QVERIFY(query.exec("DELETE FROM temperature WHERE id LIKE 'bench_%'"));
+
+    // The range index of migration 1
+    if (Database::isSqlite()) {
+        QVERIFY(query.exec("CREATE INDEX IF NOT EXISTS temperature_date_id ON temperature (date, id)"));
+    }
+
+    TimeSeriesStore::store().setBlockSize(16);
+    QVERIFY(TimeSeriesStore::store().open(directory.filePath("timeseries")));
+}
+
+void TestTimeSeriesStore::mergedScan()
+{
+    // Three series with interleaved times, over several sealed blocks and a head
+    for (int sensor = 0; sensor < 3; sensor++) {
+        QList<TimeSeriesStore::Sample> samples;
+
+        for (int i = 0; i < 40; i++) {
+            samples.append(TimeSeriesStore::Sample(1000 + i * 30 + sensor * 10, sensor + i / 16.0f));
+        }
+
+        QVERIFY(TimeSeriesStore::store().append("merge", QString("sensor_%1").arg(sensor), samples));
+    }
+
+    qint64 lastTime = -1;
+    int count = 0;
+    QHash<QString, int> counts;
+
+    QVERIFY(TimeSeriesStore::store().scan("merge", 1000, 2200, [&](const QString &id, qint64 time, float value) {
+        QVERIFY(time >= lastTime);
+        QCOMPARE(value, id.right(1).toInt() + ((time - 1000) / 30) / 16.0f);
+
+        lastTime = time;
+        counts[id]++;
+        count++;
+    }));
+
+    QCOMPARE(count, 120);
+    QCOMPARE(counts.value("sensor_1"), 40);
+
+    // A range inside the blocks
+    count = 0;
+    QVERIFY(TimeSeriesStore::store().scan("merge", 1300, 1400, [&count](const QString &, qint64, float) {
+        count++;
+    }));
+    QCOMPARE(count, 11);
+}
+
+void TestTimeSeriesStore::headLog()
+{
+    QList<TimeSeriesStore::Sample> samples;
+    for (int i = 0; i < 20; i++) {
+        samples.append(TimeSeriesStore::Sample(5000 + i * 600, 20.0f));
+    }
+
+    // 16 samples are sealed, the other 4 are appended to the log
+    QVERIFY(TimeSeriesStore::store().append("head", "salon", samples));
+
+    QFileInfo log(directory.filePath("timeseries/head/salon/head.log"));
+    QVERIFY(log.exists());
+    QCOMPARE(log.size(), Q_INT64_C(4 * 12));
+
+    QVERIFY(TimeSeriesStore::store().append("head", "salon", QList<TimeSeriesStore::Sample>()
+                                            << TimeSeriesStore::Sample(20000, 21.0f)));
+    log.refresh();
+    QCOMPARE(log.size(), Q_INT64_C(5 * 12));
+
+    // A sample already stored is skipped, the log does not grow
+    QVERIFY(TimeSeriesStore::store().append("head", "salon", QList<TimeSeriesStore::Sample>()
+                                            << TimeSeriesStore::Sample(20000, 21.0f)));
+    log.refresh();
+    QCOMPARE(log.size(), Q_INT64_C(5 * 12));
+}
+
+void TestTimeSeriesStore::benchmarkIngest_data()
+{
+    QTest::addColumn<bool>("store");
+
+    QTest::newRow("time series store") << true;
+    QTest::newRow("database") << false;
+}
+
+void TestTimeSeriesStore::benchmarkIngest()
+{
+    QFETCH(bool, store);
+
+    qint64 bytesBefore = store ? 0 : databaseBytes();
+    QElapsedTimer timer;
+    timer.start();
+
+    qint64 samples = ingest(store);
+    qint64 elapsed = timer.elapsed();
+
+    if (samples == 0) {
+        QSKIP("Already ingested by an earlier run of the benchmark");
+    }
+    QVERIFY(samples > 0);
+
+    double bytes;
+    if (store) {
+        bytes = TimeSeriesStore::store().getStatistics().value("bytes_per_sample").toDouble();
+    } else {
+        bytes = (double) (databaseBytes() - bytesBefore) / samples;
+    }
+
+    qInfo("%s: %lld samples in %lld ms, %.0f samples/s, %.2f bytes/sample",
+          store ? "store" : qPrintable(Database::getStatistics().value("type").toString()),
+          samples, elapsed, elapsed > 0 ? samples * 1000.0 / elapsed : 0.0, bytes);
+}
+
+void TestTimeSeriesStore::benchmarkScan_data()
+{
+    QTest::addColumn<bool>("store");
+
+    QTest::newRow("time series store") << true;
+    QTest::newRow("database") << false;
+}
+
+void TestTimeSeriesStore::benchmarkScan()
+{
+    QFETCH(bool, store);
+
+    QVERIFY(ingest(store) >= 0);
+
+    // 30 days in the middle of the history, as asked by temperature_logs.js
+    qint64 start = SyntheticHistory::sampleTime(30 * SyntheticHistory::samplesPerDay);
+    qint64 end = start + 30 * 86400 - 1;
+    int count = 0;
+
+    if (store) {
+        QBENCHMARK {
+            count = 0;
+            QVERIFY(TimeSeriesStore::store().scan("temperature", start, end, [&count](const QString &, qint64, float) {
+                count++;
+            }));
+        }
+    } else {
+        Database::Lease lease;
+        QSqlQuery query = lease.prepare("SELECT id, date, temperature FROM temperature "
+                                        "WHERE date >= ? AND date <= ? "
+                                        "ORDER BY date ASC", true);
+        query.addBindValue(QDateTime::fromMSecsSinceEpoch(start * 1000));
+        query.addBindValue(QDateTime::fromMSecsSinceEpoch(end * 1000));
+
+        QBENCHMARK {
+            QVERIFY(Database::exec(query));
+
+            count = 0;
+            while (query.next()) {
+                query.value(0).toString();
+                query.value(1).toDateTime();
+                query.value(2).toFloat();
+                count++;
+            }
+        }
+    }
+
+    QCOMPARE(count, 30 * SyntheticHistory::samplesPerDay * SyntheticHistory::sensorCount);
+}
+
+qint64 TestTimeSeriesStore::ingest(bool store)
+{
+    static bool storeFilled = false;
+    static bool databaseFilled = false;
+
+    bool &filled = store ? storeFilled : databaseFilled;
+    if (filled) {
+        return 0;
+    }
+    filled = true;
+
+    // Ingested day by day, in one batch per sensor for the store and one transaction for the database
+    for (int day = 0; day < days; day++) {
+        if (store) {
+            for (int sensor = 0; sensor < SyntheticHistory::sensorCount; sensor++) {
+                QList<TimeSeriesStore::Sample> samples;
+
+                for (int i = day * SyntheticHistory::samplesPerDay; i < (day + 1) * SyntheticHistory::samplesPerDay; i++) {
+                    samples.append(TimeSeriesStore::Sample(SyntheticHistory::sampleTime(i), SyntheticHistory::sampleValue(sensor, i)));
+                }
+
+                if (!TimeSeriesStore::store().append("temperature", QString("bench_%1").arg(sensor), samples)) {
+                    return -1;
+                }
+            }
+            continue;
+        }
+
+        Database::Lease lease;
+        QSqlDatabase db = lease.database();
+        QSqlQuery query = lease.prepare("INSERT INTO temperature (id, date, temperature) VALUES (?, ?, ?)");
+        QVariantList idList;
+        QVariantList dateList;
+        QVariantList tempList;
+
+        for (int i = day * SyntheticHistory::samplesPerDay; i < (day + 1) * SyntheticHistory::samplesPerDay; i++) {
+            for (int sensor = 0; sensor < SyntheticHistory::sensorCount; sensor++) {
+                idList << QString("bench_%1").arg(sensor);
+                dateList << SyntheticHistory::sampleDate(i);
+                tempList << SyntheticHistory::sampleValue(sensor, i);
+            }
+        }
+
+        query.addBindValue(idList);
+        query.addBindValue(dateList);
+        query.addBindValue(tempList);
+
+        db.transaction();
+        if (!query.execBatch() || !db.commit()) {
+            qWarning() << query.lastError();
+            return -1;
+        }
+    }
+
+    return (qint64) days * SyntheticHistory::samplesPerDay * SyntheticHistory::sensorCount;
+}
+
+qint64 TestTimeSeriesStore::databaseBytes()
+{
+    Database::Lease lease;
+    QSqlQuery query = lease.query();
+
+    // SQLite: the whole file, once the WAL is written back; MySQL: the table and its indexes
+    if (Database::isSqlite()) {
+        query.exec("PRAGMA wal_checkpoint(TRUNCATE)");
+
+        if (!query.exec("PRAGMA page_count") || !query.next()) {
+            return -1;
+        }
+        qint64 pages = query.value(0).toLongLong();
+
+        if (!query.exec("PRAGMA page_size") || !query.next()) {
+            return -1;
+        }
+        return pages * query.value(0).toLongLong();
+    }
+
+    query.exec("ANALYZE TABLE temperature");
+
+    if (!query.exec("SELECT data_length + index_length FROM information_schema.tables "
+                    "WHERE table_schema = DATABASE() AND table_name = 'temperature'") || !query.next()) {
+        return -1;
+    }
+
+    return query.value(0).toLongLong();
+}
+
+QTEST_GUILESS_MAIN(TestTimeSeriesStore)
+
+#include "tst_timeseriesstore.moc"
@@ -0,0 +1,298 @@
+#include "core/urlquery.h"
+
+#include <QUrl>
+#include <QtTest>
+
+#include <algorithm>
+#include <random>
+
+// The decoder replaced by the single pass one, kept as the reference of the tests
+static QString legacyNormalize(const QString &text)
+{
+    QString input = "http://www.test.com/" + text;
+    input.replace("+", " ");
+    QByteArray latin = input.toLatin1();
+    QByteArray utf8 = input.toUtf8();
+    QString result;
+
+    if (latin != utf8) {
+        result = QUrl::fromUserInput(input).toDisplayString().remove("http://www.test.com/");
+    } else {
+        result = QUrl::fromUserInput(QUrl::fromPercentEncoding(input.toLatin1())).toDisplayString().remove("http://www.test.com/");
+    }
+
+    result.replace("%22", "\"");
+    result.replace("%7B", "{");
+    result.replace("%7D", "}");
+    result.replace("%3C", "<");
+    result.replace("%3E", ">");
+    result.replace("%5C", "\\");
+    result.replace("%7C", "|");
+    result.replace("%0D%0A", "\n");
+    result.replace("%0A", "\n");
+
+    return result;
+}
+
+// What jQuery sends for a form field: encodeURIComponent, CRLF line ends and "+" for spaces
+static QByteArray formEncode(const QString &value)
+{
+    QString text = value;
+    text.replace("\n", "\r\n");
+
+    return QUrl::toPercentEncoding(text, "!'()*").replace("%20", "+");
+}
+
+// A path segment as built by the web interface, or a value sent by a client which leaves
+// the characters beyond ASCII as they are
+static QString encode(const QString &value, bool path, bool raw)
+{
+    if (!raw) {
+        return QString::fromLatin1(path ? QUrl::toPercentEncoding(value, "!'()*+") : formEncode(value));
+    }
+
+    QString result;
+
+    foreach (const QChar &c, value) {
+        if (c.unicode() > 0x7f) {
+            result += c;
+        } else {
+            result += encode(QString(c), path, false);
+        }
+    }
+
+    return result;
+}
+
+// The known reasons for the old decoder to differ from the new one
+static QStringList divergences(const QString &value, bool path, bool raw)
+{
+    QStringList classes;
+    int end = value.size();
+
+    while (end > 0 && value.at(end - 1).isSpace()) {
+        end--;
+    }
+
+    // "+" was a space in the path too, and "%2F" a separator
+    if (path && value.contains('+')) {
+        classes << "plus in path";
+    }
+
+    if (path && value.contains('/')) {
+        classes << "encoded slash";
+    }
+
+    // Only CRLF pairs were turned into "\n", a lone CR was left as "%0D"
+    if (value.contains('\r')) {
+        classes << "carriage return";
+    }
+
+    // A URL which is not Latin-1 skipped the percent decoding
+    if (raw && std::any_of(value.begin(), value.end(), [](const QChar &c) { return c.unicode() > 0x7f; })) {
+        classes << "non-Latin-1";
+    }
+
+    // QUrl displays these escaped, and trims the URL
+    if (value.contains('%') || value.contains('^') || value.contains('`')) {
+        classes << "kept escaped";
+    }
+
+    if (end < value.size()) {
+        classes << "trailing whitespace";
+    }
+
+    return classes;
+}
+
+class TestUrlQuery : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void pathSegments();
+    void repeatedKeys();
+    void plusHandling();
+    void malformedEscapes();
+    void fuzzEquivalence();
+    void benchmarkDecode_data();
+    void benchmarkDecode();
+
+private:
+    static QString randomText(std::mt19937 &random, int maxLength);
+};
+
+void TestUrlQuery::pathSegments()
+{
+    UrlQuery query("//script/edit%20me/a%2Fb?id=1");
+
+    QCOMPARE(query.getAllQuery(), QStringList() << "script" << "edit me" << "a%2Fb");
+    QCOMPARE(query.getItem("id"), QString("1"));
+    QCOMPARE(query.getQuery(5), QString(""));
+}
+
+void TestUrlQuery::repeatedKeys()
+{
+    UrlQuery query("/list.js?id=1&id=2&empty&a=b=c");
+
+    QCOMPARE(query.getItem("id"), QString("2"));
+    QCOMPARE(query.getItems("id"), QStringList() << "1" << "2");
+    QCOMPARE(query.getItem("empty"), QString(""));
+    QCOMPARE(query.getItem("a"), QString("b=c"));
+}
+
+void TestUrlQuery::plusHandling()
+{
+    UrlQuery query("/a+b?q=a+b%2Bc");
+    query.addFormData("body=x+%2B+y%0D%0Az");
+
+    // "+" is a space in the query and the form, not in the path
+    QCOMPARE(query.getQuery(0), QString("a+b"));
+    QCOMPARE(query.getItem("q"), QString("a b+c"));
+    QCOMPARE(query.getItem("body"), QString("x + y\nz"));
+}
+
+void TestUrlQuery::malformedEscapes()
+{
+    UrlQuery query("/a?v=100%&w=%zz&x=%e9&y=%C3%A9");
+
+    QCOMPARE(query.getItem("v"), QString("100%"));
+    QCOMPARE(query.getItem("w"), QString("%zz"));
+    QCOMPARE(query.getItem("x"), QString(QChar(0xfffd)));
+    QCOMPARE(query.getItem("y"), QString::fromUtf8("\xc3\xa9"));
+}
+
+void TestUrlQuery::fuzzEquivalence()
+{
+    // Random values encoded like the web interface, and by a raw client: the new decoder gives
+    // every value back, and the old one agrees with it but for the known divergences
+    std::mt19937 random(20190101);
+    QMap<QString, int> classCounts;
+    int compared = 0;
+    int mismatches = 0;
+    const int count = 20000;
+
+    for (int i = 0; i < count; i++) {
+        QString value = randomText(random, 64);
+
+        for (int raw = 0; raw < 2; raw++) {
+            for (int path = 0; path < 2; path++) {
+                QString encoded = encode(value, path, raw);
+                QString decoded;
+
+                if (path) {
+                    decoded = UrlQuery("/" + encoded).getQuery(0);
+                    QCOMPARE(decoded, QString(value).replace("/", "%2F"));
+                } else {
+                    UrlQuery query("/script/set?v=" + encoded);
+                    UrlQuery form;
+                    form.addFormData("v=" + encoded.toUtf8());
+
+                    decoded = form.getItem("v");
+                    QCOMPARE(query.getItem("v"), value);
+                    QCOMPARE(decoded, value);
+                }
+
+                QString legacy = legacyNormalize(encoded);
+                compared++;
+
+                if (legacy == decoded) {
+                    continue;
+                }
+
+                QStringList classes = divergences(value, path, raw);
+                QVERIFY2(!classes.isEmpty(), qPrintable(QString("unexplained divergence: \"%1\" gave \"%2\"")
+                                                        .arg(encoded, legacy)));
+
+                mismatches++;
+                foreach (const QString &divergence, classes) {
+                    classCounts[divergence]++;
+                }
+            }
+        }
+    }
+
+    qInfo("%d of %d decodings differ from the old decoder", mismatches, compared);
+
+    foreach (const QString &divergence, classCounts.keys()) {
+        qInfo("  %s: %d", qPrintable(divergence), classCounts.value(divergence));
+    }
+}
+
+void TestUrlQuery::benchmarkDecode_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::addColumn<int>("size");
+
+    foreach (int size, QList<int>() << 64 << 4096 << 65536) {
+        QTest::newRow(qPrintable(QString("legacy %1 bytes").arg(size))) << true << size;
+        QTest::newRow(qPrintable(QString("single pass %1 bytes").arg(size))) << false << size;
+    }
+}
+
+void TestUrlQuery::benchmarkDecode()
+{
+    QFETCH(bool, legacy);
+    QFETCH(int, size);
+
+    // A script body, as posted by jsonSetScriptBody
+    QString script;
+    while (script.size() < size) {
+        script += "if (sensor(\"temp_salon\").value < 19.5) {\n    heater(\"salon\").on(); // \xc3\xa9t\xc3\xa9\n}\n";
+    }
+    script.truncate(size);
+
+    QByteArray body = "id=12&body=" + formEncode(script);
+    QString result;
+
+    if (legacy) {
+        QBENCHMARK {
+            QStringList fields = QString::fromLatin1(body).split("&");
+            result = legacyNormalize(fields.at(1).split("=").at(1));
+        }
+    } else {
+        QBENCHMARK {
+            UrlQuery query;
+            query.addFormData(body);
+            result = query.getItem("body");
+        }
+    }
+
+    QVERIFY(!result.isEmpty());
+}
+
+QString TestUrlQuery::randomText(std::mt19937 &random, int maxLength)
+{
+    static const QString special = QString::fromUtf8("\r\n\xc3\xa9\xc3\xbc\xe2\x82\xac\xe4\xb8\xad\xf0\x9f\x94\xa5");
+    std::uniform_int_distribution<int> length(0, maxLength);
+    std::uniform_int_distribution<int> kind(0, 9);
+    std::uniform_int_distribution<int> ascii(0x20, 0x7e);
+    std::uniform_int_distribution<int> other(0, special.size() - 1);
+    QString result;
+
+    for (int i = length(random); i > 0; i--) {
+        if (kind(random) > 0) {
+            result += QChar(ascii(random));
+            continue;
+        }
+
+        int index = other(random);
+
+        // Keep surrogate pairs whole
+        if (special.at(index).isLowSurrogate()) {
+            index--;
+        }
+
+        result += special.at(index);
+
+        if (special.at(index).isHighSurrogate()) {
+            result += special.at(index + 1);
+        }
+    }
+
+    return result;
+}
+
+QTEST_APPLESS_MAIN(TestUrlQuery)
+
+#include "tst_urlquery.moc"
@@ -0,0 +1,10 @@
+include(../tests.pri)
+
+TARGET = tst_urlquery
+
+SOURCES += \
+    tst_urlquery.cpp \
+    ../../core/urlquery.cpp
+
+HEADERS += \
+    ../../core/urlquery.h
@@ -1,322 +1,512 @@
 var updateError = false;
+var sensorRecords = {};
+var dashboardVersion = 0;
 
 jQuery(document).ready(function () {
     update();
-    updateScriptPanel();
-    updateCameraPanel();
     //setInterval(refreshCameras, 1000);
 });
 
-try {
-    var address = 'ws://' + window.location.hostname + ':8081';
+var deltaTopics = ['sensor.*', 'switch.*', 'heater.*', 'setting.value', 'scenario.list', 'script.list', 'camera.list', 'log.append'];
 
-    if (window.location.protocol === 'https:') {
-        address = 'wss://' + window.location.hostname + '/myws';
-    }
+if (window.EventSource) {
+    // served by the http server itself: no second port nor proxy
+    var events = new EventSource('events?topics=' + deltaTopics.join(','));
+
+    events.onmessage = function (event) {
+        applyDelta(JSON.parse(event.data));
+    };
+
+    events.onerror = function (error) {
+        console.log("Event stream disconnected, retrying...");
+    };
+} else {
+    connectWebSocket();
+}
 
-    var socket = new WebSocket(address);
+function connectWebSocket() {
+    try {
+        var address = 'ws://' + window.location.hostname + ':8081';
+
+        if (window.location.protocol === 'https:') {
+            address = 'wss://' + window.location.hostname + '/myws';
+        }
 
-    socket.onopen = function (event) {
-        console.log("Websocket connected!");
+        var socket = new WebSocket(address);
 
-        this.onclose = function (event) {
-            console.log("Websocket closed!");
+        socket.onopen = function (event) {
+            console.log("Websocket connected!");
+
+            this.onclose = function (event) {
+                console.log("Websocket closed!");
+            };
+
+            // receive typed deltas instead of refetching every panel
+            this.send(JSON.stringify({
+                subscribe: deltaTopics
+            }));
+
+            this.onmessage = function (event) {
+                var delta;
+                try {
+                    delta = JSON.parse(event.data);
+                } catch (e) {
+                    console.log("Message:", event.data);
+                    return;
+                }
+                // deltas of the same tick are batched in one frame
+                if (Array.isArray(delta)) {
+                    delta.forEach(applyDelta);
+                } else {
+                    applyDelta(delta);
+                }
+            };
         };
 
-        this.onmessage = function (event) {
-            console.log("Message:", event.data);
-            update();
+        socket.onerror = function (error) {
+            console.error(error);
         };
+    } catch (e) {
+        console.warn(e);
+        alert("Websocket not connected");
+    }
+}
+
+function update() {
+    if (updateError) {
+        return;
+    }
 
+    // one request for every panel, then only the sections changed since our version
+    var param = (dashboardVersion != 0) ? { since: dashboardVersion } : {};
 
-    };
+    $.getJSON('dashboard.js', param).done(function (result) {
+        if (!result.success) {
+            updateError = true;
+            alert_error(result.Message);
+            return;
+        }
 
-    socket.onerror = function (error) {
-        console.error(error);
-    };
-} catch (e) {
-    console.warn(e);
-    alert("Websocket not connected");
+        var sections = result.sections;
+        dashboardVersion = result.version;
+
+        if (sections.system !== undefined) {
+            renderSystem($.extend({ success: true }, sections.system));
+        }
+        if (sections.switches !== undefined) {
+            renderSwitches({ Result: "OK", Records: sections.switches });
+        }
+        if (sections.heaters !== undefined) {
+            renderHeaters({ Result: "OK", Records: sections.heaters });
+        }
+        if (sections.thermostat !== undefined) {
+            renderThermostatStatus($.extend({ success: true }, sections.thermostat));
+        }
+        if (sections.warnings !== undefined) {
+            renderLogs({ success: true, messages: sections.warnings });
+        }
+        if (sections.sensors !== undefined) {
+            renderSensorList({ Result: "OK", Records: sections.sensors });
+        }
+        if (sections.scenarios !== undefined) {
+            renderScenarios({ Result: "OK", Records: sections.scenarios });
+        }
+        if (sections.cameras !== undefined) {
+            renderCameras({ Result: "OK", Records: sections.cameras });
+        }
+        if (sections.scripts !== undefined) {
+            renderScripts({ Result: "OK", Records: sections.scripts });
+        }
+    }).fail(function (jqxhr, textStatus, error) {
+        updateError = true;
+        alert_error("Request Failed: " + error);
+    });
 }
 
-function update() {
+function applyDelta(delta) {
     if (updateError) {
         return;
     }
 
-    $.getJSON('system.js').done(function (result) {
-        if (result.success) {
-            $('#system_time').html(result.time);
-            if (result.device_connected) {
-                $('#board_status').html('<span class="label label-info">Connected</span>');
+    switch (delta.topic) {
+        case 'resync':
+            // the server dropped our backlog
+            update();
+            break;
+        case 'sensor.value':
+        case 'sensor.battery':
+            if (delta.record && sensorRecords[delta.id]) {
+                sensorRecords[delta.id] = delta.record;
+                renderSensors();
             } else {
-                $('#board_status').html('<span class="label label-danger">Disconnected</span>');
+                updateSensors();
             }
-
-            if (result.alarm === 'ARM_AWAY') {
-                $('#alarm_status_active').find('span').first().text("Arm Away");
-                $('#alarm_status_active').removeClass('btn-secondary btn-primary btn-warning btn-danger').addClass('btn-danger');
-            } else if (result.alarm === 'ARM_STAY') {
-                $('#alarm_status_active').find('span').first().text("Arm Stay");
-                $('#alarm_status_active').removeClass('btn-secondary btn-primary btn-warning btn-danger').addClass('btn-warning');
-            } else if (result.alarm === 'PENDING') {
-                $('#alarm_status_active').find('span').first().text("Pending...");
-                $('#alarm_status_active').removeClass('btn-secondary btn-primary btn-warning btn-danger').addClass('btn-warning');
-            } else if (result.alarm === 'DISARMED') {
-                $('#alarm_status_active').find('span').first().text("Off");
-                $('#alarm_status_active').removeClass('btn-secondary btn-primary btn-warning btn-danger').addClass('btn-secondary');
-            } else {
-                $('#alarm_status_active').find('span').first().text("Unknown");
-                $('#alarm_status_active').removeClass('btn-secondary btn-primary btn-warning btn-danger').addClass('btn-primary');
+            break;
+        case 'switch.status':
+            $('#sw_' + delta.id).bootstrapSwitch('state', delta.value == "on" || delta.value == "pending", true);
+            break;
+        case 'heater.setpoint':
+        case 'heater.status':
+        case 'heater.temperature':
+            if (delta.record) {
+                renderHeater(delta.record);
+            }
+            break;
+        case 'setting.value':
+            if (delta.id === 'alarm_status') {
+                updateSystem();
             }
+            break;
+        case 'log.append':
+            if (delta.type === 'warning' || delta.type === 'critical') {
+                appendLog(delta);
+            }
+            break;
+        case 'sensor.list':
+            updateSensors();
+            break;
+        case 'switch.list':
+            updateSwitches();
+            break;
+        case 'heater.list':
+            updateHeaters();
+            break;
+        case 'scenario.list':
+            updateScenarios();
+            break;
+        case 'script.list':
+            updateScriptPanel();
+            break;
+        case 'camera.list':
+            updateCameraPanel();
+            break;
+    }
+}
 
-        } else {
-            updateError = true;
-            alert_error(result.msg);
-        }
-    }).fail(function (jqxhr, textStatus, error) {
+function updateSystem() {
+    $.getJSON('system.js').done(renderSystem).fail(function (jqxhr, textStatus, error) {
         updateError = true;
         alert_error("Request Failed: " + error);
     });
+}
 
-    $.getJSON('switch/list.js').done(function (result) {
-        if (result.Result == "OK") {
-            $('#switchList').html('');
-            result.Records.sort(function (a, b) {
-                return a.order - b.order;
-            })
-            $.each(result.Records, function (key, val) {
-                if (val.is_visible != "true") {
-                    return true;
-                }
-                $('#switchList').append('<tr><td class="text-right" style="width: 50%">' + val.name + '</td><td class="text-left"><input id="sw_' + val.id + '" name="switch" class="switch_on_off" type="checkbox" data-id="' + val.id + '" data-size="mini"></td></tr>');
-                if (val.status == "on" || val.status == "pending") {
-                    $('#sw_' + val.id + '').prop('checked', true);
-                }
-            });
-            $("[name='switch']").bootstrapSwitch();
+function renderSystem(result) {
+    if (result.success) {
+        $('#system_time').html(result.time);
+        if (result.device_connected) {
+            $('#board_status').html('<span class="label label-info">Connected</span>');
         } else {
-            $('#switchList').html('<tr><td></td></tr>');
-            updateError = true;
-            alert_error(result.msg);
+            $('#board_status').html('<span class="label label-danger">Disconnected</span>');
         }
-    }).fail(function (jqxhr, textStatus, error) {
+
+        if (result.alarm === 'ARM_AWAY') {
+            $('#alarm_status_active').find('span').first().text("Arm Away");
+            $('#alarm_status_active').removeClass('btn-secondary btn-primary btn-warning btn-danger').addClass('btn-danger');
+        } else if (result.alarm === 'ARM_STAY') {
+            $('#alarm_status_active').find('span').first().text("Arm Stay");
+            $('#alarm_status_active').removeClass('btn-secondary btn-primary btn-warning btn-danger').addClass('btn-warning');
+        } else if (result.alarm === 'PENDING') {
+            $('#alarm_status_active').find('span').first().text("Pending...");
+            $('#alarm_status_active').removeClass('btn-secondary btn-primary btn-warning btn-danger').addClass('btn-warning');
+        } else if (result.alarm === 'DISARMED') {
+            $('#alarm_status_active').find('span').first().text("Off");
+            $('#alarm_status_active').removeClass('btn-secondary btn-primary btn-warning btn-danger').addClass('btn-secondary');
+        } else {
+            $('#alarm_status_active').find('span').first().text("Unknown");
+            $('#alarm_status_active').removeClass('btn-secondary btn-primary btn-warning btn-danger').addClass('btn-primary');
+        }
+
+    } else {
+        updateError = true;
+        alert_error(result.msg);
+    }
+}
+
+function updateSwitches() {
+    $.getJSON('switch/list.js').done(renderSwitches).fail(function (jqxhr, textStatus, error) {
         $('#switchList').html('<tr><td></td></tr>')
         updateError = true;
         alert_error("Request Failed: " + error);
     });
+}
 
-    $.getJSON('thermostat/heaters.js').done(function (result) {
-        if (result.Result == "OK") {
-            var create = ($('#heater_pan1').length == 0) ? false : true;
-
-            $.each(result.Records, function (key, heater) {
-                if (create) {
-                    if (key != 0) {
-                        $('#heater_nav_tabs li:last-child').clone().insertAfter('#heater_nav_tabs li:last-child');
-                        $('#heater_nav_tabs li:last-child').removeClass("active");
-                        $('#heater_tab_panes div.tab-pane:last-child').clone().insertAfter('#heater_tab_panes div.tab-pane:last-child');
-                        $('#heater_tab_panes div.tab-pane:last-child').removeClass("active");
-                    }
-
-                    if (heater.id === 1) {
-                        $('#heater_nav_tabs li:last-child').addClass("active");
-                        $('#heater_tab_panes div.tab-pane:last-child').addClass("active");
-                    }
-
-                    $('#heater_nav_tabs li:last-child').find("a").text(heater.name);
-                    $('#heater_nav_tabs li:last-child').find("a").prop('href', '#heater_' + heater.id);
-                    $('#heater_nav_tabs li:last-child').find("a").attr('aria-controls', 'heater_' + heater.id);
-                    $('#heater_tab_panes div.tab-pane:last-child').attr('id', 'heater_' + heater.id);
-                }
+function renderSwitches(result) {
+    if (result.Result == "OK") {
+        $('#switchList').html('');
+        result.Records.sort(function (a, b) {
+            return a.order - b.order;
+        })
+        $.each(result.Records, function (key, val) {
+            if (val.is_visible != "true") {
+                return true;
+            }
+            $('#switchList').append('<tr><td class="text-right" style="width: 50%">' + val.name + '</td><td class="text-left"><input id="sw_' + val.id + '" name="switch" class="switch_on_off" type="checkbox" data-id="' + val.id + '" data-size="mini"></td></tr>');
+            if (val.status == "on" || val.status == "pending") {
+                $('#sw_' + val.id + '').prop('checked', true);
+            }
+        });
+        $("[name='switch']").bootstrapSwitch();
+    } else {
+        $('#switchList').html('<tr><td></td></tr>');
+        updateError = true;
+        alert_error(result.msg);
+    }
+}
 
-                $('#heater_' + heater.id).find(".heater_temperature").html(heater.temperature.toFixed(2) + '&deg;');
-                $('#heater_' + heater.id).find(".heat_setpoint").text(heater.heat_setpoint.toFixed(1));
-                $('#heater_' + heater.id).find(".cool_setpoint").text(heater.cool_setpoint.toFixed(1));
-                $('#heater_' + heater.id).find(".heater_mode").text(heater.mode);
-                $('#heater_' + heater.id).find(".heater_status").text(heater.status);
+function updateHeaters() {
+    $.getJSON('thermostat/heaters.js').done(renderHeaters).fail(function (jqxhr, textStatus, error) {
+        updateError = true;
+        alert_error("Request Failed: " + error);
+    });
+}
 
-                if (heater.current_setpoint == heater.heat_setpoint) {
-                    $('#heater_' + heater.id).find(".heat_setpoint").css("font-weight", "Bold");
-                } else {
-                    $('#heater_' + heater.id).find(".heat_setpoint").css("font-weight", "Normal");
+function renderHeaters(result) {
+    if (result.Result == "OK") {
+        var create = ($('#heater_pan1').length == 0) ? false : true;
+
+        $.each(result.Records, function (key, heater) {
+            if (create) {
+                if (key != 0) {
+                    $('#heater_nav_tabs li:last-child').clone().insertAfter('#heater_nav_tabs li:last-child');
+                    $('#heater_nav_tabs li:last-child').removeClass("active");
+                    $('#heater_tab_panes div.tab-pane:last-child').clone().insertAfter('#heater_tab_panes div.tab-pane:last-child');
+                    $('#heater_tab_panes div.tab-pane:last-child').removeClass("active");
                 }
 
-                if (heater.current_setpoint == heater.cool_setpoint) {
-                    $('#heater_' + heater.id).find(".cool_setpoint").css("font-weight", "Bold");
-                } else {
-                    $('#heater_' + heater.id).find(".cool_setpoint").css("font-weight", "Normal");
+                if (heater.id === 1) {
+                    $('#heater_nav_tabs li:last-child').addClass("active");
+                    $('#heater_tab_panes div.tab-pane:last-child').addClass("active");
                 }
-            });
-        } else {
-            updateError = true;
-            alert_error(result.msg);
-        }
-    }).fail(function (jqxhr, textStatus, error) {
-        updateError = true;
-        alert_error("Request Failed: " + error);
-    });
 
-    $.getJSON('thermostat/status.js').done(function (result) {
-        if (result.success) {
-            if (result.thermostat_status === 1) {
-                $('#thermostat_status_active').find('span').first().text("Running");
-                $('#thermostat_status_active').removeClass('btn-secondary btn-info btn-warning').addClass('btn-info');
-            } else if (result.thermostat_status === 2) {
-                $('#thermostat_status_active').find('span').first().text("On Break");
-                $('#thermostat_status_active').removeClass('btn-secondary btn-info btn-warning').addClass('btn-warning');
-            } else {
-                $('#thermostat_status_active').find('span').first().text("Stopped");
-                $('#thermostat_status_active').removeClass('btn-secondary btn-info btn-warning').addClass('btn-secondary');
+                $('#heater_nav_tabs li:last-child').find("a").text(heater.name);
+                $('#heater_nav_tabs li:last-child').find("a").prop('href', '#heater_' + heater.id);
+                $('#heater_nav_tabs li:last-child').find("a").attr('aria-controls', 'heater_' + heater.id);
+                $('#heater_tab_panes div.tab-pane:last-child').attr('id', 'heater_' + heater.id);
             }
 
-            if (result.temperaturelogger_enable) {
-                $('#temperaturelogger_status_active').find('span').first().text("Running");
-                $('#temperaturelogger_status_active').removeClass('btn-secondary btn-info').addClass('btn-info');
-            } else {
-                $('#temperaturelogger_status_active').find('span').first().text("Stopped");
-                $('#temperaturelogger_status_active').removeClass('btn-secondary btn-info').addClass('btn-secondary');
-            }
-        } else {
-            updateError = true;
-            alert_error(result.msg);
-        }
-    }).fail(function (jqxhr, textStatus, error) {
+            renderHeater(heater);
+        });
+    } else {
         updateError = true;
-        alert_error("Request Failed: " + error);
-    });
+        alert_error(result.msg);
+    }
+}
 
-    $.getJSON('logs.js?type=warning').done(function (result) {
-        if (result.success) {
-            var cptWarning = 0;
-            var cptCritical = 0;
+function renderHeater(heater) {
+    $('#heater_' + heater.id).find(".heater_temperature").html(heater.temperature.toFixed(2) + '&deg;');
+    $('#heater_' + heater.id).find(".heat_setpoint").text(heater.heat_setpoint.toFixed(1));
+    $('#heater_' + heater.id).find(".cool_setpoint").text(heater.cool_setpoint.toFixed(1));
+    $('#heater_' + heater.id).find(".heater_mode").text(heater.mode);
+    $('#heater_' + heater.id).find(".heater_status").text(heater.status);
 
-            $('#errorModalTable').html("");
-            $('#warningModalTable').html("");
+    if (heater.current_setpoint == heater.heat_setpoint) {
+        $('#heater_' + heater.id).find(".heat_setpoint").css("font-weight", "Bold");
+    } else {
+        $('#heater_' + heater.id).find(".heat_setpoint").css("font-weight", "Normal");
+    }
 
-            result.messages.sort(function (a, b) {
-                return b.date.localeCompare(a.date);
-            });
+    if (heater.current_setpoint == heater.cool_setpoint) {
+        $('#heater_' + heater.id).find(".cool_setpoint").css("font-weight", "Bold");
+    } else {
+        $('#heater_' + heater.id).find(".cool_setpoint").css("font-weight", "Normal");
+    }
+}
 
-            for (msg of result.messages) {
-                if (msg.type === "critical") {
-                    cptCritical++;
-                    $('#errorModalTable').append('<tr><td>' + msg.date + '</td><td>' + msg.message + '</td></tr>')
-                } else if (msg.type === "warning") {
-                    cptWarning++;
-                    $('#warningModalTable').append('<tr><td>' + msg.date + '</td><td>' + msg.message + '</td></tr>')
-                }
-            }
+function updateThermostatStatus() {
+    $.getJSON('thermostat/status.js').done(renderThermostatStatus).fail(function (jqxhr, textStatus, error) {
+        updateError = true;
+        alert_error("Request Failed: " + error);
+    });
+}
 
-            if (cptCritical > 0) {
-                $('#critical_error').html('<button type="button" class="btn btn-danger btn-xs" data-toggle="modal" data-target="#errorModal">' + cptCritical + '</button>');
-            } else {
-                $('#critical_error').html('<span class="label label-success">0</span>');
-            }
+function renderThermostatStatus(result) {
+    if (result.success) {
+        if (result.thermostat_status === 1) {
+            $('#thermostat_status_active').find('span').first().text("Running");
+            $('#thermostat_status_active').removeClass('btn-secondary btn-info btn-warning').addClass('btn-info');
+        } else if (result.thermostat_status === 2) {
+            $('#thermostat_status_active').find('span').first().text("On Break");
+            $('#thermostat_status_active').removeClass('btn-secondary btn-info btn-warning').addClass('btn-warning');
+        } else {
+            $('#thermostat_status_active').find('span').first().text("Stopped");
+            $('#thermostat_status_active').removeClass('btn-secondary btn-info btn-warning').addClass('btn-secondary');
+        }
 
-            if (cptWarning > 0) {
-                $('#warning_error').html('<button type="button" class="btn btn-danger btn-xs" data-toggle="modal" data-target="#warningModal">' + cptWarning + '</button>');
-            } else {
-                $('#warning_error').html('<span class="label label-success">0</span>');
-            }
+        if (result.temperaturelogger_enable) {
+            $('#temperaturelogger_status_active').find('span').first().text("Running");
+            $('#temperaturelogger_status_active').removeClass('btn-secondary btn-info').addClass('btn-info');
         } else {
-            updateError = true;
-            alert_error(result.msg);
+            $('#temperaturelogger_status_active').find('span').first().text("Stopped");
+            $('#temperaturelogger_status_active').removeClass('btn-secondary btn-info').addClass('btn-secondary');
         }
-    }).fail(function (jqxhr, textStatus, error) {
+    } else {
+        updateError = true;
+        alert_error(result.msg);
+    }
+}
+
+function updateLogs() {
+    $.getJSON('logs.js?type=warning').done(renderLogs).fail(function (jqxhr, textStatus, error) {
         updateError = true;
         alert_error("Request Failed: " + error);
     });
+}
 
-    $.getJSON('sensor/list.js').done(function (result) {
-        if (result.Result == "OK") {
-            $('#sensor_tab_panes .table').empty();
-            $('#batteryList').html('');
-            var batteryNames = [];
-            result.Records.sort(function (a, b) {
-                if (a.order < b.order) {
-                    return -1;
-                } else if (a.order > b.order) {
-                    return 1;
-                } else {
-                    return 0;
-                }
-            })
-            var batteryStatusList = [];
-            $.each(result.Records, function (key, val) {
-                // update sensor panel
-                if (val.visibility != "hide") {
-                    var date = new Date(val.last_event * 1000);;
-                    var lastUpdate = date.toLocaleTimeString() + ' ' + date.toLocaleDateString();
-                    var target = '#sensor_pan_automatisme';
-
-                    if (val.category === 'door' || val.category === 'window' || val.category === 'doormat' || val.category === 'pir' || val.category === 'doorknob') {
-                        target = '#sensor_pan_security';
-                    } else if (val.category === 'temperature' || val.category === 'humidity') {
-                        target = '#sensor_pan_energy'
-                    } else if (val.category === 'heartbeat') {
-                        target = '#sensor_pan_mon'
-                    }
-                    $(target + ' .table').append('<tr><td class="text-right" style="width: 40%"><span data-toggle="tooltip" data-placement="left" title="' + lastUpdate + '">' + getSensorImage(val) + '</span></td><td class="text-left">' + val.name + '<br />' + getSensorStatus(val) + '</td></tr>');
-                }
+function renderLogs(result) {
+    if (result.success) {
+        $('#errorModalTable').html("");
+        $('#warningModalTable').html("");
 
-                // update battery panel
-                if (val.battery > 0 && !batteryNames.includes(val.full_name)) {
-                    batteryNames.push(val.full_name);
-                    date = new Date(val.battery_update * 1000);
-                    lastUpdate = date.toLocaleTimeString() + ' ' + date.toLocaleDateString();
-
-                    batteryStatusList.push({
-                        name: val.full_name,
-                        lastUpdate: lastUpdate,
-                        battery: val.battery
-                    });
-                }
-            });
-            updateBatteryPanel(batteryStatusList);
-            $('[data-toggle="tooltip"]').tooltip();
-        } else {
-            $('#sensorList').html('<tr><td></td></tr>');
-            $('#batteryList').html('<tr><td></td></tr>');
-            updateError = true;
-            alert_error(result.msg);
+        result.messages.sort(function (a, b) {
+            return a.date.localeCompare(b.date);
+        });
+
+        for (msg of result.messages) {
+            addLogRow(msg);
         }
-    }).fail(function (jqxhr, textStatus, error) {
+        updateLogCounters();
+    } else {
+        updateError = true;
+        alert_error(result.msg);
+    }
+}
+
+function addLogRow(msg) {
+    if (msg.type === "critical") {
+        $('#errorModalTable').prepend('<tr><td>' + msg.date + '</td><td>' + msg.message + '</td></tr>')
+    } else if (msg.type === "warning") {
+        $('#warningModalTable').prepend('<tr><td>' + msg.date + '</td><td>' + msg.message + '</td></tr>')
+    }
+}
+
+function appendLog(msg) {
+    addLogRow(msg);
+    updateLogCounters();
+}
+
+function updateLogCounters() {
+    var cptCritical = $('#errorModalTable tr').length;
+    var cptWarning = $('#warningModalTable tr').length;
+
+    if (cptCritical > 0) {
+        $('#critical_error').html('<button type="button" class="btn btn-danger btn-xs" data-toggle="modal" data-target="#errorModal">' + cptCritical + '</button>');
+    } else {
+        $('#critical_error').html('<span class="label label-success">0</span>');
+    }
+
+    if (cptWarning > 0) {
+        $('#warning_error').html('<button type="button" class="btn btn-danger btn-xs" data-toggle="modal" data-target="#warningModal">' + cptWarning + '</button>');
+    } else {
+        $('#warning_error').html('<span class="label label-success">0</span>');
+    }
+}
+
+function updateSensors() {
+    $.getJSON('sensor/list.js').done(renderSensorList).fail(function (jqxhr, textStatus, error) {
         $('#sensorList').html('<tr><td></td></tr>');
         $('#batteryList').html('<tr><td></td></tr>');
         updateError = true;
         alert_error("Request Failed: " + error);
     });
+}
 
-    $.getJSON('scenario/list.js').done(function (result) {
-        if (result.Result == "OK") {
-            $('#scenarioList').html('');
-            result.Records.sort(function (a, b) {
-                if (a.order < b.order) {
-                    return -1;
-                } else if (a.order > b.order) {
-                    return 1;
-                } else {
-                    return 0;
-                }
-            })
-            $.each(result.Records, function (key, val) {
-                if (val.hide != "true") {
-                    $('#scenarioList').append('<tr><td class="text-right" style="width: 50%">' + val.name + '</td><td class="text-left"></td></tr>');
-                }
-            });
+function renderSensorList(result) {
+    if (result.Result == "OK") {
+        sensorRecords = {};
+        $.each(result.Records, function (key, val) {
+            sensorRecords[val.id] = val;
+        });
+        renderSensors();
+    } else {
+        $('#sensorList').html('<tr><td></td></tr>');
+        $('#batteryList').html('<tr><td></td></tr>');
+        updateError = true;
+        alert_error(result.msg);
+    }
+}
+
+function renderSensors() {
+    var records = Object.values(sensorRecords);
+    var batteryNames = [];
+    var batteryStatusList = [];
+
+    $('#sensor_tab_panes .table').empty();
+    $('#batteryList').html('');
+    records.sort(function (a, b) {
+        if (a.order < b.order) {
+            return -1;
+        } else if (a.order > b.order) {
+            return 1;
         } else {
-            $('#scenarioList').html('<tr><td></td></tr>');
-            updateError = true;
-            alert_error(result.msg);
+            return 0;
         }
-    }).fail(function (jqxhr, textStatus, error) {
+    })
+    $.each(records, function (key, val) {
+        // update sensor panel
+        if (val.visibility != "hide") {
+            var date = new Date(val.last_event * 1000);;
+            var lastUpdate = date.toLocaleTimeString() + ' ' + date.toLocaleDateString();
+            var target = '#sensor_pan_automatisme';
+
+            if (val.category === 'door' || val.category === 'window' || val.category === 'doormat' || val.category === 'pir' || val.category === 'doorknob') {
+                target = '#sensor_pan_security';
+            } else if (val.category === 'temperature' || val.category === 'humidity') {
+                target = '#sensor_pan_energy'
+            } else if (val.category === 'heartbeat') {
+                target = '#sensor_pan_mon'
+            }
+            $(target + ' .table').append('<tr><td class="text-right" style="width: 40%"><span data-toggle="tooltip" data-placement="left" title="' + lastUpdate + '">' + getSensorImage(val) + '</span></td><td class="text-left">' + val.name + '<br />' + getSensorStatus(val) + '</td></tr>');
+        }
+
+        // update battery panel
+        if (val.battery > 0 && !batteryNames.includes(val.full_name)) {
+            batteryNames.push(val.full_name);
+            date = new Date(val.battery_update * 1000);
+            lastUpdate = date.toLocaleTimeString() + ' ' + date.toLocaleDateString();
+
+            batteryStatusList.push({
+                name: val.full_name,
+                lastUpdate: lastUpdate,
+                battery: val.battery
+            });
+        }
+    });
+    updateBatteryPanel(batteryStatusList);
+    $('[data-toggle="tooltip"]').tooltip();
+}
+
+function updateScenarios() {
+    $.getJSON('scenario/list.js').done(renderScenarios).fail(function (jqxhr, textStatus, error) {
         $('#scenarioList').html('<tr><td></td></tr>');
         updateError = true;
         alert_error("Request Failed: " + error);
     });
 }
 
+function renderScenarios(result) {
+    if (result.Result == "OK") {
+        $('#scenarioList').html('');
+        result.Records.sort(function (a, b) {
+            if (a.order < b.order) {
+                return -1;
+            } else if (a.order > b.order) {
+                return 1;
+            } else {
+                return 0;
+            }
+        })
+        $.each(result.Records, function (key, val) {
+            if (val.hide != "true") {
+                $('#scenarioList').append('<tr><td class="text-right" style="width: 50%">' + val.name + '</td><td class="text-left"></td></tr>');
+            }
+        });
+    } else {
+        $('#scenarioList').html('<tr><td></td></tr>');
+        updateError = true;
+        alert_error(result.msg);
+    }
+}
+
 function updateBatteryPanel(list) {
     list.sort(function (a, b) {
         return a.battery - b.battery;
@@ -328,56 +518,63 @@ function updateBatteryPanel(list) {
 }
 
 function updateCameraPanel() {
-    $.getJSON('camera/list.js').done(function (result) {
-        if (result.Result == "OK") {
-            $('#cameraList').html('');
-            $.each(result.Records, function (key, val) {
-                if (val.visibility != 'hide') {
-                    $('#cameraList').append('<tr><td class="camera"><a href="/camera/show?id=' + val.id + '&refresh=1&duration=60">' + val.name + '</a></td></tr>');
-                }
-            });
-        } else {
-            $('#cameraList').html('<tr><td></td></tr>');
-            alert_error(result.msg);
-        }
-    }).fail(function (jqxhr, textStatus, error) {
+    $.getJSON('camera/list.js').done(renderCameras).fail(function (jqxhr, textStatus, error) {
         $('#cameraList').html('<tr><td></td></tr>');
         alert_error("Request Failed: " + error);
     });
 }
 
+function renderCameras(result) {
+    if (result.Result == "OK") {
+        $('#cameraList').html('');
+        $.each(result.Records, function (key, val) {
+            if (val.visibility != 'hide') {
+                $('#cameraList').append('<tr><td class="camera"><a href="/camera/show?id=' + val.id + '&refresh=1&duration=60">' + val.name + '</a></td></tr>');
+            }
+        });
+    } else {
+        $('#cameraList').html('<tr><td></td></tr>');
+        alert_error(result.msg);
+    }
+}
+
 function refreshCameras() {
     $('.camera img').attr('src', function (i, old) { return old.replace(/&u.+/, "&u=" + (Math.random() * 1000)); });
 }
 
 function updateScriptPanel() {
-    $.getJSON('script/list.js').done(function (result) {
-        $('#scriptPanel .content').empty();
-        if (result.Result == "OK") {
-            result.Records.sort(function (a, b) {
-                if (a.name < b.name) {
-                    return -1;
-                } else if (a.name > b.name) {
-                    return 1;
-                } else {
-                    return 0;
-                }
-            })
-            var number = 0;
-            const numberByPage = 10;
-            $.each(result.Records, function (key, val) {
+    $.getJSON('script/list.js').done(renderScripts).fail(function (jqxhr, textStatus, error) {
+        alert_error("Request Failed: " + error);
+    });
+}
 
-                if (val.visibility === 'hide') {
-                    return;
-                }
+function renderScripts(result) {
+    $('#scriptPanel .content').empty();
+    if (result.Result == "OK") {
+        result.Records.sort(function (a, b) {
+            if (a.name < b.name) {
+                return -1;
+            } else if (a.name > b.name) {
+                return 1;
+            } else {
+                return 0;
+            }
+        })
+        var number = 0;
+        const numberByPage = 10;
+        $.each(result.Records, function (key, val) {
 
-                if ((number % numberByPage) == 0) {
-                    var pageNumber = number / numberByPage + 1;
-                    $('#scriptPanel .content').append('<table class="table" id="scriptPanel-page-' + pageNumber + '" style="margin:0px; border-bottom: 1px solid #ddd"><tbody></tbody></table>');
-                    $('#scriptPanel .pagination').append('<li><a href="#">' + pageNumber + '</a></li>');
-                }
+            if (val.visibility === 'hide') {
+                return;
+            }
+
+            if ((number % numberByPage) == 0) {
+                var pageNumber = number / numberByPage + 1;
+                $('#scriptPanel .content').append('<table class="table" id="scriptPanel-page-' + pageNumber + '" style="margin:0px; border-bottom: 1px solid #ddd"><tbody></tbody></table>');
+                $('#scriptPanel .pagination').append('<li><a href="#">' + pageNumber + '</a></li>');
+            }
 
-                status = "\
+            status = "\
 				<div class=\"dropdown\"> \
 				  <button class=\"btn btn-xs dropdown-toggle\" type=\"button\" style=\"border: 0px; padding:0px 5px 1px 5px; font-size:11px;\" id=\"script_status_"+ val.id + "\" data-toggle=\"dropdown\" aria-haspopup=\"true\" aria-expanded=\"false\"> \
 					<span></span> <span class=\"caret\"></span> \
@@ -388,26 +585,23 @@ function updateScriptPanel() {
 				  </ul> \
 				</div>";
 
-                $('#scriptPanel .content').find('tbody:last').append('<tr><td class="text-right" style="width: 50%">' + val.name + '</td><td class="text-left">' + status + '</td></tr>');
+            $('#scriptPanel .content').find('tbody:last').append('<tr><td class="text-right" style="width: 50%">' + val.name + '</td><td class="text-left">' + status + '</td></tr>');
 
-                if (val.status === "on") {
-                    $('#script_status_' + val.id).find('span').first().text("Enabled");
-                    $('#script_status_' + val.id).removeClass('btn-secondary btn-info').addClass('btn-info');
-                } else {
-                    $('#script_status_' + val.id).find('span').first().text("Disabled");
-                    $('#script_status_' + val.id).removeClass('btn-secondary btn-info').addClass('btn-secondary');
-                }
+            if (val.status === "on") {
+                $('#script_status_' + val.id).find('span').first().text("Enabled");
+                $('#script_status_' + val.id).removeClass('btn-secondary btn-info').addClass('btn-info');
+            } else {
+                $('#script_status_' + val.id).find('span').first().text("Disabled");
+                $('#script_status_' + val.id).removeClass('btn-secondary btn-info').addClass('btn-secondary');
+            }
 
-                number++;
-            });
+            number++;
+        });
 
-            managePagination('#scriptPanel');
-        } else {
-            alert_error(result.msg);
-        }
-    }).fail(function (jqxhr, textStatus, error) {
-        alert_error("Request Failed: " + error);
-    });
+        managePagination('#scriptPanel');
+    } else {
+        alert_error(result.msg);
+    }
 }
 
 $('#switchList').on('switchChange.bootstrapSwitch', '.switch_on_off', function (event, state) {
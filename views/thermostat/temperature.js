@@ -16,6 +16,10 @@
         var sData = [];
         var cptId = 0;
         var tabId = [];
+        // A rollup period is only filled when the line of the samples crosses it: two of them are
+        // up to one sample interval further apart than the resolution
+        var interval = result.resolution > 0 ? result.resolution + result.interval : result.interval;
+        var period = interval > 0 ? interval / 60 : 0; // minutes between two points, 0 when unbounded
         
         // Parse data
         $.each(result.records, function(key, val) {
@@ -39,8 +43,8 @@
                 
                 id = tabId[val.id];
             
-                if (sData[id].previousDate !== null && moment(val.date).diff(sData[id].previousDate, 'minutes') > 15) {
-                    sData[id].previousDate.add(10, 'minutes');
+                if (period > 0 && sData[id].previousDate !== null && moment(val.date).diff(sData[id].previousDate, 'minutes') > period * 1.5) {
+                    sData[id].previousDate.add(period, 'minutes');
                     sData[id].data.push([sData[id].previousDate.valueOf(), null]);
                 }
 